@@ -16,9 +16,11 @@ public:
     bool enabled() const;
 
     // Send code + error context to AI, get coaching hint (streaming)
+    // `tags` (comma-separated) selects the remembered mistakes and tag stats injected into the prompt
     std::string analyze(const std::string& problem_desc,
                  const std::string& user_code,
-                 std::function<void(std::string)> callback);
+                 std::function<void(std::string)> callback,
+                 const std::string& tags = "");
 
     // Legacy non-streaming (deprecated but kept for compatibility if needed)
     std::string analyze_sync(const std::string& problem_desc, const std::string& user_code);
@@ -51,11 +53,13 @@ public:
      * @param problem_desc Problem description
      * @param user_code User's code
      * @param on_hint Callback for streaming hint content to user
+     * @param tags Problem tags (comma-separated) used to pick memory context
      * @return Parsed AIResponse with all segments
      */
     AIResponse analyze_structured(const std::string& problem_desc,
                                   const std::string& user_code,
-                                  std::function<void(std::string)> on_hint = nullptr);
+                                  std::function<void(std::string)> on_hint = nullptr,
+                                  const std::string& tags = "");
 
 private:
     Config cfg_;
@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <optional>
 #include <fmt/core.h>
 
 #ifndef _WIN32
@@ -28,6 +29,15 @@ struct Config {
     bool autostart_repl = true;       // Auto-start REPL when running 'shuati' with no args
     std::string ui_mode = "tui";
 
+    // SQLite tuning: a DbProfile preset ("laptop" or "server") plus optional
+    // per-setting overrides, unset = the preset's value
+    std::string db_profile = "laptop";
+    std::optional<int> db_cache_size_kb;
+    std::optional<long long> db_mmap_size;       // Bytes, 0 disables mmap
+    std::optional<std::string> db_temp_store;    // "memory" or "file"
+    std::optional<int> db_wal_autocheckpoint;
+    std::optional<int> db_busy_timeout_ms;
+
     // --- Linux / cross-platform editor detection ---
     // Returns a best-guess editor command, checking $VISUAL, $EDITOR, then common editors in PATH.
     // NOTE: uses filesystem PATH scan, NOT std::system(), to be safe in CI and restricted environments.
@@ -118,6 +128,12 @@ struct Config {
         if (!lanqiao_cookie.empty()) j["lanqiao_cookie"]   = lanqiao_cookie;
         j["autostart_repl"]          = autostart_repl;
         if (!ui_mode.empty())        j["ui_mode"]          = ui_mode;
+        if (!db_profile.empty())     j["db_profile"]       = db_profile;
+        if (db_cache_size_kb)        j["db_cache_size_kb"] = *db_cache_size_kb;
+        if (db_mmap_size)            j["db_mmap_size"]     = *db_mmap_size;
+        if (db_temp_store)           j["db_temp_store"]    = *db_temp_store;
+        if (db_wal_autocheckpoint)   j["db_wal_autocheckpoint"] = *db_wal_autocheckpoint;
+        if (db_busy_timeout_ms)      j["db_busy_timeout_ms"] = *db_busy_timeout_ms;
         std::ofstream(path) << j.dump(2);
     }
 
@@ -137,6 +153,12 @@ struct Config {
             if (j.contains("lanqiao_cookie")) c.lanqiao_cookie = j["lanqiao_cookie"];
             if (j.contains("autostart_repl")) c.autostart_repl = j["autostart_repl"];
             if (j.contains("ui_mode"))        c.ui_mode        = j["ui_mode"];
+            if (j.contains("db_profile"))     c.db_profile     = j["db_profile"];
+            if (j.contains("db_cache_size_kb"))      c.db_cache_size_kb      = j["db_cache_size_kb"].get<int>();
+            if (j.contains("db_mmap_size"))          c.db_mmap_size          = j["db_mmap_size"].get<long long>();
+            if (j.contains("db_temp_store"))         c.db_temp_store         = j["db_temp_store"].get<std::string>();
+            if (j.contains("db_wal_autocheckpoint")) c.db_wal_autocheckpoint = j["db_wal_autocheckpoint"].get<int>();
+            if (j.contains("db_busy_timeout_ms"))    c.db_busy_timeout_ms    = j["db_busy_timeout_ms"].get<int>();
         } catch (...) {}
         return c;
     }
@@ -7,24 +7,241 @@
 #include <vector>
 #include <ctime>
 #include <optional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <variant>
 #include "shuati/types.hpp"
+#include "shuati/utils/mpsc_queue.hpp"
 
 namespace shuati {
 
+// Position of a row in the listing order (created_at DESC, rowid DESC).
+// rowid only breaks ties between equal timestamps; it is not the TID.
+struct ProblemCursor {
+    long long created_at = 0;
+    long long rowid = 0;
+};
+
+// Filters and window for Database::query_problems; everything runs in SQL
+struct ProblemQuery {
+    std::string status = "all";       // all, ac, failed, unaudited, review
+    std::string difficulty = "all";   // all, easy, medium, hard
+    std::string source = "all";       // all or a canonical_source() name
+    std::string tag;                  // Only problems carrying this tag ("" = any)
+    int limit = 0;                    // 0 = no limit
+    int offset = 0;                   // Page jumps (cmd_list --page); prefer `after`
+    std::optional<ProblemCursor> after; // Keyset: rows strictly after this one
+    long long now = 0;                // Due-time for "review" and review_due (0 = current time)
+};
+
+struct ProblemPage {
+    std::vector<ProblemSummary> rows;
+    std::optional<ProblemCursor> next; // Set when more rows follow the window
+};
+
+// One full-text search result (Database::search_problems)
+struct ProblemSearchHit {
+    ProblemSummary problem;
+    std::string snippet;  // Statement excerpt with matches wrapped in [ ] (full-text path only)
+    double score = 0;     // bm25 score, lower is better; 0 on the substring fallback
+};
+
+// Attempt counters for one week (Monday 00:00 UTC), all problems or one tag.
+// `solved` counts problems whose first AC fell in the window.
+struct AttemptRollup {
+    std::string tag;             // Empty for the all-problems rollup
+    long long week_start = 0;    // For per-tag totals: start of the queried range
+    int attempts = 0;
+    int accepted = 0;
+    int solved = 0;
+    double solve_rate() const { return attempts > 0 ? static_cast<double>(accepted) / attempts : 0.0; }
+};
+
+// Problems carrying one tag, by their last verdict (the list filters' terms).
+// Kept by triggers in the `tags` table, so reading it costs one row per tag.
+struct TagStats {
+    std::string tag;
+    int problems = 0;
+    int attempted = 0;   // Last verdict other than '' / SKIPPED
+    int solved = 0;      // Last verdict AC
+    double solve_rate() const { return attempted > 0 ? static_cast<double>(solved) / attempted : 0.0; }
+};
+
+// Per-problem attempt summary (time-to-AC and best time)
+struct ProblemAttemptStats {
+    std::string problem_id;
+    int attempts = 0;
+    int accepted = 0;
+    long long first_attempt_at = 0;
+    long long last_attempt_at = 0;
+    long long first_ac_at = 0;   // 0 = never accepted
+    int attempts_to_ac = 0;      // Attempts up to and including the first AC
+    int best_time_ms = 0;        // Fastest accepted run
+    long long time_to_ac() const { return first_ac_at > 0 ? first_ac_at - first_attempt_at : 0; }
+};
+
+// One point of a problem's time trend (served from a covering index)
+struct AttemptPoint {
+    long long timestamp = 0;
+    std::string verdict;
+    int max_time_ms = 0;
+    int max_memory_kb = 0;
+};
+
+// Library counters for `status` and the TUI dashboard, read from tables that
+// SQLite triggers keep up to date, so the cost does not grow with the library.
+struct LibraryStats {
+    int total = 0;
+    std::map<std::string, int> by_source;      // canonical_source() name
+    std::map<std::string, int> by_difficulty;
+    std::map<std::string, int> by_verdict;     // last_verdict; "" = never tested
+    int due_reviews = 0;                       // next_review <= now
+    std::vector<std::pair<long long, int>> upcoming_reviews; // (UTC day start, count) after now
+    int verdict(const std::string& v) const {
+        auto it = by_verdict.find(v);
+        return it == by_verdict.end() ? 0 : it->second;
+    }
+};
+
+// SQLite tuning applied when a Database opens its connections. Presets are
+// selected with Config::db_profile; a default-constructed profile is "laptop".
+struct DbProfile {
+    std::string name = "laptop";
+    int cache_size_kb = 8192;         // Page cache, per connection
+    long long mmap_size = 64LL << 20; // Bytes of the file read through mmap
+    bool temp_store_memory = false;   // Temp tables and sort spills in RAM instead of files
+    int wal_autocheckpoint = 1000;    // WAL pages before an automatic checkpoint
+    int busy_timeout_ms = 5000;       // Wait for other processes' locks
+    int read_connections = 0;         // Read pool size, 0 = from the core count
+
+    // Throws std::invalid_argument for an unknown name
+    static DbProfile preset(const std::string& name);
+    static std::vector<std::string> preset_names();
+};
+
+// Result of Database::maintain. Sizes cover the database file plus its WAL.
+struct MaintenanceReport {
+    long long bytes_before = 0;
+    long long bytes_after = 0;
+    int pages_vacuumed = 0;      // Free pages released by incremental_vacuum
+    int free_pages_left = 0;     // Left for the next run when the budget ran out
+    bool wal_truncated = false;  // False if a reader kept the checkpoint from finishing
+    bool converted = false;      // Full VACUUM switched an old database to incremental auto-vacuum
+    double elapsed_ms = 0;
+    long long reclaimed_bytes() const { return bytes_before > bytes_after ? bytes_before - bytes_after : 0; }
+};
+
+// One table row of a library archive (see LibraryArchive): the row type
+// ("problem", "test_case", "review", "mistake", "attempt", "memory_mistake",
+// "memory_mastery", "user_profile") and its columns by name
+using ArchiveValue = std::variant<std::nullptr_t, int64_t, double, std::string>;
+struct ArchiveRow {
+    std::string type;
+    std::vector<std::pair<std::string, ArchiveValue>> fields;
+    const ArchiveValue* get(const std::string& column) const {
+        for (const auto& [name, value] : fields)
+            if (name == column) return &value;
+        return nullptr;
+    }
+};
+
+// What happens when an imported problem or memory entry already exists
+enum class ConflictPolicy {
+    Skip,     // Keep the local row; the problem's test cases, review, mistakes and attempts are skipped too
+    Replace,  // Archive wins; a replaced problem's local test cases, review, mistakes and attempts are dropped,
+              // and a local problem with the same url under another id is replaced by the archive's id
+    Fail      // Abort the import, rolling back the current batch
+};
+
+struct ArchiveCounts {
+    long long problems = 0;
+    long long test_cases = 0;
+    long long reviews = 0;
+    long long mistakes = 0;
+    long long attempts = 0;
+    long long memory = 0;     // Memory mistakes, mastery and the user profile
+    long long skipped = 0;    // Import: rows left out by the policy or whose problem was not imported
+    long long rekeyed = 0;    // Import: local problems replaced by an archive problem with the same url but another id
+    long long rows() const { return problems + test_cases + reviews + mistakes + attempts + memory; }
+};
+
+// Import progress carried from one batch to the next
+struct ArchiveImportState {
+    std::string problem_id;       // Problem the following child rows belong to
+    bool accept_children = false; // Whether that problem was imported
+    ArchiveCounts counts;
+};
+
+// Counters of the writer thread (see Database)
+struct WriteStats {
+    uint64_t jobs = 0;      // Write calls executed
+    uint64_t batches = 0;   // Transactions they were committed in
+};
+
+// Access to one SQLite file from any number of threads.
+//
+// Writes are executed by a dedicated writer thread that owns the read-write
+// connection. Callers queue them on a lock-free MPSC queue and block until
+// their write has committed, so the API stays synchronous. The writer drains
+// everything queued since its last pass into one transaction, running each
+// call in its own SAVEPOINT: a failing call is rolled back alone and its
+// exception rethrown to its caller. Concurrent producers (Companion requests,
+// TUI workers, the main thread) therefore never contend for the write lock.
+// Reads go through a small pool of read-only connections (query_only, mmap
+// I/O); each thread sticks to one of them, so readers on different threads run
+// in parallel with each other and with the writer, and see committed data (WAL).
 class Database {
 public:
-    explicit Database(const std::string& db_path);
-    ~Database() = default;
+    explicit Database(const std::string& db_path, const DbProfile& profile = {});
+    ~Database();
 
-    void init_schema();
+    // Schema version stored in PRAGMA user_version. The constructor migrates
+    // older databases; opening an up-to-date one costs a single pragma read.
+    static constexpr int kSchemaVersion = 11;
+    int schema_version();
 
     // Problem CRUD
     void add_problem(const Problem& p);
+    // Problem + its test cases (+ optional first review) in one transaction:
+    // either everything is stored or nothing is. Used by pull and Companion.
+    void add_problem_with_cases(const Problem& p, const std::vector<TestCase>& cases,
+                                const std::optional<ReviewItem>& review = std::nullopt);
     bool problem_exists(const std::string& url);
-    std::vector<Problem> get_all_problems();
+    std::vector<Problem> get_all_problems();            // Full rows, including description
+    std::vector<ProblemSummary> get_problem_summaries(); // List columns only, same order
+    ProblemPage query_problems(const ProblemQuery& query);
+    int count_problems(const ProblemQuery& query);
     Problem get_problem(const std::string& id);
     Problem get_problem_by_display_id(int tid);
+    std::optional<ProblemSummary> get_problem_summary_by_display_id(int tid);  // Without the description
+    // TID <-> problem id through an in-memory map filled once per session
+    // (misses fall back to one indexed lookup). TIDs are allocated
+    // monotonically and never reused, so an entry can only go stale by the
+    // problem being deleted, never by pointing at a different problem.
+    std::string problem_id_for_tid(int tid);
+    int tid_for_problem_id(const std::string& id);  // 0 if unknown
+
+    // Full-text search over title, tags and the plaintext statement.
+    // Uses the FTS5 trigram index when available; terms shorter than three
+    // characters (e.g. two-character Chinese words) fall back to LIKE.
+    std::vector<ProblemSearchHit> search_problems(const std::string& query, int limit = 20);
+    bool has_fulltext_index();
+    // Registers the app's SQL functions (shuati_plaintext() and friends). The
+    // current schema does not depend on them: only the migration steps and the
+    // triggers of schemas before version 11 call them.
+    static void register_sql_functions(SQLite::Database& db);
     void delete_problem(int tid);
+    // Deletes every listed TID in one transaction; unknown TIDs are ignored.
+    // Test cases, reviews and mistakes go with their problem (ON DELETE CASCADE).
+    // Returns the number of problems deleted.
+    int delete_problems(const std::vector<int>& tids);
 
     // Mistake CRUD
     void log_mistake(const std::string& problem_id, const std::string& type, const std::string& desc);
@@ -34,6 +251,28 @@ public:
     // Problem Status
     void update_problem_status(const std::string& id, const std::string& verdict, int pass_count, int total_count);
 
+    // Attempt history. record_attempt appends the attempt, updates the problem's
+    // last verdict and advances the rollup tables in one transaction, so the
+    // analytics below never scan the attempts table. Attempts are expected in
+    // time order; rebuild_attempt_rollups() recomputes everything from scratch.
+    long long record_attempt(const Attempt& a);
+    std::vector<AttemptPoint> get_attempt_trend(const std::string& problem_id, int limit = 50); // Oldest first
+    std::optional<ProblemAttemptStats> get_attempt_stats(const std::string& problem_id);
+    std::vector<ProblemAttemptStats> get_recent_solves(int limit = 20);  // By first AC, newest first
+    std::vector<AttemptRollup> get_weekly_attempts(long long since, const std::string& tag = "");
+    std::vector<AttemptRollup> get_tag_attempts(long long since);       // Summed per tag, most attempted first
+    void rebuild_attempt_rollups();
+    static long long week_start(long long timestamp);
+
+    // Per-tag counters. `tags` is a comma-separated list (as in Problem::tags);
+    // empty means every tag that has problems, most problems first
+    std::vector<TagStats> get_tag_stats(const std::string& tags = "");
+    // Lowest solve rate first, among tags with at least `min_attempted` tested problems
+    std::vector<TagStats> get_weakest_tags(int limit = 5, int min_attempted = 3);
+
+    // Dashboard counters; `upcoming_days` limits upcoming_reviews (0 = now only)
+    LibraryStats get_library_stats(long long now = 0, int upcoming_days = 7);
+
     // Review / Spaced Repetition
     void upsert_review(const ReviewItem& r);
     std::vector<ReviewItem> get_due_reviews(long long now);
@@ -47,6 +286,8 @@ public:
     // Mistakes (Abstract Patterns)
     void upsert_memory_mistake(const std::string& tags, const std::string& pattern, const std::string& example_id);
     std::vector<MemoryMistake> get_all_memory_mistakes();
+    // Patterns sharing a tag with the comma-separated `tags`, most frequent first
+    std::vector<MemoryMistake> get_memory_mistakes_for_tags(const std::string& tags, int limit = 5);
     
     // Mastery
     void upsert_mastery(const std::string& skill, double confidence);
@@ -57,9 +298,130 @@ public:
     void update_user_profile(int elo, const std::string& preferences);
     UserProfile get_user_profile();
 
+    // Library archive. export_archive streams every problem followed by its
+    // test cases, review, mistakes and attempts, then the memory tables, from
+    // one read snapshot and without materializing any table. import_archive
+    // applies a batch of rows in one write transaction; call it with the
+    // batches in archive order, then rebuild_attempt_rollups().
+    ArchiveCounts export_archive(const std::function<void(const ArchiveRow&)>& sink);
+    void import_archive(const std::vector<ArchiveRow>& batch, ConflictPolicy policy, ArchiveImportState& state);
+
+    // PRAGMA optimize, incremental_vacuum in small steps until `budget` runs out
+    // (0 = no limit) and wal_checkpoint(TRUNCATE). `full` runs ANALYZE on every
+    // table and converts databases created without incremental auto-vacuum with
+    // a one-time VACUUM. The writer thread also runs short budgeted passes by
+    // itself when it goes idle with free pages or a large WAL left behind.
+    MaintenanceReport maintain(std::chrono::milliseconds budget = {}, bool full = false);
+
+    // Prepared statements currently held by the cache (for tests/benchmarks)
+    size_t cached_statement_count();
+    WriteStats write_stats() const;
+    size_t read_pool_size() const { return readers_.size(); }
+    // Settings in effect, read back from the connection after opening (SQLite
+    // may clamp mmap_size, and read_connections is resolved)
+    const DbProfile& profile() const { return profile_; }
+
 private:
+    // Statement cache: each distinct SQL text is prepared once per connection
+    // and reused. A lease locks its statement (threads may share a pooled read
+    // connection) and resets it and clears bindings when released, so no read
+    // transaction stays open between calls.
+    struct CachedStatement {
+        CachedStatement(SQLite::Database& db, const std::string& sql) : stmt(db, sql) {}
+        std::mutex mtx;
+        SQLite::Statement stmt;
+    };
+
+    class StatementLease {
+    public:
+        explicit StatementLease(CachedStatement& entry) : lock_(entry.mtx), stmt_(entry.stmt) {}
+        ~StatementLease() {
+            try {
+                stmt_.reset();
+                stmt_.clearBindings();
+            } catch (...) {}
+        }
+        StatementLease(const StatementLease&) = delete;
+        StatementLease& operator=(const StatementLease&) = delete;
+        SQLite::Statement& operator*() { return stmt_; }
+
+    private:
+        std::unique_lock<std::mutex> lock_;
+        SQLite::Statement& stmt_;
+    };
+
+    // Read-only pooled connection with its own statement cache
+    struct ReadConnection {
+        ReadConnection(const std::string& path, const DbProfile& profile);
+        std::unique_ptr<SQLite::Database> db;
+        std::mutex cache_mtx;
+        std::unordered_map<std::string, std::unique_ptr<CachedStatement>> cache;
+    };
+
+    // Statements run on the write connection on the writer thread (and during
+    // construction), on the calling thread's pooled read connection elsewhere
+    StatementLease cached_statement(const std::string& sql);
+    ReadConnection& reader();
+    SQLite::Database& read_db();
+
+    // Writer thread
+    struct WriteJob {
+        std::function<void()> fn;   // Empty = stop
+        std::promise<void> done;
+        bool standalone = false;    // Runs outside the batch transaction (VACUUM, checkpoints)
+    };
+    bool on_writer_thread() const;
+    void run_write(std::function<void()> fn, bool standalone = false);
+    void writer_loop();
+    void commit_batch(std::vector<WriteJob>& jobs);
+    void run_standalone(WriteJob& job);
+
+    // Maintenance (writer thread only)
+    using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+    long long file_bytes() const;
+    long long pragma_int(const std::string& pragma);
+    bool vacuum_step(MaintenanceReport& r, Deadline deadline);
+    bool truncate_wal(int busy_timeout_ms);
+    bool idle_maintenance();
+
+    void import_row(const ArchiveRow& row, ConflictPolicy policy, ArchiveImportState& state);
+
+    void migrate();
+    void init_schema();
     void init_indexes();
+    void init_fulltext();
+    void init_attempts();
+    void init_stats();
+    void init_text_encoding();
+    void init_tids();
+    void init_cascades();
+    void init_tags();
+    void init_tag_triggers();
+    void init_fulltext_keys();
+    void index_plaintext(const std::string& id, const std::string& description);
+    void load_tid_map();
+    void forget_tid(const std::string& id);
+    void apply_attempt_rollups(const Attempt& a, const std::string& tags);
+    void recompute_attempt_rollups();
+    std::string path_;
     std::unique_ptr<SQLite::Database> db_;
+    DbProfile profile_;
+    // Counted from open, so idle passes do not all start with PRAGMA optimize
+    std::chrono::steady_clock::time_point last_optimize_ = std::chrono::steady_clock::now();
+    // Declared after db_ so cached statements are finalized before the connection closes
+    std::mutex stmt_cache_mtx_;
+    std::unordered_map<std::string, std::unique_ptr<CachedStatement>> stmt_cache_;
+    std::vector<std::unique_ptr<ReadConnection>> readers_;
+    utils::MpscQueue<WriteJob> write_queue_;
+    std::thread writer_;
+    std::atomic<uint64_t> write_jobs_{0};
+    std::atomic<uint64_t> write_batches_{0};
+    std::once_flag fts_once_;
+    bool fts_enabled_ = false;
+    std::once_flag tid_map_once_;
+    std::shared_mutex tid_map_mtx_;
+    std::unordered_map<int, std::string> id_by_tid_;
+    std::unordered_map<std::string, int> tid_by_id_;
 };
 
 } // namespace shuati
@@ -7,9 +7,22 @@
 
 namespace shuati {
 
+// Re-run policy for cases whose time lands close to the limit
+struct RepeatPolicy {
+    int repeats = 1;     // Extra runs for borderline cases (<= 1 disables)
+    double band = 0.2;   // Borderline = within band * time_limit of the limit
+};
+
 class Judge {
 public:
+    // Default cap on bytes a solution may write to stdout (and stderr)
+    static constexpr long long kDefaultOutputLimitBytes = 64LL * 1024 * 1024;
+
     Judge() = default;
+
+    // Output beyond this many bytes ends the run with Verdict::OLE (0 = unlimited)
+    void set_output_limit(long long bytes) { output_limit_bytes_ = bytes; }
+    long long output_limit() const { return output_limit_bytes_; }
     
     std::string prepare(const std::string& source_file, const std::string& language);
     JudgeResult run_prepared(const std::string& executable,
@@ -18,6 +31,16 @@ public:
                              int memory_limit_kb = 256 * 1024);
     void cleanup_prepared(const std::string& executable, const std::string& language);
 
+    // Runs once; if the result is AC/TLE within the policy band of the limit, re-runs
+    // the case policy.repeats times and decides the verdict on the median time.
+    JudgeResult run_prepared_repeated(const std::string& executable,
+                                      const TestCase& tc,
+                                      int time_limit_ms,
+                                      int memory_limit_kb,
+                                      const RepeatPolicy& policy);
+
+    static bool near_time_limit(const JudgeResult& res, int time_limit_ms, double band);
+
     // Compile and run solution against test cases
     // returns results for each test case
     std::vector<JudgeResult> judge(const std::string& source_file, 
@@ -33,14 +56,17 @@ public:
                                      int time_limit_ms, 
                                      int memory_limit_kb);
 
+    // Token-based comparison (whitespace-insensitive) used for every case
+    Verdict check_output(const std::string& user_out, const std::string& expected_out);
+
 private:
     std::string compile(const std::string& source_file, const std::string& language);
     JudgeResult run_case(const std::string& executable, 
                          const TestCase& tc, 
                          int time_limit_ms, 
                          int memory_limit_kb);
-    
-    Verdict check_output(const std::string& user_out, const std::string& expected_out);
+
+    long long output_limit_bytes_ = kDefaultOutputLimitBytes;
 };
 
 } // namespace shuati
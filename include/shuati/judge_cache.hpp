@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <filesystem>
+#include <unordered_map>
+#include "shuati/types.hpp"
+
+namespace shuati {
+
+/**
+ * @brief Persistent cache of per-case judge results.
+ *
+ * Entries are keyed by (executable hash, case content hash, limits), so a
+ * re-run of an unchanged binary against an unchanged case can be replayed
+ * without executing it. Only entries used during the current run are written
+ * back on save(), which drops results of stale binaries automatically.
+ */
+class JudgeCache {
+public:
+    explicit JudgeCache(std::filesystem::path path);
+
+    // Hash of the prepared executable (or the script behind a "PYTHON:" marker).
+    // Returns empty string if the file can't be read; callers should skip caching then.
+    static std::string hash_executable(const std::string& executable);
+
+    static std::string make_key(const std::string& exe_hash,
+                                const TestCase& tc,
+                                int time_limit_ms,
+                                int memory_limit_kb);
+
+    std::optional<JudgeResult> lookup(const std::string& key);
+    // Results that depend on machine load are not stored: TLE, MLE and any
+    // run within near_band * time_limit_ms of the limit (see RepeatPolicy::band)
+    void store(const std::string& key, const JudgeResult& result, int time_limit_ms, double near_band);
+    void save() const;
+
+    size_t hits() const { return hits_; }
+
+private:
+    struct Entry {
+        std::string verdict;
+        int time_ms = 0;
+        int memory_kb = 0;
+        std::string message;
+        std::string error_output;
+        std::string output;   // Only kept for non-AC results
+    };
+
+    void load();
+
+    std::filesystem::path path_;
+    std::unordered_map<std::string, Entry> entries_;  // Loaded from disk
+    std::unordered_map<std::string, Entry> live_;     // Used this run, persisted on save()
+    size_t hits_ = 0;
+};
+
+} // namespace shuati
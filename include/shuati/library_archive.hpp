@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include "shuati/database.hpp"
+
+namespace shuati {
+
+/**
+ * @brief Whole-library export/import as NDJSON, one JSON object per line.
+ *
+ * The first line is a header ({"t":"header","format":"shuati-library",...}),
+ * followed by one line per row in Database::export_archive order (the "t"
+ * field names the row type) and a closing {"t":"end","rows":N} line that
+ * tells a complete archive from a truncated one. Files named *.gz are
+ * gzip-compressed. Both directions stream: memory use is bounded by one
+ * import batch, whatever the size of the library.
+ */
+class LibraryArchive {
+public:
+    static constexpr int kFormatVersion = 1;
+    static constexpr size_t kBatchRows = 1000;          // Rows per import transaction...
+    static constexpr size_t kBatchBytes = 8 << 20;      // ...or fewer when the rows are large
+
+    // Rows written or read so far; called every kBatchRows rows
+    using Progress = std::function<void(long long rows, double elapsed_ms)>;
+
+    // Writes to "<file>.partial" and renames on success
+    static ArchiveCounts export_to(Database& db, const std::filesystem::path& file,
+                                   const Progress& progress = {});
+
+    // Throws on a malformed or truncated file and on a conflict under
+    // ConflictPolicy::Fail; batches committed before the error stay imported
+    static ArchiveCounts import_from(Database& db, const std::filesystem::path& file, ConflictPolicy policy,
+                                     const Progress& progress = {});
+
+    // "skip", "replace" or "fail"
+    static std::optional<ConflictPolicy> parse_policy(const std::string& name);
+};
+
+} // namespace shuati
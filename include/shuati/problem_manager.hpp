@@ -16,14 +16,18 @@ public:
     void pull_problem(const std::string& url);
     std::string create_local(const std::string& title, const std::string& tags, const std::string& difficulty);
     Problem get_problem(const std::string& id);
-    std::vector<Problem> list_problems();
+    std::vector<Problem> list_problems();                  // Full rows (with description)
+    std::vector<ProblemSummary> list_problem_summaries();  // Listing/pickers: no description
     void delete_problem(int tid);
     void delete_problem(const std::string& id);
+    // Batch delete by TID: one database transaction, then the problems' files
+    // (statement, solution_<id>.*, and <TID>_*.cpp|.py found with one directory
+    // scan). Returns the number of problems deleted.
+    int delete_problems(const std::vector<int>& tids);
     
-    std::vector<Problem> filter_problems(const std::vector<Problem>& problems,
-                                         const std::string& status_filter,
-                                         const std::string& difficulty_filter,
-                                         const std::string& source_filter = "all");
+    // Filtered, paginated listing evaluated in SQL (see Database::query_problems)
+    ProblemPage query_problems(const ProblemQuery& query);
+    int count_problems(const ProblemQuery& query);
 
     void register_crawler(std::unique_ptr<ICrawler> crawler);
 
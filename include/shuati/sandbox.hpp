@@ -12,6 +12,7 @@ enum class SandboxResultStatus {
     OK,                 // Execution completed normally
     TimeLimitExceeded,  // Execution exceeded time limit
     MemoryLimitExceeded,// Execution exceeded memory limit
+    OutputLimitExceeded,// Wrote more than output_limit_bytes to stdout/stderr
     RuntimeError,       // Execution crashed/exited with non-zero
     InternalError       // Sandbox failed to initialize or monitor process
 };
@@ -19,6 +20,7 @@ enum class SandboxResultStatus {
 struct SandboxLimits {
     long long cpu_time_ms; // CPU time limit in milliseconds
     long long memory_mb;   // Memory limit in megabytes
+    long long output_limit_bytes = 0; // Per-file limit for stdout/stderr, 0 = unlimited
 };
 
 struct SandboxResult {
@@ -23,7 +23,7 @@ public:
 
     /**
      * @brief Automatically compute quality score from judge verdict and time ratio
-     * @param verdict Verdict string: "AC", "WA", "TLE", "RE", "CE", "MLE"
+     * @param verdict Verdict string: "AC", "WA", "TLE", "RE", "CE", "MLE", "OLE"
      * @param time_ms Actual execution time in milliseconds
      * @param time_limit_ms Time limit in milliseconds
      * @return Quality score (0-5)
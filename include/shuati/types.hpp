@@ -6,7 +6,7 @@
 namespace shuati {
 
 struct Problem {
-    int display_id = 0;   // 1-based numeric ID (TID)
+    int display_id = 0;   // Numeric ID (TID): stable, never reused after a delete
     std::string id;       // UUID or original string ID
     std::string source;   // "web", "local"
     std::string title;
@@ -24,6 +24,26 @@ struct Problem {
     long long last_checked_at = 0;
 };
 
+// List-view projection of Problem: every column except the description blob.
+// Use Database::get_problem / ProblemManager::get_problem for the full statement.
+struct ProblemSummary {
+    int display_id = 0;
+    std::string id;
+    std::string source;
+    std::string title;
+    std::string url;
+    std::string content_path;
+    std::string tags;
+    std::string difficulty;
+    long long created_at = 0;
+
+    std::string last_verdict;
+    int pass_count = 0;
+    int total_count = 0;
+    long long last_checked_at = 0;
+    bool review_due = false; // Only set by Database::query_problems (review due at ProblemQuery::now)
+};
+
 struct Mistake {
     int id = 0;
     std::string problem_id;
@@ -73,11 +93,21 @@ enum class Verdict {
     WA,  // Wrong Answer
     TLE, // Time Limit Exceeded
     MLE, // Memory Limit Exceeded
+    OLE, // Output Limit Exceeded
     RE,  // Runtime Error
     CE,  // Compilation Error
     SE   // System Error
 };
 
+// Spread of execution times when a case is re-run (see Judge::run_prepared_repeated)
+struct TimingStats {
+    int runs = 1;
+    int min_ms = 0;
+    int median_ms = 0;
+    int max_ms = 0;
+    double cv = 0.0;         // Coefficient of variation (stddev / mean)
+};
+
 struct JudgeResult {
     Verdict verdict;
     int time_ms;
@@ -87,6 +117,8 @@ struct JudgeResult {
     std::string input;
     std::string output;
     std::string expected;
+    bool cached = false;     // Replayed from JudgeCache instead of executed
+    TimingStats timing;      // runs > 1 when re-run near the time limit
     
     std::string verdict_str() const;
 };
@@ -97,15 +129,30 @@ struct TestReport {
     std::string verdict;
     int pass_count;
     int total_count;
+    int cached_count = 0;    // Cases replayed from JudgeCache
     std::vector<JudgeResult> cases;
 };
 
+// One `shuati test` run, appended to the attempts table (never updated)
+struct Attempt {
+    long long id = 0;
+    std::string problem_id;
+    long long timestamp = 0;
+    std::string verdict;
+    int pass_count = 0;
+    int total_count = 0;
+    int max_time_ms = 0;      // Slowest case
+    int max_memory_kb = 0;    // Largest case
+    std::string source_hash;  // fnv1a_64 of the submitted source (hex), empty if unknown
+};
+
 inline std::string JudgeResult::verdict_str() const {
     switch (verdict) {
         case Verdict::AC: return "AC";
         case Verdict::WA: return "WA";
         case Verdict::TLE: return "TLE";
         case Verdict::MLE: return "MLE";
+        case Verdict::OLE: return "OLE";
         case Verdict::RE: return "RE";
         case Verdict::CE: return "CE";
         case Verdict::SE: return "SE";
@@ -113,4 +160,15 @@ inline std::string JudgeResult::verdict_str() const {
     }
 }
 
+inline Verdict verdict_from_string(const std::string& v) {
+    if (v == "AC") return Verdict::AC;
+    if (v == "WA") return Verdict::WA;
+    if (v == "TLE") return Verdict::TLE;
+    if (v == "MLE") return Verdict::MLE;
+    if (v == "OLE") return Verdict::OLE;
+    if (v == "RE") return Verdict::RE;
+    if (v == "CE") return Verdict::CE;
+    return Verdict::SE;
+}
+
 } // namespace shuati
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <filesystem>
 
 namespace shuati::utils {
 
-// Check if a string is valid UTF-8
-bool is_valid_utf8(const std::string& s);
+// Check if a string is well-formed UTF-8 (no overlong forms, surrogates or
+// code points above U+10FFFF). Uses SSSE3 on x86-64 when the CPU has it.
+bool is_valid_utf8(std::string_view s);
+
+// Portable byte-at-a-time version of is_valid_utf8, for tests and benchmarks
+bool is_valid_utf8_scalar(std::string_view s);
 
 // Convert Active Code Page (Windows) to UTF-8
 std::string acp_to_utf8(const std::string& s);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace shuati::utils {
+
+// Lock-free multi-producer / single-consumer queue.
+//
+// Producers push onto an intrusive stack with a CAS loop; the consumer takes
+// the whole stack with one exchange and reverses it, so items come out in push
+// order and in batches (everything queued since the last drain). Push-only
+// producers plus take-all consumption means no ABA hazard.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    ~MpscQueue() { drain(); }
+
+    void push(T value) {
+        Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {}
+        head_.notify_one();
+    }
+
+    // Everything pushed so far, oldest first; empty if nothing is queued
+    std::vector<T> drain() {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        std::vector<T> out;
+        while (node) {
+            out.push_back(std::move(node->value));
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+    // Blocks the consumer until the queue is non-empty
+    void wait() const { head_.wait(nullptr, std::memory_order_acquire); }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+    std::atomic<Node*> head_{nullptr};
+};
+
+} // namespace shuati::utils
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <regex>
 #include <optional>
+#include <cstdint>
+#include <string_view>
+#include <fmt/core.h>
 
 namespace shuati::utils {
 
@@ -129,6 +132,52 @@ inline std::string strip_html_tags(const std::string& html) {
     return std::regex_replace(html, re, "");
 }
 
+// Readable text of an HTML (or Markdown) statement, for full-text indexing:
+// drops tags, decodes the common entities and collapses whitespace runs.
+// A '<' not followed by a letter, '/' or '!' is kept, so "1 < n" survives.
+inline std::string html_to_plaintext(std::string_view html) {
+    static constexpr std::pair<std::string_view, char> kEntities[] = {
+        {"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}, {"&quot;", '"'}, {"&#39;", '\''}, {"&nbsp;", ' '},
+    };
+    std::string out;
+    out.reserve(html.size());
+    bool pending_space = false;
+    auto emit = [&](char c) {
+        if (c == ' ' || c == '\n' || c == '\t' || c == '\r') {
+            pending_space = !out.empty();
+            return;
+        }
+        if (pending_space) out += ' ';
+        pending_space = false;
+        out += c;
+    };
+    for (size_t i = 0; i < html.size(); ++i) {
+        char c = html[i];
+        if (c == '<' && i + 1 < html.size() &&
+            (std::isalpha(static_cast<unsigned char>(html[i + 1])) || html[i + 1] == '/' || html[i + 1] == '!')) {
+            size_t end = html.find('>', i);
+            if (end == std::string_view::npos) break;
+            i = end;
+            emit(' ');
+            continue;
+        }
+        if (c == '&') {
+            bool decoded = false;
+            for (const auto& [entity, ch] : kEntities) {
+                if (html.substr(i, entity.size()) == entity) {
+                    emit(ch);
+                    i += entity.size() - 1;
+                    decoded = true;
+                    break;
+                }
+            }
+            if (decoded) continue;
+        }
+        emit(c);
+    }
+    return out;
+}
+
 inline std::string extract_regex_group(const std::string& text, const std::string& pattern, size_t group = 1) {
     std::regex re(pattern);
     std::smatch m;
@@ -152,6 +201,20 @@ inline std::string sanitize_filename(std::string filename) {
     return filename;
 }
 
+// Stable 64-bit FNV-1a hash (unlike std::hash, identical across runs and platforms)
+inline uint64_t fnv1a_64(std::string_view data, uint64_t seed = 0xcbf29ce484222325ULL) {
+    uint64_t h = seed;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+inline std::string hash_hex(uint64_t h) {
+    return fmt::format("{:016x}", h);
+}
+
 // Safe string to number conversion
 template<typename T>
 inline std::optional<T> try_parse_number(const std::string& str) {
@@ -104,7 +104,8 @@ std::string AICoach::call_api(const std::string& system_prompt, const std::strin
     }
 }
 
-std::string AICoach::analyze(const std::string& problem_desc, const std::string& user_code, std::function<void(std::string)> callback) {
+std::string AICoach::analyze(const std::string& problem_desc, const std::string& user_code, std::function<void(std::string)> callback,
+                             const std::string& tags) {
     // For streaming, call_api returns error string if any, otherwise empty.
     // Increase timeout for long Chain of Thought
     std::string sys = 
@@ -128,7 +129,7 @@ std::string AICoach::analyze(const std::string& problem_desc, const std::string&
 
     if (mm_) {
         // RAG-Lite: Inject memory context
-        std::string memory_context = mm_->get_relevant_context("");
+        std::string memory_context = mm_->get_relevant_context(tags);
         if (!memory_context.empty()) {
             sys += "\n\n" + memory_context;
         }
@@ -303,7 +304,8 @@ std::pair<std::string, std::string> AICoach::generate_test_scripts(const std::st
 
 AICoach::AIResponse AICoach::analyze_structured(const std::string& problem_desc,
                                                  const std::string& user_code,
-                                                 std::function<void(std::string)> on_hint) {
+                                                 std::function<void(std::string)> on_hint,
+                                                 const std::string& tags) {
     AIResponse result;
 
     std::string sys =
@@ -331,7 +333,7 @@ AICoach::AIResponse AICoach::analyze_structured(const std::string& problem_desc,
         "</memory_op>\n";
 
     if (mm_) {
-        std::string memory_context = mm_->get_relevant_context("");
+        std::string memory_context = mm_->get_relevant_context(tags);
         if (!memory_context.empty()) {
             sys += "\n\n" + memory_context;
         }
@@ -68,10 +68,8 @@ void CompanionServer::handle_post(const httplib::Request& req, httplib::Response
         p.url = url;
         p.created_at = std::time(nullptr);
         
-        // All DB operations guarded by mutex to prevent "database is locked" from
-        // concurrent writes between this HTTP handler thread and the main thread.
-        std::lock_guard<std::mutex> lock(db_mutex_);
-
+        // No locking needed: Database serializes writes on its writer thread, and
+        // concurrent submissions are committed together in one transaction.
         // Check if exists
         try {
             auto existing = db_.get_problem(id);
@@ -82,17 +80,18 @@ void CompanionServer::handle_post(const httplib::Request& req, httplib::Response
             }
         } catch (...) {}
 
-        // Save problem
-        db_.add_problem(p);
-        
         // Extract tests
+        std::vector<TestCase> cases;
         if (json.contains("tests")) {
             for (const auto& test : json["tests"]) {
-                std::string input = test.value("input", "");
-                std::string output = test.value("output", "");
-                db_.add_test_case(id, input, output, true);
+                cases.push_back({test.value("input", ""), test.value("output", ""), true});
             }
-            fmt::print(fg(fmt::color::green), "  Saved with {} test cases.\n", json["tests"].size());
+        }
+
+        // Save problem and tests in one transaction
+        db_.add_problem_with_cases(p, cases);
+        if (!cases.empty()) {
+            fmt::print(fg(fmt::color::green), "  Saved with {} test cases.\n", cases.size());
         }
 
         // Ideally we would notify the main thread or ProblemManager here
@@ -0,0 +1,172 @@
+#pragma once
+
+// Shared helpers for the bench_* executables: argument parsing, sample
+// statistics and the JSON result document tracked between releases.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#ifndef SHUATI_VERSION
+#define SHUATI_VERSION "dev"
+#endif
+
+namespace shuati {
+namespace bench {
+
+struct BenchOptions {
+    std::string out_path;   // --out <file>: write JSON there instead of stdout
+    int iterations = 0;     // --iterations <n>: override per-workload default (0 = default)
+    bool quick = false;     // --quick: smallest sizes, for CI smoke runs
+    std::string filter;     // --filter <substr>: only run matching workloads
+    int problems = -1;      // --problems <n>: fixture size for suites that seed a library (-1 = default)
+    int cases = -1;         // --cases <m>: test cases per fixture problem (-1 = default)
+
+    int iters_or(int fallback) const { return iterations > 0 ? iterations : fallback; }
+    int problems_or(int fallback) const { return problems > 0 ? problems : fallback; }
+    int cases_or(int fallback) const { return cases >= 0 ? cases : fallback; }
+    bool selected(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+};
+
+inline BenchOptions parse_args(int argc, char** argv) {
+    BenchOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "[!] " << a << " requires a value" << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--out") opt.out_path = next();
+        else if (a == "--iterations") opt.iterations = std::atoi(next().c_str());
+        else if (a == "--filter") opt.filter = next();
+        else if (a == "--problems") opt.problems = std::atoi(next().c_str());
+        else if (a == "--cases") opt.cases = std::atoi(next().c_str());
+        else if (a == "--quick") opt.quick = true;
+        else if (a == "--help" || a == "-h") {
+            std::cout << "Usage: " << argv[0]
+                      << " [--out file.json] [--iterations N] [--filter name] [--quick]"
+                      << " [--problems N] [--cases M]" << std::endl;
+            std::exit(0);
+        } else {
+            std::cerr << "[!] Unknown argument: " << a << std::endl;
+            std::exit(2);
+        }
+    }
+    return opt;
+}
+
+class Stopwatch {
+public:
+    Stopwatch() : begin_(std::chrono::steady_clock::now()) {}
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// min/median/p95/max/mean (and coefficient of variation) of a sample set, in ms
+inline nlohmann::json summarize(std::vector<double> samples) {
+    if (samples.empty()) return nlohmann::json::object();
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        size_t idx = static_cast<size_t>(std::ceil(q * samples.size())) - 1;
+        return samples[std::min(idx, samples.size() - 1)];
+    };
+    double sum = std::accumulate(samples.begin(), samples.end(), 0.0);
+    double mean = sum / samples.size();
+    double var = 0;
+    for (double s : samples) var += (s - mean) * (s - mean);
+    double stddev = std::sqrt(var / samples.size());
+    return {
+        {"min", samples.front()},
+        {"median", at(0.5)},
+        {"p95", at(0.95)},
+        {"max", samples.back()},
+        {"mean", mean},
+        {"cv", mean > 0 ? stddev / mean : 0.0},
+    };
+}
+
+// Collects workload results and writes the suite's JSON document
+class BenchReport {
+public:
+    BenchReport(std::string suite, BenchOptions opt) : suite_(std::move(suite)), opt_(std::move(opt)) {}
+
+    void add(const std::string& name, nlohmann::json metrics) {
+        metrics["name"] = name;
+        std::cerr << "[bench] " << suite_ << "/" << name << " done" << std::endl;
+        results_.push_back(std::move(metrics));
+    }
+
+    // Returns the process exit code
+    int finish() const {
+        nlohmann::json doc = {
+            {"suite", suite_},
+            {"version", SHUATI_VERSION},
+            {"timestamp", static_cast<long long>(std::time(nullptr))},
+            {"platform", platform()},
+            {"compiler", compiler()},
+            {"quick", opt_.quick},
+            {"results", results_},
+        };
+        std::string text = doc.dump(2);
+        if (opt_.out_path.empty()) {
+            std::cout << text << std::endl;
+            return 0;
+        }
+        std::ofstream out(opt_.out_path);
+        if (!out) {
+            std::cerr << "[!] Cannot write " << opt_.out_path << std::endl;
+            return 1;
+        }
+        out << text << std::endl;
+        std::cerr << "[+] Results written to " << opt_.out_path << std::endl;
+        return 0;
+    }
+
+private:
+    static std::string platform() {
+#if defined(_WIN32)
+        return "windows";
+#elif defined(__APPLE__)
+        return "macos";
+#else
+        return "linux";
+#endif
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return fmt::format("clang {}.{}", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+        return fmt::format("gcc {}.{}", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+        return fmt::format("msvc {}", _MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    std::string suite_;
+    BenchOptions opt_;
+    nlohmann::json results_ = nlohmann::json::array();
+};
+
+} // namespace bench
+} // namespace shuati
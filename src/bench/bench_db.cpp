@@ -0,0 +1,933 @@
+// bench_db: latency of Database queries against a synthetic problem set.
+//
+// A fresh database is generated in the temp directory on every run so results
+// are comparable between releases: --problems N problems with --cases M test
+// cases, a review and (for every 4th) a mistake each, all derived from the row
+// index. The "fixture" entry records its size and generation time. Results are printed as JSON; see
+// bench_common.hpp for the command line.
+
+#include "bench_common.hpp"
+#include "shuati/database.hpp"
+#include "shuati/utils/encoding.hpp"
+#include "shuati/utils/string_utils.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <random>
+#include <thread>
+
+using namespace shuati;
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* kSources[] = {"codeforces", "luogu", "leetcode", "lanqiao", "local"};
+const char* kDifficulties[] = {"easy", "medium", "hard"};
+const char* kVerdicts[] = {"", "AC", "WA", "TLE", "RE"};
+const char* kTags[] = {"dp", "greedy", "graph", "math", "strings", "bfs", "dfs", "binary search",
+                       "sorting", "trees", "bitmasks", "geometry", "two pointers", "number theory"};
+
+// Two or three tags per problem, spread over the 14 in kTags
+std::string fixture_tags(int i) {
+    std::string tags = fmt::format("{},{}", kTags[i % 14], kTags[(i / 14 + 1 + i) % 14]);
+    if (i % 3 == 0) tags += fmt::format(",{}", kTags[(i * 5 + 3) % 14]);
+    return tags;
+}
+
+// Statement-sized HTML body (~6 KB), roughly what the crawlers store. Words come
+// from a fixed vocabulary so the text has natural-language-like trigram reuse;
+// uniformly random letters would make the FTS index unrealistically expensive.
+std::string make_description(std::mt19937& rng, int i) {
+    static const std::vector<std::string> vocab = [] {
+        std::mt19937 vrng(7);
+        std::uniform_int_distribution<int> letter(0, 25), len(3, 9);
+        std::vector<std::string> words(400);
+        for (auto& w : words) {
+            int n = len(vrng);
+            for (int k = 0; k < n; ++k) w += static_cast<char>('a' + letter(vrng));
+        }
+        return words;
+    }();
+    std::string s = fmt::format("<h1>Problem {}</h1>\n", i);
+    std::uniform_int_distribution<size_t> word(0, vocab.size() - 1);
+    while (s.size() < 6000) {
+        s += "<p>";
+        for (int w = 0; w < 40; ++w) {
+            s += vocab[word(rng)];
+            s += ' ';
+        }
+        s += "</p>\n";
+    }
+    return s;
+}
+
+// Size of the generated library. Every row is a pure function of the spec and
+// its index, so two runs with the same --problems/--cases build the same data.
+struct FixtureSpec {
+    int problems = 0;
+    int cases = 0;           // test cases per problem
+    int mistake_every = 4;   // every 4th problem has a logged mistake
+};
+
+// Each problem has a review due on one of 30 consecutive days; half of them
+// fall on or before kFixtureNow
+constexpr long long kFixtureNow = 1700000000 + 15 * 86400;
+long long review_at(int i) { return 1700000000 + (i % 30) * 86400LL; }
+
+// Test case k of problem i: a line of n numbers and their sum
+TestCase make_case(int i, int k) {
+    int n = 5 + (i + k) % 20;
+    std::string input = fmt::format("{}\n", n);
+    long long sum = 0;
+    for (int x = 0; x < n; ++x) {
+        int v = (i * 31 + k * 17 + x * 7) % 1000;
+        sum += v;
+        input += fmt::format("{}{}", x ? " " : "", v);
+    }
+    return {input + "\n", fmt::format("{}\n", sum), k < 2};
+}
+
+// Bulk-loads the fixture through a side connection in one transaction; the
+// Database under test has already created the schema. Returns row counts.
+nlohmann::json generate_library(const fs::path& db_path, const FixtureSpec& spec) {
+    SQLite::Database raw(db_path.string(), SQLite::OPEN_READWRITE);
+    std::mt19937 rng(42);
+    SQLite::Transaction tx(raw);
+    SQLite::Statement q(raw,
+        "INSERT INTO problems (id,source,title,url,content_path,description,tags,difficulty,created_at,"
+        "last_verdict,pass_count,total_count,last_checked_at,source_key,tid) VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+    SQLite::Statement tc(raw, "INSERT INTO test_cases (problem_id,input,output,is_sample) VALUES (?,?,?,?)");
+    SQLite::Statement rv(raw,
+        "INSERT INTO reviews (problem_id,next_review,interval,ease_factor,repetitions) VALUES (?,?,?,?,?)");
+    SQLite::Statement mk(raw, "INSERT INTO mistakes (problem_id,type,description,timestamp) VALUES (?,?,?,?)");
+    // The FTS triggers index the raw HTML; Database::add_problem then stores the
+    // plaintext, so the fixture does the same
+    std::optional<SQLite::Statement> fts;
+    if (raw.tableExists("problems_fts")) fts.emplace(raw, "UPDATE problems_fts SET body = ? WHERE rowid = ?");
+    long long cases = 0, mistakes = 0;
+    for (int i = 0; i < spec.problems; ++i) {
+        const char* src = kSources[i % 5];
+        std::string id = fmt::format("{}_{}", src, i);
+        q.bind(1, id);
+        q.bind(2, src);
+        q.bind(3, fmt::format("Synthetic problem {} 第{}题", i, i));
+        q.bind(4, fmt::format("https://example.com/{}/{}", src, i));
+        q.bind(5, fmt::format(".shuati/problems/{}/{}_{}/problem.md", src, src, i));
+        std::string description = make_description(rng, i);
+        q.bind(6, description);
+        q.bind(7, fixture_tags(i));
+        q.bind(8, kDifficulties[i % 3]);
+        q.bind(9, static_cast<int64_t>(1700000000 + i));
+        q.bind(10, kVerdicts[i % 5]);
+        q.bind(11, i % 10);
+        q.bind(12, 10);
+        q.bind(13, static_cast<int64_t>(i % 5 ? 1700000000 + i : 0));
+        q.bind(14, src);  // kSources are already canonical
+        q.bind(15, i + 1);
+        q.exec();
+        q.reset();
+        if (fts) {
+            fts->bind(1, utils::html_to_plaintext(description));
+            fts->bind(2, i + 1);
+            fts->exec();
+            fts->reset();
+        }
+
+        for (int k = 0; k < spec.cases; ++k) {
+            auto c = make_case(i, k);
+            tc.bind(1, id);
+            tc.bind(2, c.input);
+            tc.bind(3, c.output);
+            tc.bind(4, c.is_sample ? 1 : 0);
+            tc.exec();
+            tc.reset();
+            ++cases;
+        }
+
+        rv.bind(1, id);
+        rv.bind(2, static_cast<int64_t>(review_at(i)));
+        rv.bind(3, 1 + i % 20);
+        rv.bind(4, 1.3 + (i % 13) * 0.1);
+        rv.bind(5, i % 6);
+        rv.exec();
+        rv.reset();
+
+        if (spec.mistake_every > 0 && i % spec.mistake_every == 0) {
+            mk.bind(1, id);
+            mk.bind(2, kVerdicts[1 + i % 4]);
+            mk.bind(3, fmt::format("Synthetic mistake on problem {}", i));
+            mk.bind(4, static_cast<int64_t>(1700000000 + i));
+            mk.exec();
+            mk.reset();
+            ++mistakes;
+        }
+    }
+    tx.commit();
+    return {{"problems", spec.problems}, {"cases_per_problem", spec.cases}, {"test_cases", cases},
+            {"reviews", spec.problems}, {"mistakes", mistakes}};
+}
+
+size_t payload_bytes(const Problem& p) {
+    return p.id.size() + p.source.size() + p.title.size() + p.url.size() + p.content_path.size() +
+           p.description.size() + p.tags.size() + p.difficulty.size() + p.last_verdict.size();
+}
+
+size_t payload_bytes(const ProblemSummary& p) {
+    return p.id.size() + p.source.size() + p.title.size() + p.url.size() + p.content_path.size() +
+           p.tags.size() + p.difficulty.size() + p.last_verdict.size();
+}
+
+template <typename Fn>
+nlohmann::json time_listing(Fn&& fn, int iterations) {
+    std::vector<double> samples;
+    size_t rows = 0, bytes = 0;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch sw;
+        auto list = fn();
+        samples.push_back(sw.elapsed_ms());
+        rows = list.size();
+        bytes = 0;
+        for (const auto& p : list) bytes += payload_bytes(p);
+    }
+    return {
+        {"iterations", iterations},
+        {"rows", rows},
+        {"payload_bytes", bytes},
+        {"wall_ms", bench::summarize(samples)},
+    };
+}
+
+// Per-call latency in microseconds, sampled over batches of `batch` calls
+template <typename Fn>
+nlohmann::json time_calls(Fn&& fn, int batches, int batch) {
+    std::vector<double> samples;
+    int n = 0;
+    for (int b = 0; b < batches; ++b) {
+        bench::Stopwatch sw;
+        for (int i = 0; i < batch; ++i) fn(n++);
+        samples.push_back(sw.elapsed_ms() * 1000.0 / batch);
+    }
+    auto stats = bench::summarize(samples);
+    double median_us = stats["median"].get<double>();
+    return {
+        {"calls", n},
+        {"call_us", std::move(stats)},
+        {"calls_per_sec", median_us > 0 ? 1e6 / median_us : 0.0},
+    };
+}
+
+// Database's statement cache against preparing the same SQL on every call
+// (the pre-cache behaviour), on a second connection to the same file.
+void bench_statement_cache(Database& db, const fs::path& db_path, int problem_count,
+                           const bench::BenchOptions& opt, bench::BenchReport& report) {
+    SQLite::Database raw(db_path.string(), SQLite::OPEN_READWRITE);
+    raw.exec("PRAGMA synchronous=NORMAL");
+    int batches = opt.iters_or(opt.quick ? 10 : 30);
+    int batch = 100;
+
+    auto problem_id = [&](int i) {
+        return fmt::format("{}_{}", kSources[(i * 7919 % problem_count) % 5], i * 7919 % problem_count);
+    };
+    auto compare = [&](const std::string& name, auto&& cached, auto&& uncached) {
+        if (!opt.selected(name)) return;
+        auto c = time_calls(cached, batches, batch);
+        auto u = time_calls(uncached, batches, batch);
+        double cm = c["call_us"]["median"].template get<double>();
+        double um = u["call_us"]["median"].template get<double>();
+        report.add(name, {{"cached", std::move(c)}, {"uncached", std::move(u)}, {"speedup", cm > 0 ? um / cm : 0.0}});
+    };
+
+    compare("stmt_get_problem",
+        [&](int i) { db.get_problem(problem_id(i)); },
+        [&](int i) {
+            SQLite::Statement q(raw,
+                "SELECT rowid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
+                "last_verdict, pass_count, total_count, last_checked_at FROM problems WHERE id=? LIMIT 1");
+            q.bind(1, problem_id(i));
+            q.executeStep();
+        });
+    compare("stmt_add_test_case",
+        [&](int i) { db.add_test_case(problem_id(i), "1 2\n", "3\n", true); },
+        [&](int i) {
+            SQLite::Statement q(raw, "INSERT INTO test_cases (problem_id,input,output,is_sample) VALUES (?,?,?,?)");
+            q.bind(1, problem_id(i));
+            q.bind(2, "1 2\n");
+            q.bind(3, "3\n");
+            q.bind(4, 1);
+            q.exec();
+        });
+    compare("stmt_upsert_review",
+        [&](int i) {
+            ReviewItem r;
+            r.problem_id = problem_id(i);
+            r.next_review = 1700000000 + i;
+            db.upsert_review(r);
+        },
+        [&](int i) {
+            SQLite::Statement q(raw,
+                "INSERT OR REPLACE INTO reviews (problem_id,next_review,interval,ease_factor,repetitions) "
+                "VALUES (?,?,?,?,?)");
+            q.bind(1, problem_id(i));
+            q.bind(2, static_cast<int64_t>(1700000000 + i));
+            q.bind(3, 1);
+            q.bind(4, 2.5);
+            q.bind(5, 0);
+            q.exec();
+        });
+}
+
+// Pull-style import of problems with 100 test cases each: one autocommit per row
+// (the old pull/Companion path) against add_problem_with_cases()
+void bench_import(Database& db, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    const int imports = opt.iters_or(opt.quick ? 5 : 20);
+    const int case_count = 100;
+    std::vector<TestCase> cases;
+    for (int i = 0; i < case_count; ++i) cases.push_back({fmt::format("{} {}\n", i, i + 1), fmt::format("{}\n", 2 * i + 1), i < 3});
+
+    auto make = [](const std::string& tag, int i) {
+        Problem p;
+        p.id = fmt::format("import_{}_{}", tag, i);
+        p.source = "codeforces";
+        p.title = p.id;
+        p.url = "https://example.com/import/" + p.id;
+        p.description = "<p>statement</p>";
+        return p;
+    };
+    auto review_for = [](const std::string& id) {
+        ReviewItem r;
+        r.problem_id = id;
+        r.next_review = 1700000000;
+        return r;
+    };
+
+    std::vector<double> per_row, batched;
+    for (int i = 0; i < imports; ++i) {
+        if (opt.selected("import_autocommit")) {
+            auto p = make("seq", i);
+            bench::Stopwatch sw;
+            db.add_problem(p);
+            for (const auto& tc : cases) db.add_test_case(p.id, tc.input, tc.output, tc.is_sample);
+            db.upsert_review(review_for(p.id));
+            per_row.push_back(sw.elapsed_ms());
+        }
+        if (opt.selected("import_transaction")) {
+            auto p = make("tx", i);
+            bench::Stopwatch sw;
+            db.add_problem_with_cases(p, cases, review_for(p.id));
+            batched.push_back(sw.elapsed_ms());
+        }
+    }
+    if (!per_row.empty()) {
+        report.add("import_autocommit", {{"imports", imports}, {"cases", case_count}, {"wall_ms", bench::summarize(per_row)}});
+    }
+    if (!batched.empty()) {
+        report.add("import_transaction", {{"imports", imports}, {"cases", case_count}, {"wall_ms", bench::summarize(batched)}});
+    }
+}
+
+// Companion-style bursts: several threads importing at once. The writer thread
+// folds whatever is queued into one transaction, so fewer commits than imports.
+void bench_write_burst(Database& db, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    if (!opt.selected("write_burst")) return;
+    const int threads = 8;
+    const int per_thread = opt.quick ? 25 : 100;
+    std::vector<TestCase> cases(5, TestCase{"1 2\n", "3\n", true});
+    auto before = db.write_stats();
+    bench::Stopwatch sw;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                Problem p;
+                p.id = fmt::format("burst_{}_{}", t, i);
+                p.source = "codeforces";
+                p.title = p.id;
+                p.url = "https://example.com/burst/" + p.id;
+                p.description = "<p>statement</p>";
+                db.add_problem_with_cases(p, cases);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double wall = sw.elapsed_ms();
+    auto after = db.write_stats();
+    uint64_t jobs = after.jobs - before.jobs, batches = after.batches - before.batches;
+    report.add("write_burst", {{"threads", threads}, {"imports", threads * per_thread}, {"transactions", batches},
+                               {"imports_per_transaction", batches ? static_cast<double>(jobs) / batches : 0.0},
+                               {"wall_ms", wall}, {"import_ms", wall / (threads * per_thread)}});
+}
+
+// Dashboard analytics over years of attempt history: the rollup tables against
+// aggregating the attempts table directly, plus the cost of record_attempt.
+void bench_attempts(Database& db, const fs::path& db_path, int problem_count,
+                    const bench::BenchOptions& opt, bench::BenchReport& report) {
+    if (!opt.selected("attempts_rollup") && !opt.selected("attempts_scan") && !opt.selected("attempt_record")) return;
+    const int attempt_count = opt.quick ? 50000 : 500000;
+    const long long start = 1600000000;  // ~3 years of history before `now`
+    const long long now = start + 3LL * 365 * 86400;
+    {
+        SQLite::Database raw(db_path.string(), SQLite::OPEN_READWRITE);
+        std::mt19937 rng(99);
+        std::uniform_int_distribution<int> pick(0, problem_count - 1);
+        std::uniform_int_distribution<int> verdict(0, 4), ms(1, 2000);
+        SQLite::Transaction tx(raw);
+        SQLite::Statement q(raw, "INSERT INTO attempts (problem_id,timestamp,verdict,max_time_ms,max_memory_kb) "
+                                 "VALUES (?,?,?,?,1024)");
+        for (int i = 0; i < attempt_count; ++i) {
+            int p = pick(rng);
+            q.bind(1, fmt::format("{}_{}", kSources[p % 5], p));
+            q.bind(2, static_cast<int64_t>(start + (now - start) * i / attempt_count));
+            q.bind(3, verdict(rng) < 2 ? "AC" : "WA");
+            q.bind(4, ms(rng));
+            q.exec();
+            q.reset();
+        }
+        tx.commit();
+    }
+    db.rebuild_attempt_rollups();
+
+    int iters = opt.iters_or(opt.quick ? 20 : 50);
+    const long long since = now - 52LL * 7 * 86400;
+    if (opt.selected("attempts_rollup")) {
+        std::vector<double> samples;
+        size_t rows = 0;
+        for (int i = 0; i < iters; ++i) {
+            bench::Stopwatch sw;
+            auto weeks = db.get_weekly_attempts(since);
+            auto tags = db.get_tag_attempts(since);
+            samples.push_back(sw.elapsed_ms());
+            rows = weeks.size() + tags.size();
+        }
+        report.add("attempts_rollup", {{"iterations", iters}, {"attempts", attempt_count}, {"rows", rows},
+                                       {"wall_ms", bench::summarize(samples)}});
+    }
+    if (opt.selected("attempts_scan")) {
+        // Same numbers computed from the raw log (tags expanded with json_each)
+        SQLite::Database raw(db_path.string(), SQLite::OPEN_READONLY);
+        std::vector<double> samples;
+        size_t rows = 0;
+        for (int i = 0; i < iters; ++i) {
+            rows = 0;
+            bench::Stopwatch sw;
+            SQLite::Statement weeks(raw,
+                "SELECT (timestamp + 259200) / 604800, COUNT(*), SUM(verdict = 'AC') FROM attempts "
+                "WHERE timestamp >= ? GROUP BY 1");
+            weeks.bind(1, static_cast<int64_t>(since));
+            while (weeks.executeStep()) ++rows;
+            SQLite::Statement tags(raw,
+                "SELECT trim(t.value), COUNT(*), SUM(a.verdict = 'AC') FROM attempts a "
+                "JOIN problems p ON p.id = a.problem_id, "
+                "json_each('[\"' || replace(p.tags, ',', '\",\"') || '\"]') t "
+                "WHERE a.timestamp >= ? GROUP BY 1 ORDER BY 2 DESC");
+            tags.bind(1, static_cast<int64_t>(since));
+            while (tags.executeStep()) ++rows;
+            samples.push_back(sw.elapsed_ms());
+        }
+        report.add("attempts_scan", {{"iterations", iters}, {"attempts", attempt_count}, {"rows", rows},
+                                     {"wall_ms", bench::summarize(samples)}});
+    }
+    if (opt.selected("attempt_record")) {
+        int batches = opt.iters_or(opt.quick ? 10 : 30);
+        report.add("attempt_record", time_calls([&](int i) {
+            Attempt a;
+            a.problem_id = fmt::format("{}_{}", kSources[i % 5], i % problem_count);
+            a.timestamp = now + i;
+            a.verdict = i % 3 ? "WA" : "AC";
+            a.max_time_ms = 100;
+            db.record_attempt(a);
+        }, batches, 50));
+    }
+}
+
+// Per-tag lookups: the normalized tag tables against parsing problems.tags on
+// every call, for both the `list --tag` filter and the weakest-tag summary.
+void bench_tags(Database& db, const fs::path& db_path, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    int iters = opt.iters_or(opt.quick ? 20 : 50);
+    ProblemQuery q;
+    q.tag = "geometry";
+    q.limit = 100;
+    if (opt.selected("tag_filter")) {
+        report.add("tag_filter", time_listing([&] { return db.query_problems(q).rows; }, iters));
+    }
+    if (opt.selected("tag_filter_like")) {
+        // What a filter on the comma-separated column costs: a LIKE scan plus exact matching in memory
+        SQLite::Database raw(db_path.string(), SQLite::OPEN_READONLY);
+        SQLite::Statement scan(raw, "SELECT id, tags FROM problems WHERE tags LIKE '%geometry%' ORDER BY id");
+        std::vector<double> samples;
+        size_t rows = 0;
+        for (int i = 0; i < iters; ++i) {
+            rows = 0;
+            bench::Stopwatch sw;
+            while (scan.executeStep() && rows < 100) {
+                std::string tags = "," + scan.getColumn(1).getString() + ",";
+                rows += tags.find(",geometry,") != std::string::npos;
+            }
+            scan.reset();
+            samples.push_back(sw.elapsed_ms());
+        }
+        report.add("tag_filter_like", {{"iterations", iters}, {"rows", rows}, {"wall_ms", bench::summarize(samples)}});
+    }
+    if (opt.selected("tag_stats")) {
+        std::vector<double> samples;
+        size_t rows = 0;
+        for (int i = 0; i < iters; ++i) {
+            bench::Stopwatch sw;
+            rows = db.get_weakest_tags(3, 1).size();
+            samples.push_back(sw.elapsed_ms());
+        }
+        report.add("tag_stats", {{"iterations", iters}, {"rows", rows}, {"wall_ms", bench::summarize(samples)}});
+    }
+    if (opt.selected("tag_stats_scan")) {
+        // Same ranking from every summary, splitting tags in memory
+        std::vector<double> samples;
+        size_t rows = 0;
+        for (int i = 0; i < iters; ++i) {
+            bench::Stopwatch sw;
+            std::map<std::string, std::pair<int, int>> counts;  // attempted, solved
+            for (const auto& p : db.get_problem_summaries()) {
+                if (p.last_verdict.empty() || p.last_verdict == "SKIPPED") continue;
+                for (const auto& tag : utils::split(p.tags, ',')) {
+                    auto& c = counts[utils::trim(tag)];
+                    ++c.first;
+                    c.second += p.last_verdict == "AC";
+                }
+            }
+            std::vector<std::pair<double, std::string>> ranked;
+            for (const auto& [tag, c] : counts) ranked.emplace_back(double(c.second) / c.first, tag);
+            std::partial_sort(ranked.begin(), ranked.begin() + std::min<size_t>(3, ranked.size()), ranked.end());
+            samples.push_back(sw.elapsed_ms());
+            rows = std::min<size_t>(3, ranked.size());
+        }
+        report.add("tag_stats_scan", {{"iterations", iters}, {"rows", rows}, {"wall_ms", bench::summarize(samples)}});
+    }
+}
+
+// Cost of opening a Database: creating a new file, reopening an up-to-date one
+// (one user_version read), and replaying every migration step as startup did
+// before the schema was versioned.
+void bench_startup(const fs::path& dir, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    int iters = opt.iters_or(opt.quick ? 10 : 50);
+    fs::path path = dir / "startup.db";
+    std::vector<double> fresh, current, rerun;
+    for (int i = 0; i < iters; ++i) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        fs::remove(fs::path(path.string() + "-wal"), ec);
+        fs::remove(fs::path(path.string() + "-shm"), ec);
+        if (opt.selected("open_fresh")) {
+            bench::Stopwatch sw;
+            Database db(path.string());
+            fresh.push_back(sw.elapsed_ms());
+        } else {
+            Database db(path.string());
+        }
+        if (opt.selected("open_current")) {
+            bench::Stopwatch sw;
+            Database db(path.string());
+            current.push_back(sw.elapsed_ms());
+        }
+        if (opt.selected("open_rerun_migrations")) {
+            {
+                SQLite::Database raw(path.string(), SQLite::OPEN_READWRITE);
+                raw.exec("PRAGMA user_version = 0");
+            }
+            bench::Stopwatch sw;
+            Database db(path.string());
+            rerun.push_back(sw.elapsed_ms());
+        }
+    }
+    if (!fresh.empty()) report.add("open_fresh", {{"iterations", iters}, {"wall_ms", bench::summarize(fresh)}});
+    if (!current.empty()) report.add("open_current", {{"iterations", iters}, {"wall_ms", bench::summarize(current)}});
+    if (!rerun.empty()) report.add("open_rerun_migrations", {{"iterations", iters}, {"wall_ms", bench::summarize(rerun)}});
+}
+
+} // namespace
+
+// TUI loaders querying while the judge records results: the same read load
+// from several threads, through a one-connection pool and a four-connection one
+void bench_parallel_reads(const fs::path& db_path, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    const int threads = 4;
+    const int queries = opt.iters_or(opt.quick ? 20 : 100);
+    ProblemQuery q;
+    q.status = "failed";
+    q.difficulty = "hard";
+    q.limit = 50;
+    for (int pool : {1, 4}) {
+        std::string name = fmt::format("parallel_reads_pool{}", pool);
+        if (!opt.selected(name)) continue;
+        DbProfile profile;
+        profile.read_connections = pool;
+        Database db(db_path.string(), profile);
+        bench::Stopwatch sw;
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&] {
+                for (int i = 0; i < queries; ++i) {
+                    db.count_problems(q);
+                    db.query_problems(q);
+                }
+            });
+        }
+        std::thread writer([&] {
+            for (int i = 0; i < queries; ++i) db.update_problem_status(fmt::format("{}_{}", kSources[i % 5], i), "WA", 1, 2);
+        });
+        for (auto& r : readers) r.join();
+        writer.join();
+        double wall = sw.elapsed_ms();
+        report.add(name, {{"threads", threads}, {"read_connections", pool}, {"queries", threads * queries * 2},
+                          {"wall_ms", wall}, {"query_ms", wall / (threads * queries * 2)}});
+    }
+}
+
+// The same library opened with each DbProfile preset: full listing, pulling a
+// problem with its cases, and recording a test report
+void bench_profiles(const fs::path& db_path, int problem_count, const bench::BenchOptions& opt,
+                    bench::BenchReport& report) {
+    int iters = opt.iters_or(opt.quick ? 3 : 5);
+    int writes = opt.iters_or(opt.quick ? 50 : 200);
+    std::vector<TestCase> cases(10, TestCase{"5\n1 2 3 4 5\n", "15\n", true});
+    for (const auto& name : DbProfile::preset_names()) {
+        std::string scenario = "profile_" + name;
+        if (!opt.selected(scenario)) continue;
+        Database db(db_path.string(), DbProfile::preset(name));
+        std::vector<double> list, pull, record;
+        for (int i = 0; i < iters; ++i) {
+            bench::Stopwatch sw;
+            auto rows = db.get_problem_summaries();
+            list.push_back(sw.elapsed_ms());
+        }
+        for (int i = 0; i < writes; ++i) {
+            Problem p;
+            p.id = fmt::format("{}_pull_{}", name, i);
+            p.source = "codeforces";
+            p.title = p.id;
+            p.url = "https://example.com/pull/" + p.id;
+            p.description = "<p>statement</p>";
+            bench::Stopwatch sw;
+            db.add_problem_with_cases(p, cases);
+            pull.push_back(sw.elapsed_ms());
+        }
+        for (int i = 0; i < writes; ++i) {
+            Attempt a;
+            int n = (i * 7919) % problem_count;
+            a.problem_id = fmt::format("{}_{}", kSources[n % 5], n);
+            a.timestamp = 1800000000 + i;
+            a.verdict = i % 3 ? "WA" : "AC";
+            a.pass_count = 3;
+            a.total_count = 10;
+            bench::Stopwatch sw;
+            db.record_attempt(a);
+            record.push_back(sw.elapsed_ms());
+        }
+        const auto& eff = db.profile();
+        report.add(scenario, {{"problems", problem_count},
+                              {"cache_size_kb", eff.cache_size_kb},
+                              {"mmap_size", eff.mmap_size},
+                              {"temp_store_memory", eff.temp_store_memory},
+                              {"wal_autocheckpoint", eff.wal_autocheckpoint},
+                              {"list_ms", bench::summarize(list)},
+                              {"pull_ms", bench::summarize(pull)},
+                              {"record_ms", bench::summarize(record)}});
+    }
+}
+
+// UTF-8 validation: the scalar and dispatched (SSSE3 on x86-64) validators over
+// stored statements and over CJK text of the same size, then the one-time
+// migration that repairs the whole library when upgrading to schema 5
+void bench_utf8(const fs::path& db_path, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    const int iters = opt.iters_or(opt.quick ? 3 : 10);
+    if (opt.selected("utf8_validate")) {
+        std::string ascii;
+        {
+            Database db(db_path.string());
+            ProblemQuery q;
+            q.limit = 2000;
+            for (const auto& row : db.query_problems(q).rows) ascii += db.get_problem(row.id).description;
+        }
+        std::string cjk;
+        while (cjk.size() < ascii.size()) cjk += "<p>给定一个长度为 n 的整数序列，求其中和最大的连续子段，并输出该子段的和。</p>\n";
+        for (const auto& [corpus, text] : {std::pair<const char*, const std::string&>{"statements", ascii},
+                                           std::pair<const char*, const std::string&>{"cjk", cjk}}) {
+            nlohmann::json entry = {{"corpus", corpus}, {"bytes", text.size()}};
+            for (const auto& [impl, fn] : {std::pair<const char*, bool (*)(std::string_view)>{"scalar", utils::is_valid_utf8_scalar},
+                                           std::pair<const char*, bool (*)(std::string_view)>{"dispatch", utils::is_valid_utf8}}) {
+                std::vector<double> samples;
+                for (int i = 0; i < iters; ++i) {
+                    bench::Stopwatch sw;
+                    if (!fn(text)) throw std::runtime_error("fixture text is not valid UTF-8");
+                    samples.push_back(sw.elapsed_ms());
+                }
+                auto stats = bench::summarize(samples);
+                double median_ms = stats["median"].get<double>();
+                entry[impl] = {{"wall_ms", stats},
+                               {"mb_per_sec", median_ms > 0 ? text.size() / (1024.0 * 1024.0) * 1000.0 / median_ms : 0.0}};
+            }
+            report.add(fmt::format("utf8_validate_{}", corpus), std::move(entry));
+        }
+    }
+    if (opt.selected("utf8_upgrade")) {
+        {
+            SQLite::Database raw(db_path.string(), SQLite::OPEN_READWRITE);
+            raw.exec("PRAGMA user_version = 4");
+        }
+        bench::Stopwatch sw;
+        Database db(db_path.string());
+        report.add("utf8_upgrade", {{"problems", db.count_problems(ProblemQuery{})}, {"wall_ms", sw.elapsed_ms()}});
+    }
+}
+
+// Library churn: importing problems shaped like the fixture (cases, a review
+// and a mistake each), then deleting them again by TID, which has to remove
+// every dependent row: half one call per problem, half in one delete_problems
+void bench_churn(Database& db, const FixtureSpec& spec, const bench::BenchOptions& opt, bench::BenchReport& report) {
+    if (!opt.selected("bulk_insert") && !opt.selected("delete_cascade") && !opt.selected("delete_batch")) return;
+    const int count = opt.iters_or(opt.quick ? 200 : 1000);
+    std::vector<double> insert_ms, delete_ms;
+    std::vector<int> tids;
+    for (int i = 0; i < 2 * count; ++i) {
+        int n = spec.problems + i;
+        Problem p;
+        p.id = fmt::format("churn_{}", i);
+        p.source = "codeforces";
+        p.title = p.id;
+        p.url = "https://example.com/churn/" + p.id;
+        p.description = "<p>statement</p>";
+        p.tags = "dp,greedy";
+        p.created_at = 1700000000 + n;
+        std::vector<TestCase> cases;
+        for (int k = 0; k < spec.cases; ++k) cases.push_back(make_case(n, k));
+        ReviewItem r;
+        r.problem_id = p.id;
+        r.next_review = review_at(n);
+        bench::Stopwatch sw;
+        db.add_problem_with_cases(p, cases, r);
+        db.log_mistake(p.id, "WA", "churn");
+        insert_ms.push_back(sw.elapsed_ms());
+        tids.push_back(db.tid_for_problem_id(p.id));
+    }
+    if (opt.selected("bulk_insert")) {
+        report.add("bulk_insert", {{"problems", 2 * count}, {"cases_per_problem", spec.cases},
+                                   {"wall_ms", std::accumulate(insert_ms.begin(), insert_ms.end(), 0.0)},
+                                   {"problem_ms", bench::summarize(insert_ms)}});
+    }
+    // Always clean up so later runs of the suite see the same fixture
+    bench::Stopwatch single;
+    for (int i = 0; i < count; ++i) {
+        bench::Stopwatch sw;
+        db.delete_problem(tids[i]);
+        delete_ms.push_back(sw.elapsed_ms());
+    }
+    double single_ms = single.elapsed_ms();
+    bench::Stopwatch batch;
+    int deleted = db.delete_problems(std::vector<int>(tids.begin() + count, tids.end()));
+    double batch_ms = batch.elapsed_ms();
+    if (deleted != count || !db.get_test_cases("churn_0").empty() || db.get_review("churn_0").next_review != 0 ||
+        !db.get_test_cases(fmt::format("churn_{}", count)).empty())
+        throw std::runtime_error("delete_cascade: dependent rows left behind");
+    if (opt.selected("delete_cascade")) {
+        report.add("delete_cascade", {{"problems", count}, {"cases_per_problem", spec.cases}, {"wall_ms", single_ms},
+                                      {"problem_ms", bench::summarize(delete_ms)}});
+    }
+    if (opt.selected("delete_batch")) {
+        report.add("delete_batch", {{"problems", count}, {"cases_per_problem", spec.cases}, {"wall_ms", batch_ms},
+                                    {"problem_ms", batch_ms / count}});
+    }
+}
+
+int main(int argc, char** argv) {
+    auto opt = bench::parse_args(argc, argv);
+    bench::BenchReport report("db", opt);
+
+    FixtureSpec spec;
+    spec.problems = opt.problems_or(opt.quick ? 5000 : 50000);
+    spec.cases = opt.cases_or(opt.quick ? 3 : 5);
+    const int problem_count = spec.problems;
+    fs::path dir = fs::temp_directory_path() / "shuati_bench_db";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    fs::path db_path = dir / "shuati.db";
+
+    int rc = 0;
+    try {
+        bench_startup(dir, opt, report);
+        Database db(db_path.string());
+        bench::Stopwatch gen;
+        auto fixture = generate_library(db_path, spec);
+        fixture["generate_ms"] = gen.elapsed_ms();
+        fixture["db_bytes"] = fs::file_size(db_path);
+        report.add("fixture", std::move(fixture));
+
+        int iters = opt.iters_or(opt.quick ? 3 : 5);
+        if (opt.selected("list_full")) {
+            auto m = time_listing([&] { return db.get_all_problems(); }, iters);
+            m["problems"] = problem_count;
+            report.add("list_full", std::move(m));
+        }
+        if (opt.selected("list_summary")) {
+            auto m = time_listing([&] { return db.get_problem_summaries(); }, iters);
+            m["problems"] = problem_count;
+            report.add("list_summary", std::move(m));
+        }
+        if (opt.selected("get_problem")) {
+            // Lazy path: the picker loads one full problem after selection
+            std::vector<double> samples;
+            int lookups = opt.iters_or(opt.quick ? 200 : 1000);
+            for (int i = 0; i < lookups; ++i) {
+                int tid = 1 + (i * 7919) % problem_count;
+                bench::Stopwatch sw;
+                auto p = db.get_problem_by_display_id(tid);
+                samples.push_back(sw.elapsed_ms());
+                if (p.id.empty()) throw std::runtime_error("fixture row missing");
+            }
+            report.add("get_problem", {{"iterations", lookups}, {"wall_ms", bench::summarize(samples)}});
+        }
+        if (opt.selected("get_by_tid")) {
+            // `shuati show <tid>`: TID -> id through the map, then the problem and its cases
+            std::vector<double> samples;
+            int lookups = opt.iters_or(opt.quick ? 200 : 1000);
+            for (int i = 0; i < lookups; ++i) {
+                int tid = 1 + (i * 7919) % problem_count;
+                bench::Stopwatch sw;
+                auto id = db.problem_id_for_tid(tid);
+                auto p = db.get_problem(id);
+                auto cases = db.get_test_cases(id);
+                samples.push_back(sw.elapsed_ms());
+                if (p.id.empty() || static_cast<int>(cases.size()) < spec.cases)
+                    throw std::runtime_error(fmt::format("get_by_tid: fixture row {} incomplete", tid));
+            }
+            report.add("get_by_tid", {{"iterations", lookups}, {"wall_ms", bench::summarize(samples)}});
+        }
+        if (opt.selected("due_reviews")) {
+            std::vector<double> samples;
+            size_t rows = 0;
+            for (int i = 0; i < iters; ++i) {
+                bench::Stopwatch sw;
+                rows = db.get_due_reviews(kFixtureNow).size();
+                samples.push_back(sw.elapsed_ms());
+            }
+            report.add("due_reviews", {{"iterations", iters}, {"problems", problem_count}, {"rows", rows},
+                                       {"wall_ms", bench::summarize(samples)}});
+        }
+
+        // Filtered list: SQL window vs. loading every summary and filtering in memory
+        ProblemQuery filtered;
+        filtered.status = "failed";
+        filtered.difficulty = "hard";
+        filtered.source = "leetcode";
+        filtered.limit = 100;
+        if (opt.selected("filter_page")) {
+            auto m = time_listing([&] { return db.query_problems(filtered).rows; }, iters);
+            m["problems"] = problem_count;
+            report.add("filter_page", std::move(m));
+        }
+        if (opt.selected("filter_in_memory")) {
+            auto m = time_listing([&] {
+                auto all = db.get_problem_summaries();
+                std::vector<ProblemSummary> out;
+                for (auto& p : all) {
+                    if (p.difficulty != filtered.difficulty || p.source != filtered.source) continue;
+                    if (p.last_verdict.empty() || p.last_verdict == "AC" || p.last_verdict == "SKIPPED") continue;
+                    out.push_back(std::move(p));
+                    if (static_cast<int>(out.size()) == filtered.limit) break;
+                }
+                return out;
+            }, iters);
+            m["problems"] = problem_count;
+            report.add("filter_in_memory", std::move(m));
+        }
+        if (opt.selected("search_fts") || opt.selected("search_scan")) {
+            // Title term present in exactly one row: FTS index vs. a LIKE scan over every statement
+            int lookups = opt.iters_or(opt.quick ? 20 : 50);
+            SQLite::Database raw(db_path.string(), SQLite::OPEN_READONLY);
+            SQLite::Statement scan(raw,
+                "SELECT rowid FROM problems WHERE title LIKE ?1 OR tags LIKE ?1 OR description LIKE ?1 LIMIT 20");
+            std::vector<double> fts_ms, scan_ms;
+            for (int i = 0; i < lookups; ++i) {
+                std::string term = fmt::format("第{}题", (i * 7919) % problem_count);
+                if (opt.selected("search_fts")) {
+                    bench::Stopwatch sw;
+                    auto hits = db.search_problems(term, 20);
+                    fts_ms.push_back(sw.elapsed_ms());
+                    if (hits.empty()) throw std::runtime_error("search_fts: no hit for " + term);
+                }
+                if (opt.selected("search_scan")) {
+                    bench::Stopwatch sw;
+                    scan.bind(1, "%" + term + "%");
+                    while (scan.executeStep()) {}
+                    scan.reset();
+                    scan_ms.push_back(sw.elapsed_ms());
+                }
+            }
+            if (!fts_ms.empty()) {
+                report.add("search_fts", {{"iterations", lookups}, {"fulltext_index", db.has_fulltext_index()},
+                                          {"wall_ms", bench::summarize(fts_ms)}});
+            }
+            if (!scan_ms.empty()) {
+                report.add("search_scan", {{"iterations", lookups}, {"wall_ms", bench::summarize(scan_ms)}});
+            }
+        }
+        bench_statement_cache(db, db_path, problem_count, opt, report);
+        bench_import(db, opt, report);
+        bench_write_burst(db, opt, report);
+        bench_attempts(db, db_path, problem_count, opt, report);
+        bench_tags(db, db_path, opt, report);
+        if (opt.selected("keyset_scan")) {
+            // Walk the whole list one TUI window at a time
+            std::vector<double> samples;
+            int pages = 0;
+            for (int i = 0; i < iters; ++i) {
+                ProblemQuery q;
+                q.limit = 100;
+                pages = 0;
+                bench::Stopwatch sw;
+                while (true) {
+                    auto page = db.query_problems(q);
+                    ++pages;
+                    if (!page.next) break;
+                    q.after = page.next;
+                }
+                samples.push_back(sw.elapsed_ms() / pages);
+            }
+            report.add("keyset_scan", {{"iterations", iters}, {"pages", pages}, {"page_ms", bench::summarize(samples)}});
+        }
+        bench_parallel_reads(db_path, opt, report);
+        bench_profiles(db_path, problem_count, opt, report);
+        bench_utf8(db_path, opt, report);
+        if (opt.selected("status_counters") || opt.selected("status_full_scan")) {
+            // Dashboard numbers: trigger-maintained counters vs. loading every row
+            const long long now = kFixtureNow;
+            if (opt.selected("status_counters")) {
+                std::vector<double> samples;
+                for (int i = 0; i < iters; ++i) {
+                    bench::Stopwatch sw;
+                    auto stats = db.get_library_stats(now);
+                    samples.push_back(sw.elapsed_ms());
+                }
+                report.add("status_counters", {{"iterations", iters}, {"wall_ms", bench::summarize(samples)}});
+            }
+            if (opt.selected("status_full_scan")) {
+                std::vector<double> samples;
+                for (int i = 0; i < iters; ++i) {
+                    bench::Stopwatch sw;
+                    auto problems = db.get_problem_summaries();
+                    int ac = 0;
+                    for (const auto& p : problems) ac += p.last_verdict == "AC";
+                    auto due = db.get_due_reviews(now);
+                    samples.push_back(sw.elapsed_ms());
+                }
+                report.add("status_full_scan", {{"iterations", iters}, {"wall_ms", bench::summarize(samples)}});
+            }
+        }
+        bench_churn(db, spec, opt, report);
+    } catch (const std::exception& e) {
+        std::cerr << "[!] bench_db failed: " << e.what() << std::endl;
+        rc = 1;
+    }
+
+    fs::remove_all(dir, ec);
+    int out = report.finish();
+    return rc ? rc : out;
+}
@@ -0,0 +1,272 @@
+// bench_judge: throughput and overhead of the local judge.
+//
+// Workloads are compiled once with Judge::prepare and then run repeatedly
+// through Judge::run_prepared (full path: temp files + sandbox + comparator),
+// ISandbox::execute (sandbox only) and Judge::check_output (comparator only).
+// Results are printed as JSON; see bench_common.hpp for the command line.
+
+#include "bench_common.hpp"
+#include "shuati/judge.hpp"
+#include "shuati/sandbox.hpp"
+
+#include <filesystem>
+#include <map>
+
+using namespace shuati;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Workload {
+    std::string name;
+    std::string source;
+    std::string input;
+    std::string expected;
+    int time_limit_ms = 2000;
+    int memory_limit_kb = 256 * 1024;
+    int iterations = 20;
+};
+
+const char* kTrivialSrc = R"(
+#include <cstdio>
+int main() { long long a, b; if (scanf("%lld %lld", &a, &b) == 2) printf("%lld\n", a + b); return 0; }
+)";
+
+const char* kIoHeavySrc = R"(
+#include <cstdio>
+int main() {
+    int n; if (scanf("%d", &n) != 1) return 0;
+    long long sum = 0, x;
+    for (int i = 0; i < n; ++i) { if (scanf("%lld", &x) != 1) break; sum += x; }
+    printf("%lld\n", sum);
+    return 0;
+}
+)";
+
+const char* kBigOutputSrc = R"(
+#include <cstdio>
+int main() {
+    int n; if (scanf("%d", &n) != 1) return 0;
+    for (int i = 0; i < n; ++i) printf("%d\n", i);
+    return 0;
+}
+)";
+
+const char* kTleSrc = R"(
+int main() { volatile unsigned long long x = 0; for (;;) x = x + 1; }
+)";
+
+const char* kMleSrc = R"(
+#include <cstdlib>
+#include <cstring>
+int main() {
+    for (int i = 0; i < 64; ++i) {
+        char* p = static_cast<char*>(std::malloc(16 << 20));
+        if (!p) return 3;
+        std::memset(p, 1, 16 << 20);
+    }
+    return 0;
+}
+)";
+
+const char* status_name(sandbox::SandboxResultStatus s) {
+    switch (s) {
+        case sandbox::SandboxResultStatus::OK: return "OK";
+        case sandbox::SandboxResultStatus::TimeLimitExceeded: return "TimeLimitExceeded";
+        case sandbox::SandboxResultStatus::MemoryLimitExceeded: return "MemoryLimitExceeded";
+        case sandbox::SandboxResultStatus::OutputLimitExceeded: return "OutputLimitExceeded";
+        case sandbox::SandboxResultStatus::RuntimeError: return "RuntimeError";
+        case sandbox::SandboxResultStatus::InternalError: return "InternalError";
+    }
+    return "Unknown";
+}
+
+std::string numbers_input(int n) {
+    std::string s = std::to_string(n) + "\n";
+    s.reserve(n * 8);
+    for (int i = 0; i < n; ++i) {
+        s += std::to_string((i * 7919) % 1000003);
+        s += (i % 16 == 15) ? '\n' : ' ';
+    }
+    s += '\n';
+    return s;
+}
+
+std::string numbers_sum(int n) {
+    long long sum = 0;
+    for (int i = 0; i < n; ++i) sum += (i * 7919) % 1000003;
+    return std::to_string(sum) + "\n";
+}
+
+std::string sequence_output(int n) {
+    std::string s;
+    s.reserve(n * 7);
+    for (int i = 0; i < n; ++i) {
+        s += std::to_string(i);
+        s += '\n';
+    }
+    return s;
+}
+
+std::vector<Workload> make_workloads(const bench::BenchOptions& opt) {
+    int io_n = opt.quick ? 20000 : 500000;
+    int out_n = opt.quick ? 100000 : 2000000;
+    return {
+        {"trivial", kTrivialSrc, "1 2\n", "3\n", 2000, 256 * 1024, opt.quick ? 10 : 100},
+        {"io_heavy", kIoHeavySrc, numbers_input(io_n), numbers_sum(io_n), 5000, 256 * 1024, opt.quick ? 5 : 20},
+        {"big_output", kBigOutputSrc, std::to_string(out_n) + "\n", sequence_output(out_n), 5000, 256 * 1024, opt.quick ? 5 : 20},
+        {"tle_loop", kTleSrc, "", "", 200, 256 * 1024, opt.quick ? 3 : 10},
+        {"mle_alloc", kMleSrc, "", "", 2000, 64 * 1024, opt.quick ? 3 : 10},
+    };
+}
+
+// Full judge path: one run_prepared() per iteration
+nlohmann::json run_judge_workload(Judge& judge, const std::string& exe, const Workload& w, int iterations) {
+    TestCase tc{w.input, w.expected, false};
+    std::vector<double> wall, cpu;
+    std::map<std::string, int> verdicts;
+    bench::Stopwatch total;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch sw;
+        auto res = judge.run_prepared(exe, tc, w.time_limit_ms, w.memory_limit_kb);
+        wall.push_back(sw.elapsed_ms());
+        cpu.push_back(static_cast<double>(res.time_ms));
+        verdicts[res.verdict_str()]++;
+    }
+    double total_ms = total.elapsed_ms();
+
+    auto wall_stats = bench::summarize(wall);
+    auto cpu_stats = bench::summarize(cpu);
+    return {
+        {"kind", "judge"},
+        {"iterations", iterations},
+        {"input_bytes", w.input.size()},
+        {"expected_bytes", w.expected.size()},
+        {"time_limit_ms", w.time_limit_ms},
+        {"memory_limit_kb", w.memory_limit_kb},
+        {"cases_per_sec", total_ms > 0 ? iterations * 1000.0 / total_ms : 0.0},
+        {"wall_ms", wall_stats},
+        {"cpu_ms", cpu_stats},
+        // Wall time not accounted for by the solution itself: temp files, fork/exec, polling, comparison
+        {"overhead_ms_median", wall_stats["median"].get<double>() - cpu_stats["median"].get<double>()},
+        {"verdicts", verdicts},
+    };
+}
+
+// Sandbox only: pre-written input, no comparator, no temp file churn
+nlohmann::json run_sandbox_workload(const std::string& exe, const Workload& w, const fs::path& work, int iterations) {
+    auto in_path = work / (w.name + ".in");
+    auto out_path = work / (w.name + ".out");
+    auto err_path = work / (w.name + ".err");
+    { std::ofstream f(in_path, std::ios::binary); f << w.input; }
+
+    sandbox::SandboxLimits limits{w.time_limit_ms, w.memory_limit_kb / 1024};
+    std::vector<double> wall;
+    std::map<std::string, int> statuses;
+    bench::Stopwatch total;
+    for (int i = 0; i < iterations; ++i) {
+        auto sb = sandbox::create_sandbox();
+        bench::Stopwatch sw;
+        auto res = sb->execute(exe, {}, in_path.string(), out_path.string(), err_path.string(), limits);
+        wall.push_back(sw.elapsed_ms());
+        statuses[status_name(res.status)]++;
+    }
+    double total_ms = total.elapsed_ms();
+
+    return {
+        {"kind", "sandbox"},
+        {"iterations", iterations},
+        {"cases_per_sec", total_ms > 0 ? iterations * 1000.0 / total_ms : 0.0},
+        {"wall_ms", bench::summarize(wall)},
+        {"statuses", statuses},
+    };
+}
+
+// Comparator only: token-by-token check over a large output
+nlohmann::json run_comparator(Judge& judge, int tokens, int iterations) {
+    std::string expected = sequence_output(tokens);
+    std::string same = expected;
+    std::string tail_diff = expected;
+    tail_diff[tail_diff.size() - 2] = (tail_diff[tail_diff.size() - 2] == '0') ? '1' : '0';
+
+    std::vector<double> ac_ms, wa_ms;
+    int mismatches = 0;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch sw;
+        if (judge.check_output(same, expected) != Verdict::AC) mismatches++;
+        ac_ms.push_back(sw.elapsed_ms());
+
+        bench::Stopwatch sw2;
+        if (judge.check_output(tail_diff, expected) != Verdict::WA) mismatches++;
+        wa_ms.push_back(sw2.elapsed_ms());
+    }
+
+    auto ac_stats = bench::summarize(ac_ms);
+    double median_ms = ac_stats["median"].get<double>();
+    double mb = expected.size() / (1024.0 * 1024.0);
+    return {
+        {"kind", "comparator"},
+        {"iterations", iterations},
+        {"tokens", tokens},
+        {"bytes", expected.size()},
+        {"ac_ms", ac_stats},
+        {"wa_tail_ms", bench::summarize(wa_ms)},
+        {"mb_per_sec", median_ms > 0 ? mb * 1000.0 / median_ms : 0.0},
+        {"tokens_per_sec", median_ms > 0 ? tokens * 1000.0 / median_ms : 0.0},
+        {"unexpected_verdicts", mismatches},
+    };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto opt = bench::parse_args(argc, argv);
+    bench::BenchReport report("judge", opt);
+
+    fs::path work = fs::temp_directory_path() / "shuati_bench_judge";
+    fs::create_directories(work);
+
+    Judge judge;
+    int failures = 0;
+    for (const auto& w : make_workloads(opt)) {
+        bool want_judge = opt.selected(w.name);
+        bool want_sandbox = opt.selected("sandbox_" + w.name);
+        if (!want_judge && !want_sandbox) continue;
+
+        auto src = work / (w.name + ".cpp");
+        { std::ofstream f(src); f << w.source; }
+
+        std::string exe;
+        bench::Stopwatch compile_sw;
+        try {
+            exe = judge.prepare(src.string(), "cpp");
+        } catch (const std::exception& e) {
+            std::cerr << "[!] Failed to compile workload " << w.name << ": " << e.what() << std::endl;
+            failures++;
+            continue;
+        }
+        double compile_ms = compile_sw.elapsed_ms();
+
+        int iterations = opt.iters_or(w.iterations);
+        if (want_judge) {
+            auto metrics = run_judge_workload(judge, exe, w, iterations);
+            metrics["compile_ms"] = compile_ms;
+            report.add(w.name, std::move(metrics));
+        }
+        if (want_sandbox) {
+            report.add("sandbox_" + w.name, run_sandbox_workload(exe, w, work, iterations));
+        }
+        judge.cleanup_prepared(exe, "cpp");
+    }
+
+    if (opt.selected("comparator")) {
+        int tokens = opt.quick ? 100000 : 2000000;
+        report.add("comparator", run_comparator(judge, tokens, opt.iters_or(opt.quick ? 3 : 10)));
+    }
+
+    std::error_code ec;
+    fs::remove_all(work, ec);
+
+    int rc = report.finish();
+    return failures > 0 ? 1 : rc;
+}
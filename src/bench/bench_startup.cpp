@@ -0,0 +1,118 @@
+// bench_startup: wall time of one-shot CLI commands, from process start to exit.
+//
+// Runs the real `shuati` executable (path baked in by CMake, or $SHUATI_EXE)
+// inside a throwaway project seeded with synthetic problems. Output is piped,
+// so the child's stdout is fully buffered: exit time is an upper bound on the
+// time to first output. Results are printed as JSON; see bench_common.hpp.
+//
+// No before/after numbers for the lazy Services construction have been
+// recorded: so far the harness has only been run against a stub executable.
+// Treat any startup gain from that change as unmeasured until it is run
+// against a real build.
+
+#include "bench_common.hpp"
+#include "shuati/config.hpp"
+#include "shuati/database.hpp"
+
+#include <cstdio>
+#include <filesystem>
+
+#ifndef SHUATI_EXE
+#define SHUATI_EXE "shuati"
+#endif
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+using namespace shuati;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Runs `exe args`, discarding its output; returns the exit status
+int run(const std::string& exe, const std::string& args) {
+    std::string cmd = "\"" + exe + "\" " + args + " 2>&1";
+#ifdef _WIN32
+    cmd = "\"" + cmd + "\"";  // cmd.exe strips one level of quotes
+#endif
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) return -1;
+    char buf[4096];
+    while (std::fread(buf, 1, sizeof(buf), pipe) > 0) {}
+    return pclose(pipe);
+}
+
+void seed_problems(const fs::path& db_path, int count) {
+    Database db(db_path.string());
+    const char* sources[] = {"codeforces", "luogu", "leetcode"};
+    for (int i = 0; i < count; ++i) {
+        Problem p;
+        p.source = sources[i % 3];
+        p.id = fmt::format("{}_{}", p.source, i);
+        p.title = fmt::format("Synthetic problem {}", i);
+        p.url = fmt::format("https://example.com/{}/{}", p.source, i);
+        p.description = "<p>Given an array of n integers, find the longest increasing subsequence.</p>";
+        p.tags = "dp";
+        p.difficulty = "medium";
+        p.created_at = 1700000000 + i;
+        db.add_problem(p);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto opt = bench::parse_args(argc, argv);
+    bench::BenchReport report("startup", opt);
+
+    const char* env_exe = std::getenv("SHUATI_EXE");
+    std::string exe = fs::absolute(env_exe ? env_exe : SHUATI_EXE).string();
+    fs::path dir = fs::temp_directory_path() / "shuati_bench_startup";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    fs::path prev_cwd = fs::current_path();
+    fs::current_path(dir);
+
+    const std::vector<std::pair<std::string, std::string>> commands = {
+        {"version", "--version"},
+        {"info", "info"},
+        {"list", "list"},
+        {"list_page", "list --page 1"},
+        {"status", "status"},
+        {"search", "search subsequence"},
+    };
+
+    int rc = 0;
+    try {
+        if (run(exe, "init") != 0 || !fs::exists(Config::db_path(dir))) {
+            throw std::runtime_error("'" + exe + " init' failed");
+        }
+        seed_problems(Config::db_path(dir), opt.problems_or(opt.quick ? 200 : 2000));
+
+        int iters = opt.iters_or(opt.quick ? 5 : 20);
+        for (const auto& [name, args] : commands) {
+            if (!opt.selected(name)) continue;
+            run(exe, args);  // Warm the page cache
+            std::vector<double> samples;
+            int status = 0;
+            for (int i = 0; i < iters; ++i) {
+                bench::Stopwatch sw;
+                status = run(exe, args);
+                samples.push_back(sw.elapsed_ms());
+            }
+            report.add(name, {{"args", args}, {"iterations", iters}, {"exit_status", status},
+                              {"wall_ms", bench::summarize(samples)}});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[!] bench_startup failed: " << e.what() << std::endl;
+        rc = 1;
+    }
+
+    fs::current_path(prev_cwd);
+    fs::remove_all(dir, ec);
+    int out = report.finish();
+    return rc ? rc : out;
+}
@@ -26,10 +26,10 @@ void run_legacy_repl() {
 
     // Load global service for completion context
     auto root = Config::find_root();
-    std::unique_ptr<cmd::Services> global_svc;
+    std::shared_ptr<cmd::Services> global_svc;
     if (!root.empty()) {
         try {
-            global_svc = std::make_unique<cmd::Services>(cmd::Services::load(root));
+            global_svc = cmd::Services::session(root);
             if (global_svc->companion) global_svc->companion->start();
         } catch (...) {}
     }
@@ -37,7 +37,7 @@ void run_legacy_repl() {
     // Set up completion
     rx.set_completion_callback([&](std::string const& input, int& contextLen) {
         std::vector<Replxx::Completion> completions;
-        std::vector<std::string> cmds = {"init", "info", "pull", "new", "solve", "list", "delete", "record", "test", "hint", "config", "login", "repl", "exit", "view"};
+        std::vector<std::string> cmds = {"init", "info", "pull", "new", "solve", "list", "search", "delete", "record", "test", "hint", "config", "login", "repl", "exit", "view"};
         
         // Command completion
         size_t last_space = input.rfind(' ');
@@ -51,7 +51,7 @@ void run_legacy_repl() {
             
             if (cmd == "solve" || cmd == "delete" || cmd == "record" || cmd == "hint" || cmd == "test" || cmd == "view") {
                 if (global_svc && global_svc->pm) {
-                    auto problems = global_svc->pm->list_problems();
+                    auto problems = global_svc->pm->list_problem_summaries();
                     for (const auto& p : problems) {
                         std::string label = std::to_string(p.display_id);
                         // Match against ID or Title
@@ -146,7 +146,7 @@ void run_legacy_repl() {
                     auto new_root = Config::find_root();
                     if (!new_root.empty() && global_svc) {
                         try {
-                            *global_svc = cmd::Services::load(new_root);
+                            global_svc = cmd::Services::session(new_root);
                             fmt::print(fg(fmt::color::cyan), "[*] 已重新加载项目上下文\n");
                         } catch (...) {}
                     }
@@ -192,6 +192,7 @@ void run_legacy_repl() {
              fmt::print("{:<10} {:<35} {}\n", "new", "创建本地题目", "new <title>");
              fmt::print("{:<10} {:<35} {}\n", "solve", "开始做题 (支持交互选择)", "solve [id]");
              fmt::print("{:<10} {:<35} {}\n", "list", "列出所有题目", "list");
+             fmt::print("{:<10} {:<35} {}\n", "search", "全文搜索题目", "search <关键词>");
              fmt::print("{:<10} {:<35} {}\n", "view", "查看测试详情", "view <id>");
              fmt::print("{:<10} {:<35} {}\n", "delete", "删除题目", "delete <id>");
              fmt::print("{:<10} {:<35} {}\n", "record", "提交记录与心得", "record <id>");
@@ -201,6 +202,7 @@ void run_legacy_repl() {
              fmt::print("{:<10} {:<40} {}\n", "", "  设置编辑器", "config --editor <cmd|auto>");
              fmt::print("{:<10} {:<40} {}\n", "", "  自动启动 REPL 开关", "config --autostart-repl <on|off>");
              fmt::print("{:<10} {:<40} {}\n", "", "  启动 UI 模式", "config --ui-mode <tui|legacy>");
+             fmt::print("{:<10} {:<40} {}\n", "", "  数据库性能配置", "config --db-profile <laptop|server>");
              fmt::print("{:<10} {:<35} {}\n", "login", "配置平台登录 Cookie", "login lanqiao");
              fmt::print("{:<10} {:<35} {}\n", "repl", "手动进入交互模式", "repl");
              fmt::print("{:<10} {:<35} {}\n", "tui", "进入全屏 TUI", "tui");
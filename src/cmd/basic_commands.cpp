@@ -5,6 +5,8 @@
 #include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <ctime>
 
 namespace shuati {
 namespace cmd {
@@ -44,9 +46,8 @@ void cmd_init(CommandContext& ctx) {
             out << j.dump(4);
         }
 
-        // Database initialisation
+        // Database initialisation (the constructor creates and migrates the schema)
         Database db((shuati_dir / "shuati.db").string());
-        db.init_schema();
 
         std::cout << "[+] 初始化成功!" << std::endl;
         std::cout << "    位置: " << shuati_dir.string() << std::endl;
@@ -67,9 +68,17 @@ void cmd_info(CommandContext& ctx) {
     if (!root.empty()) {
         std::cout << "Project Root: " << root.string() << std::endl;
         try {
-            auto svc = Services::load(root);
+            auto svc_ptr = Services::session(root);
+            auto& svc = *svc_ptr;
             std::cout << "Language: " << svc.cfg.language << std::endl;
             std::cout << "Editor: " << svc.cfg.editor << std::endl;
+            const auto& db = svc.db->profile();
+            std::cout << "Database Profile: " << db.name << std::endl;
+            std::cout << fmt::format("  cache_size={} KiB, mmap_size={} MiB, temp_store={}, "
+                                     "wal_autocheckpoint={}, busy_timeout={} ms, read_connections={}",
+                                     db.cache_size_kb, db.mmap_size >> 20, db.temp_store_memory ? "memory" : "file",
+                                     db.wal_autocheckpoint, db.busy_timeout_ms, db.read_connections)
+                      << std::endl;
         } catch (...) {
             std::cout << "Config: (Error loading)" << std::endl;
         }
@@ -144,9 +153,20 @@ void cmd_config(CommandContext& ctx) {
                 std::cerr << "[!] --ui-mode 的值必须是 'tui' 或 'legacy'" << std::endl;
             }
         }
+        if (!ctx.cfg_db_profile.empty()) {
+            try {
+                DbProfile::preset(ctx.cfg_db_profile);
+                cfg.db_profile = ctx.cfg_db_profile;
+                changed = true;
+                std::cout << "[+] 数据库性能配置已设置为: " << ctx.cfg_db_profile << std::endl;
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "[!] " << e.what() << std::endl;
+            }
+        }
 
         if (changed) {
             cfg.save(cfg_path);
+            Services::reset_session();
             std::cout << "[+] 配置已保存。" << std::endl;
         } else {
             std::cout << "未指定任何更改。使用 --show 查看当前配置。" << std::endl;
@@ -158,6 +178,7 @@ void cmd_config(CommandContext& ctx) {
             std::cout << "  --editor <cmd|auto>   设置编辑器命令 (auto=自动检测)\n";
             std::cout << "  --autostart-repl <on|off> 是否在无参数时自动启动 REPL\n";
             std::cout << "  --ui-mode <tui|legacy> 启动 UI 模式\n";
+            std::cout << "  --db-profile <laptop|server> 数据库性能配置\n";
         }
 
     } catch (const std::exception& e) {
@@ -239,6 +260,7 @@ void cmd_login(CommandContext& ctx) {
             auto cfg = Config::load(cfg_path);
             cfg.lanqiao_cookie = cookie;
             cfg.save(cfg_path);
+            Services::reset_session();
 
             std::cout << "\n[+] Cookie 已保存！\n";
             std::cout << "    现在可以使用 'shuati pull <蓝桥题目URL>' 抓取完整题目了。\n\n";
@@ -257,28 +279,29 @@ void cmd_status(CommandContext& ctx) {
     (void)ctx;
     try {
         auto root = find_root_or_die();
-        auto svc = Services::load(root);
+        auto svc_ptr = Services::session(root);
+        auto& svc = *svc_ptr;
 
-        auto problems = svc.pm->list_problems();
+        long long now = std::time(nullptr);
+        auto stats = svc.db->get_library_stats(now);
         auto profile = svc.db->get_user_profile();
-        auto reviews = svc.db->get_due_reviews(std::time(nullptr));
         auto mistakes = svc.db->get_mistake_stats();
         auto mastery = svc.db->get_all_mastery();
 
-        int total = (int)problems.size();
-        int ac_count = 0, failed_count = 0, unaudited_count = 0;
-        int easy = 0, medium = 0, hard = 0;
-        for (const auto& p : problems) {
-            if (p.difficulty == "easy") easy++;
-            else if (p.difficulty == "medium") medium++;
-            else if (p.difficulty == "hard") hard++;
-            if (p.last_verdict == "AC") ac_count++;
-            else if (p.last_verdict.empty() || p.last_verdict == "SKIPPED") unaudited_count++;
-            else failed_count++;
-        }
+        int total = stats.total;
+        int ac_count = stats.verdict("AC");
+        int unaudited_count = stats.verdict("") + stats.verdict("SKIPPED");
+        int failed_count = total - ac_count - unaudited_count;
+        auto difficulty = [&](const char* d) {
+            auto it = stats.by_difficulty.find(d);
+            return it == stats.by_difficulty.end() ? 0 : it->second;
+        };
+        int easy = difficulty("easy"), medium = difficulty("medium"), hard = difficulty("hard");
 
         double ac_rate = total > 0 ? (100.0 * ac_count / total) : 0.0;
-        int review_due = (int)reviews.size();
+        int review_due = stats.due_reviews;
+        int review_week = 0;
+        for (const auto& [day, count] : stats.upcoming_reviews) review_week += count;
         int total_mastery = (int)mastery.size();
         int high_mastery = 0;
         for (const auto& m : mastery) if (m.confidence > 70.0) high_mastery++;
@@ -295,9 +318,50 @@ void cmd_status(CommandContext& ctx) {
         std::cout << "  ──────────────────────────\n";
         std::cout << "  难度: 简单 " << easy << "  |  中等 " << medium << "  |  困难 " << hard << "\n";
         std::cout << "  ──────────────────────────\n";
-        std::cout << "  📅 待复习   " << review_due << " 题\n";
+        std::cout << "  📅 待复习   " << review_due << " 题 (未来 7 天 " << review_week << " 题)\n";
         std::cout << "  📊 ELO      " << profile.elo_rating << "\n";
         std::cout << "  🏆 掌握技能 " << high_mastery << "/" << total_mastery << "\n";
+        // Attempt history, served from the rollup tables
+        long long since = now - 3 * 7 * 86400;
+        auto weeks = svc.db->get_weekly_attempts(since);
+        if (!weeks.empty()) {
+            std::cout << "  ──────────────────────────\n";
+            std::cout << "  近 4 周提交 (提交 / AC / 新通过):\n";
+            for (const auto& w : weeks) {
+                std::time_t t = static_cast<std::time_t>(w.week_start);
+                char buf[16];
+                std::strftime(buf, sizeof(buf), "%m-%d", std::gmtime(&t));
+                std::cout << fmt::format("    {} 起  {:>3} / {:>3} / {:>3}  ({:.0f}%)\n",
+                    buf, w.attempts, w.accepted, w.solved, w.solve_rate() * 100);
+            }
+            auto tags = svc.db->get_tag_attempts(since);
+            if (!tags.empty()) {
+                std::cout << "  标签通过率 (Top 5):\n";
+                for (size_t i = 0; i < tags.size() && i < 5; ++i) {
+                    std::cout << fmt::format("    · {}: {:.0f}% ({}/{})\n", tags[i].tag,
+                        tags[i].solve_rate() * 100, tags[i].accepted, tags[i].attempts);
+                }
+            }
+            auto solves = svc.db->get_recent_solves(20);
+            if (!solves.empty()) {
+                std::vector<long long> spans;
+                double tries = 0;
+                for (const auto& s : solves) { spans.push_back(s.time_to_ac()); tries += s.attempts_to_ac; }
+                std::nth_element(spans.begin(), spans.begin() + spans.size() / 2, spans.end());
+                std::cout << fmt::format("  ⏱ 最近 {} 题首次 AC: 中位用时 {:.1f} 小时, 平均 {:.1f} 次提交\n",
+                    solves.size(), spans[spans.size() / 2] / 3600.0, tries / solves.size());
+            }
+        }
+        // Whole-library solve rate per tag, kept current by the tag tables
+        auto weak_tags = svc.db->get_weakest_tags(3);
+        if (!weak_tags.empty()) {
+            std::cout << "  ──────────────────────────\n";
+            std::cout << "  薄弱标签 (按题目最后结果):\n";
+            for (const auto& t : weak_tags) {
+                std::cout << fmt::format("    · {}: {:.0f}% ({}/{})\n", t.tag,
+                    t.solve_rate() * 100, t.solved, t.attempted);
+            }
+        }
         if (!mistakes.empty()) {
             std::cout << "  ──────────────────────────\n";
             std::cout << "  常见错误类型 (Top 3):\n";
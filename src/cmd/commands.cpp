@@ -35,10 +35,18 @@ void setup_commands(CLI::App& app, CommandContext& ctx) {
     list_cmd->add_option("-f,--filter", ctx.list_filter, "过滤状态: all, ac, failed, unaudited, review");
     list_cmd->add_option("-d,--difficulty", ctx.list_difficulty, "过滤难度: easy, medium, hard");
     list_cmd->add_option("-s,--source", ctx.list_source, "过滤来源: all, leetcode, codeforces, luogu, lanqiao, local");
+    list_cmd->add_option("-t,--tag", ctx.list_tag, "只显示带有该标签的题目");
+    list_cmd->add_option("-p,--page", ctx.list_page, "只显示第 N 页 (从 1 开始)");
+    list_cmd->add_option("--page-size", ctx.list_page_size, "每页题目数 (默认 50)");
     list_cmd->callback([&](){ cmd_list(ctx); });
 
+    auto search_cmd = app.add_subcommand("search", "全文搜索题目 (标题、标签、题面)");
+    search_cmd->add_option("query", ctx.search_terms, "关键词 (多个关键词需同时命中)")->required();
+    search_cmd->add_option("-n,--limit", ctx.search_limit, "最多显示条数 (默认 20)");
+    search_cmd->callback([&](){ cmd_search(ctx); });
+
     auto del = app.add_subcommand("delete", "删除题目");
-    del->add_option("id", ctx.solve_pid, "题目 ID 或 TID");
+    del->add_option("ids", ctx.delete_ids, "题目 ID 或 TID (可一次删除多道)");
     del->add_flag("--confirm", ctx.delete_confirm, "确认删除 (TUI 模式下必需)");
     del->callback([&](){ cmd_delete(ctx); });
 
@@ -51,6 +59,10 @@ void setup_commands(CLI::App& app, CommandContext& ctx) {
     tst->add_option("id", ctx.solve_pid, "题目 ID")->required();
     tst->add_option("--max", ctx.test_max_cases, "最大用例数");
     tst->add_option("--oracle", ctx.test_oracle, "Oracle 模式");
+    tst->add_flag("--rerun", ctx.test_rerun, "忽略结果缓存, 重新运行全部用例");
+    tst->add_flag("--timings", ctx.test_timings, "输出编译/用例准备/评测各阶段耗时");
+    tst->add_option("--repeat", ctx.test_repeat, "临近时限的用例重复运行 K 次, 按中位数判定");
+    tst->add_option("--band", ctx.test_band, "临近时限的判定区间 (占时限比例, 默认 0.2)");
     // tst->add_flag("--ui", ctx.test_ui, "交互模式 (暂不可用)"); 
     tst->callback([&](){ cmd_test(ctx); });
 
@@ -68,6 +80,22 @@ void setup_commands(CLI::App& app, CommandContext& ctx) {
 
     app.add_subcommand("clean", "清理临时文件")->callback([&](){ cmd_clean(ctx); });
 
+    auto db_cmd = app.add_subcommand("db", "数据库管理");
+    db_cmd->require_subcommand(1);
+    auto maintain = db_cmd->add_subcommand("maintain", "维护数据库: 更新查询统计、回收空闲空间、截断 WAL");
+    maintain->add_flag("--full", ctx.db_full, "对所有表执行 ANALYZE，必要时 VACUUM 整个文件");
+    maintain->add_option("--budget", ctx.db_budget_ms, "空间回收的时间预算 (毫秒, 默认不限)");
+    maintain->callback([&](){ cmd_db_maintain(ctx); });
+
+    auto exp = app.add_subcommand("export", "导出整个题库 (题目、测试点、复习与提交记录) 到归档文件");
+    exp->add_option("file", ctx.archive_path, "归档路径, 以 .gz 结尾时压缩")->required();
+    exp->callback([&](){ cmd_export(ctx); });
+
+    auto imp = app.add_subcommand("import", "从归档文件导入题库");
+    imp->add_option("file", ctx.archive_path, "归档路径")->required();
+    imp->add_option("--on-conflict", ctx.import_conflict, "题目已存在时: skip (保留本地), replace (以归档为准), fail (中止)");
+    imp->callback([&](){ cmd_import(ctx); });
+
     auto uninst = app.add_subcommand("uninstall", "清除所有记录与本地项目文件夹");
     uninst->add_flag("--confirm", ctx.uninstall_confirm, "确认清除");
     uninst->callback([&](){ cmd_uninstall(ctx); });
@@ -84,6 +112,7 @@ void setup_commands(CLI::App& app, CommandContext& ctx) {
     cfg->add_option("--editor", ctx.cfg_editor, "设置编辑器命令 (auto=自动检测 vim/nvim/nano等)");
     cfg->add_option("--autostart-repl", ctx.cfg_autostart_repl, "无参数时自动启动 REPL: on/off");
     cfg->add_option("--ui-mode", ctx.cfg_ui_mode, "UI 模式: tui/legacy");
+    cfg->add_option("--db-profile", ctx.cfg_db_profile, "数据库性能配置: laptop/server");
     cfg->callback([&](){ cmd_config(ctx); });
 
     // repl: explicitly launch REPL (useful when autostart_repl=false)
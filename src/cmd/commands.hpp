@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <optional>
 #include <functional>
+#include <mutex>
+#include <atomic>
 #include <CLI/CLI.hpp>
 #include <fmt/color.h>
 
@@ -35,17 +37,32 @@ struct CommandContext {
     std::string cfg_editor;          // --editor flag for config command
     std::string cfg_autostart_repl;  // "on" or "off" for --autostart-repl
     std::string cfg_ui_mode;         // "tui" or "legacy" for --ui-mode
+    std::string cfg_db_profile;      // DbProfile preset for --db-profile
     bool cfg_show = false;
     int test_max_cases = 30;
     std::string test_oracle = "auto";
     bool test_ui = false;
+    bool test_rerun = false;         // --rerun: ignore the judge result cache
+    bool test_timings = false;       // --timings: print per-stage pipeline timeline
+    int test_repeat = 1;             // --repeat K: re-run borderline cases K times
+    double test_band = 0.2;          // --band: borderline = within band * limit of the limit
     std::string list_filter; // "all", "ac", "failed", "unaudited", "review"
     std::string list_difficulty; // "easy", "medium", "hard"
     std::string list_source;  // "all", "leetcode", "codeforces", "luogu", "lanqiao", "local"
+    std::string list_tag;     // Exact tag name, e.g. "dp"
+    int list_page = 0;            // --page N (1-based); 0 = list everything
+    int list_page_size = 50;      // --page-size
+    std::vector<std::string> search_terms; // search <query...>
+    int search_limit = 20;
     std::string view_export_dir; // Directory to save test cases
     std::string login_platform;  // Platform for login command (e.g., "lanqiao")
     bool uninstall_confirm = false; // Flag for uninstall/clean-all
     bool delete_confirm = false;     // Flag for TUI delete confirmation
+    std::vector<std::string> delete_ids; // delete <id...>
+    bool db_full = false;            // db maintain --full
+    int db_budget_ms = 0;            // db maintain --budget (0 = no limit)
+    std::string archive_path;        // export/import <file>
+    std::string import_conflict = "skip"; // import --on-conflict: skip, replace, fail
     std::function<void(const std::string&)> stream_cb; // Callback for streaming outputs
     // Set to true when command is dispatched from the TUI - suppresses stdin reads,
     // FTXUI interactive menus, and editor launch to avoid TUI corruption.
@@ -53,17 +70,81 @@ struct CommandContext {
 };
 
 
+// A Services member that is built on first access. The factory runs once even
+// when several threads (TUI workers, the Companion server) get there together;
+// if it throws, the next access tries again.
+template <typename T>
+class LazyService {
+public:
+    explicit LazyService(std::function<std::shared_ptr<T>()> make) : make_(std::move(make)) {}
+    LazyService(const LazyService&) = delete;
+    LazyService& operator=(const LazyService&) = delete;
+
+    const std::shared_ptr<T>& shared() const {
+        std::call_once(once_, [this] { ptr_ = make_(); built_ = true; });
+        return ptr_;
+    }
+    // True once the factory has succeeded; never builds the service itself
+    bool built() const { return built_; }
+    T* get() const { return shared().get(); }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return get() != nullptr; }
+
+private:
+    std::function<std::shared_ptr<T>()> make_;
+    mutable std::once_flag once_;
+    mutable std::shared_ptr<T> ptr_;
+    mutable std::atomic<bool> built_{false};
+};
+
+// Only the config is read up front; everything else is constructed when a
+// command first touches it, so `list` never builds crawlers or the AI coach.
+// How much start-up time this saves has not been measured (see bench_startup).
+// Members are declared in dependency order (and destroyed in reverse).
 struct Services {
-    std::shared_ptr<Database>       db;
-    std::shared_ptr<ProblemManager> pm;
-    std::shared_ptr<MistakeAnalyzer> ma;
-    std::unique_ptr<MemoryManager>  mm;
-    std::unique_ptr<AICoach>        ai;
-    std::unique_ptr<CompanionServer> companion;
-    std::unique_ptr<Judge>          judge;
-    Config                          cfg;
-
-    static Services load(const std::filesystem::path& root, bool skip_doctor = false);
+    Config                           cfg;
+    LazyService<Database>            db;
+    LazyService<ProblemManager>      pm;
+    LazyService<MistakeAnalyzer>     ma;
+    LazyService<MemoryManager>       mm;
+    LazyService<AICoach>             ai;
+    LazyService<CompanionServer>     companion;
+    LazyService<Judge>               judge;   // Runs the compiler environment check if a caller wanted it
+
+    // `cfg` is the already loaded config.json of `root`; `reuse_db` hands over an
+    // already open Database instead of opening a second one (with its own writer
+    // thread) on the same file
+    Services(const std::filesystem::path& root, Config cfg, bool skip_doctor = false,
+             std::shared_ptr<Database> reuse_db = nullptr);
+    Services(const Services&) = delete;
+    Services& operator=(const Services&) = delete;
+
+    // New, unshared instance
+    static std::shared_ptr<Services> load(const std::filesystem::path& root, bool skip_doctor = false);
+
+    // Process-wide instance for `root`, built on first use and shared by every
+    // command (TUI actions, REPL lines). Rebuilt when the root changes or
+    // config.json is rewritten; holders keep their instance alive meanwhile.
+    // A rebuild keeps the open Database unless the db_* settings changed; if
+    // they did, old holders still use the old connection until they let go, so
+    // two Database objects can briefly write to one file (SQLite's locking keeps
+    // that safe, just slower). skip_doctor applies per call: any caller that
+    // does not skip it gets the environment check, at most once per instance.
+    static std::shared_ptr<Services> session(const std::filesystem::path& root, bool skip_doctor = false);
+    // Drops the cached instance so the next session() call reloads the config
+    static void reset_session();
+
+    // Asks for the compiler environment check: runs it now if the Judge already
+    // exists, otherwise when the Judge is first built
+    void want_doctor();
+
+private:
+    void run_doctor();
+    std::mutex doctor_mtx_;          // Orders want_doctor() against the Judge factory
+    bool doctor_wanted_ = false;
+    bool judge_built_ = false;
+    std::once_flag doctor_once_;
 };
 
 #include "shuati/utils/project_utils.hpp"
@@ -94,6 +175,7 @@ std::string find_solution_file(const Problem& prob, const std::string& language)
 
 void cmd_test(CommandContext& ctx);
 void cmd_list(CommandContext& ctx);
+void cmd_search(CommandContext& ctx);
 void cmd_init(CommandContext& ctx);
 void cmd_info(CommandContext& ctx);
 void cmd_status(CommandContext& ctx);
@@ -106,6 +188,9 @@ void cmd_record(CommandContext& ctx);
 void cmd_hint(CommandContext& ctx);
 void cmd_clean(CommandContext& ctx);
 void cmd_uninstall(CommandContext& ctx);
+void cmd_db_maintain(CommandContext& ctx);
+void cmd_export(CommandContext& ctx);
+void cmd_import(CommandContext& ctx);
 void cmd_view(CommandContext& ctx);
 void cmd_login(CommandContext& ctx);
 
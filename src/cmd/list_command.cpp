@@ -6,6 +6,7 @@
 #include <thread>
 #include <future>
 #include <chrono>
+#include <algorithm>
 
 #include "shuati/database.hpp"
 #include "shuati/problem_manager.hpp"
@@ -32,22 +33,31 @@ std::string link(const std::string& text, const std::string& url) {
 
 void cmd_list(CommandContext& ctx) {
     try {
-        auto svc = Services::load(find_root_or_die());
-        auto problems = svc.pm->list_problems();
-        if (problems.empty()) {
-            std::cout << "题库为空。" << std::endl;
-            return;
+        auto svc_ptr = Services::session(find_root_or_die());
+        auto& svc = *svc_ptr;
+
+        // Filtering and paging are evaluated in SQL; only the requested window is loaded
+        ProblemQuery query;
+        query.status = ctx.list_filter.empty() ? "all" : ctx.list_filter;
+        query.difficulty = ctx.list_difficulty.empty() ? "all" : ctx.list_difficulty;
+        query.source = ctx.list_source.empty() ? "all" : ctx.list_source;
+        query.tag = ctx.list_tag;
+
+        int page_size = std::max(1, ctx.list_page_size);
+        if (ctx.list_page > 0) {
+            query.limit = page_size;
+            query.offset = (ctx.list_page - 1) * page_size;
         }
-
-        // Filtering
-        std::string status_filter = ctx.list_filter.empty() ? "all" : ctx.list_filter;
-        std::string diff_filter = ctx.list_difficulty.empty() ? "all" : ctx.list_difficulty;
-        std::string source_filter = ctx.list_source.empty() ? "all" : ctx.list_source;
-        
-        problems = svc.pm->filter_problems(problems, status_filter, diff_filter, source_filter);
+        auto problems = svc.pm->query_problems(query).rows;
 
         if (problems.empty()) {
-            std::cout << "没有符合条件的题目。" << std::endl;
+            if (ctx.list_page > 1) {
+                std::cout << "第 " << ctx.list_page << " 页没有题目。" << std::endl;
+            } else if (svc.pm->count_problems(ProblemQuery{}) == 0) {
+                std::cout << "题库为空。" << std::endl;
+            } else {
+                std::cout << "没有符合条件的题目。" << std::endl;
+            }
             return;
         }
 
@@ -120,6 +130,56 @@ void cmd_list(CommandContext& ctx) {
                       << pad_string(time_str, 15)
                       << std::endl;
         }
+
+        if (ctx.list_page > 0) {
+            int total = svc.pm->count_problems(query);
+            int pages = (total + page_size - 1) / page_size;
+            std::cout << std::string(105, '-') << std::endl;
+            std::cout << "第 " << ctx.list_page << "/" << pages << " 页，共 " << total
+                      << " 题 (--page N 翻页)" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[!] 错误: " << e.what() << std::endl;
+    }
+}
+
+void cmd_search(CommandContext& ctx) {
+    try {
+        std::string query;
+        for (const auto& t : ctx.search_terms) query += (query.empty() ? "" : " ") + t;
+        if (query.empty()) {
+            std::cerr << "[!] 请输入搜索关键词" << std::endl;
+            return;
+        }
+
+        auto svc_ptr = Services::session(find_root_or_die());
+        auto& svc = *svc_ptr;
+        auto hits = svc.db->search_problems(query, ctx.search_limit);
+        if (hits.empty()) {
+            std::cout << "没有找到与 \"" << query << "\" 相关的题目。" << std::endl;
+            return;
+        }
+
+        std::cout << pad_string("TID", 6)
+                  << pad_string("标题", 30)
+                  << pad_string("难度", 8)
+                  << pad_string("来源", 10)
+                  << "标签" << std::endl;
+        std::cout << std::string(80, '-') << std::endl;
+        for (const auto& hit : hits) {
+            const auto& p = hit.problem;
+            std::cout << pad_string(std::to_string(p.display_id), 6)
+                      << pad_string(shorten_utf8_lossy(p.title, 29), 30)
+                      << pad_string(ensure_utf8(p.difficulty), 8)
+                      << pad_string(canonical_source(p.source), 10)
+                      << shorten_utf8_lossy(p.tags, 24) << std::endl;
+            if (!hit.snippet.empty()) {
+                std::cout << "      " << hit.snippet << std::endl;
+            }
+        }
+        std::cout << std::string(80, '-') << std::endl;
+        std::cout << "共 " << hits.size() << " 条结果"
+                  << (svc.db->has_fulltext_index() ? "" : " (全文索引不可用，使用子串匹配)") << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "[!] 错误: " << e.what() << std::endl;
     }
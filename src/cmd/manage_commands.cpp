@@ -1,6 +1,8 @@
 #include "commands.hpp"
 #include "shuati/boot_guard.hpp"
+#include "shuati/library_archive.hpp"
 #include "shuati/utils/encoding.hpp"
+#include "shuati/utils/string_utils.hpp"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -17,7 +19,8 @@ namespace fs = std::filesystem;
 
 void cmd_pull(CommandContext& ctx) {
     try {
-        auto svc = Services::load(find_root_or_die());
+        auto svc_ptr = Services::session(find_root_or_die());
+        auto& svc = *svc_ptr;
         std::cout << "[*] 正在拉取题目: " << ctx.pull_url << std::endl;
         svc.pm->pull_problem(ctx.pull_url);
         std::cout << "[+] 拉取完成。" << std::endl;
@@ -29,7 +32,8 @@ void cmd_pull(CommandContext& ctx) {
 void cmd_new(CommandContext& ctx) {
     try {
         auto root = find_root_or_die();
-        auto svc = Services::load(root);
+        auto svc_ptr = Services::session(root);
+        auto& svc = *svc_ptr;
         std::string pid = svc.pm->create_local(ctx.new_title, ctx.new_tags, ctx.new_diff);
         
         // Create directory structure
@@ -52,28 +56,33 @@ void cmd_new(CommandContext& ctx) {
 
 void cmd_delete(CommandContext& ctx) {
     try {
-        auto svc = Services::load(find_root_or_die());
+        auto svc_ptr = Services::session(find_root_or_die());
+        auto& svc = *svc_ptr;
         
-        if (ctx.solve_pid.empty()) {
+        if (ctx.delete_ids.empty()) {
             if (ctx.is_tui) {
-                std::cout << "[用法] /delete <ID> — 请直接提供题目 ID" << std::endl;
+                std::cout << "[用法] /delete <ID...> — 请直接提供题目 ID" << std::endl;
                 return;
             }
             std::cout << "请输入要删除的题目 ID: ";
-            std::cin >> ctx.solve_pid;
-            if (ctx.solve_pid.empty()) return;
+            std::string id;
+            std::cin >> id;
+            if (id.empty()) return;
+            ctx.delete_ids.push_back(id);
         }
+        std::string id_list = utils::join(ctx.delete_ids, " ");
 
         // Confirm deletion
         if (ctx.is_tui) {
             // TUI mode: require --confirm flag since stdin is unavailable
             if (!ctx.delete_confirm) {
                 std::cout << "[!] 安全提醒: 删除操作不可恢复。" << std::endl;
-                std::cout << "    请使用 /delete " << ctx.solve_pid << " --confirm 确认删除。" << std::endl;
+                std::cout << "    请使用 /delete " << id_list << " --confirm 确认删除。" << std::endl;
                 return;
             }
         } else {
-            std::cout << "确定要删除题目 '" << ctx.solve_pid << "' 吗? [y/N] ";
+            if (ctx.delete_ids.size() == 1) std::cout << "确定要删除题目 '" << id_list << "' 吗? [y/N] ";
+            else std::cout << "确定要删除这 " << ctx.delete_ids.size() << " 道题目 (" << id_list << ") 吗? [y/N] ";
             char confirm; std::cin >> confirm;
             if (confirm != 'y' && confirm != 'Y') {
                 std::cout << "操作取消。" << std::endl;
@@ -81,12 +90,17 @@ void cmd_delete(CommandContext& ctx) {
             }
         }
 
-        auto prob = svc.pm->get_problem(ctx.solve_pid);
-        if (prob.id.empty()) {
-            std::cerr << "[!] 未找到题目: " << ctx.solve_pid << std::endl;
-            return;
+        std::vector<int> tids;
+        for (const auto& id : ctx.delete_ids) {
+            auto prob = svc.pm->get_problem(id);
+            if (prob.id.empty()) {
+                std::cerr << "[!] 未找到题目: " << id << std::endl;
+                continue;
+            }
+            tids.push_back(prob.display_id);
         }
-        svc.pm->delete_problem(prob.id);
+        if (tids.empty()) return;
+        svc.pm->delete_problems(tids);
         std::cout << "[+] 题目已删除。" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "[!] Error: " << e.what() << std::endl;
@@ -178,6 +192,82 @@ void cmd_clean(CommandContext& ctx) {
     }
 }
 
+void cmd_db_maintain(CommandContext& ctx) {
+    try {
+        auto root = find_root_or_die();
+        auto svc_ptr = Services::session(root, true);
+        auto& svc = *svc_ptr;
+        if (ctx.db_full) std::cout << "[*] 正在执行完整维护 (可能需要一些时间)..." << std::endl;
+        auto r = svc.db->maintain(std::chrono::milliseconds(ctx.db_budget_ms), ctx.db_full);
+        if (r.converted) std::cout << "[+] 已将数据库转换为增量回收模式 (auto_vacuum=INCREMENTAL)。" << std::endl;
+        std::cout << fmt::format("[+] 维护完成: 回收 {:.1f} KB ({:.1f} KB -> {:.1f} KB)，释放 {} 个空闲页，用时 {:.0f} ms。",
+                                 r.reclaimed_bytes() / 1024.0, r.bytes_before / 1024.0, r.bytes_after / 1024.0,
+                                 r.pages_vacuumed, r.elapsed_ms)
+                  << std::endl;
+        if (r.free_pages_left > 0)
+            std::cout << "    仍有 " << r.free_pages_left << " 个空闲页，"
+                      << (ctx.db_budget_ms > 0 ? "再次运行以继续回收。" : "运行 'shuati db maintain --full' 以回收。")
+                      << std::endl;
+        if (!r.wal_truncated)
+            std::cout << "    WAL 正被其他进程读取，未能截断；稍后重试。" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "[!] Error: " << e.what() << std::endl;
+    }
+}
+
+namespace {
+
+// Single-line progress: "\r[*] 12000 行 (8500 行/s)"
+LibraryArchive::Progress archive_progress(const char* verb) {
+    return [verb](long long rows, double elapsed_ms) {
+        double rate = elapsed_ms > 0 ? rows * 1000.0 / elapsed_ms : 0.0;
+        std::cout << fmt::format("\r[*] 已{} {} 行 ({:.0f} 行/s)", verb, rows, rate) << std::flush;
+    };
+}
+
+std::string describe(const ArchiveCounts& c) {
+    return fmt::format("{} 道题目, {} 个测试点, {} 条复习, {} 条错题, {} 次提交, {} 条记忆",
+                       c.problems, c.test_cases, c.reviews, c.mistakes, c.attempts, c.memory);
+}
+
+} // namespace
+
+void cmd_export(CommandContext& ctx) {
+    try {
+        auto root = find_root_or_die();
+        auto svc_ptr = Services::session(root, true);
+        auto& svc = *svc_ptr;
+        auto start = std::chrono::steady_clock::now();
+        auto counts = LibraryArchive::export_to(*svc.db, ctx.archive_path, archive_progress("导出"));
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\n[+] 导出完成: " << describe(counts) << fmt::format("，用时 {:.1f} s。", secs) << std::endl;
+        std::cout << "    文件: " << fs::absolute(ctx.archive_path).string()
+                  << fmt::format(" ({:.1f} KB)", fs::file_size(ctx.archive_path) / 1024.0) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "\n[!] 导出失败: " << e.what() << std::endl;
+    }
+}
+
+void cmd_import(CommandContext& ctx) {
+    try {
+        auto policy = LibraryArchive::parse_policy(ctx.import_conflict);
+        if (!policy) throw std::runtime_error("未知的冲突策略: " + ctx.import_conflict);
+        auto root = find_root_or_die();
+        auto svc_ptr = Services::session(root, true);
+        auto& svc = *svc_ptr;
+        auto start = std::chrono::steady_clock::now();
+        auto counts = LibraryArchive::import_from(*svc.db, ctx.archive_path, *policy, archive_progress("处理"));
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\n[+] 导入完成: " << describe(counts) << fmt::format("，用时 {:.1f} s。", secs) << std::endl;
+        if (counts.skipped > 0)
+            std::cout << "    跳过 " << counts.skipped << " 行 (本地已存在)，使用 --on-conflict replace 以归档为准。" << std::endl;
+        if (counts.rekeyed > 0)
+            std::cout << "    " << counts.rekeyed << " 道本地题目链接相同但编号不同，已由归档中的题目替换。" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "\n[!] 导入失败: " << e.what() << std::endl;
+    }
+}
+
 void cmd_uninstall(CommandContext& ctx) {
     auto history = BootGuard::load_history();
     std::vector<fs::path> to_delete;
@@ -8,6 +8,7 @@
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include <iostream>
+#include <mutex>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -35,32 +36,78 @@ std::string executable_path_utf8() {
 }
 #endif
 
-Services Services::load(const fs::path& root, bool skip_doctor) {
-    Services s;
+static Config load_config_or_report(const fs::path& root) {
     try {
-        s.cfg = Config::load(Config::config_path(root));
-        auto db = std::make_shared<Database>(Config::db_path(root).string());
-        s.db = db;
-        s.pm  = std::make_shared<ProblemManager>(s.db);
-        
-        // Register crawlers
-        s.pm->register_crawler(std::make_unique<LeetCodeCrawler>());
-        s.pm->register_crawler(std::make_unique<CodeforcesCrawler>());
-        s.pm->register_crawler(std::make_unique<LuoguCrawler>());
-        s.pm->register_crawler(std::make_unique<LanqiaoCrawler>(nullptr, s.cfg.lanqiao_cookie));
-        
-        s.ma  = std::make_shared<MistakeAnalyzer>(s.db);
-        s.mm  = std::make_unique<MemoryManager>(*s.db); // Database& constructor
-        s.ai  = std::make_unique<AICoach>(s.cfg, s.mm.get());
-        s.companion = std::make_unique<CompanionServer>(*s.pm, *s.db);
-        s.judge = std::make_unique<Judge>();
+        return Config::load(Config::config_path(root));
     } catch (const std::exception& e) {
         fmt::print(fg(fmt::color::red), "[!] 服务加载失败: {}\n", e.what());
         throw;
     }
+}
+
+// Preset named by cfg.db_profile with the config's per-setting overrides applied
+static DbProfile db_profile_from(const Config& cfg) {
+    DbProfile p;
+    try {
+        p = DbProfile::preset(cfg.db_profile);
+    } catch (const std::invalid_argument& e) {
+        fmt::print(fg(fmt::color::yellow), "[!] {}，使用默认配置 laptop\n", e.what());
+    }
+    if (cfg.db_cache_size_kb) p.cache_size_kb = *cfg.db_cache_size_kb;
+    if (cfg.db_mmap_size) p.mmap_size = *cfg.db_mmap_size;
+    if (cfg.db_temp_store) p.temp_store_memory = *cfg.db_temp_store == "memory";
+    if (cfg.db_wal_autocheckpoint) p.wal_autocheckpoint = *cfg.db_wal_autocheckpoint;
+    if (cfg.db_busy_timeout_ms) p.busy_timeout_ms = *cfg.db_busy_timeout_ms;
+    return p;
+}
+
+Services::Services(const fs::path& root, Config config, bool skip_doctor, std::shared_ptr<Database> reuse_db)
+    : cfg(std::move(config)),
+      db([this, root, reuse_db] {
+          if (reuse_db) return reuse_db;
+          return std::make_shared<Database>(Config::db_path(root).string(), db_profile_from(cfg));
+      }),
+      pm([this] {
+          auto pm = std::make_shared<ProblemManager>(db.shared());
+          // Register crawlers
+          pm->register_crawler(std::make_unique<LeetCodeCrawler>());
+          pm->register_crawler(std::make_unique<CodeforcesCrawler>());
+          pm->register_crawler(std::make_unique<LuoguCrawler>());
+          pm->register_crawler(std::make_unique<LanqiaoCrawler>(nullptr, cfg.lanqiao_cookie));
+          return pm;
+      }),
+      ma([this] { return std::make_shared<MistakeAnalyzer>(db.shared()); }),
+      mm([this] { return std::make_shared<MemoryManager>(*db); }),
+      ai([this] { return std::make_shared<AICoach>(cfg, mm.get()); }),
+      companion([this] { return std::make_shared<CompanionServer>(*pm, *db); }),
+      judge([this] {
+          auto judge = std::make_shared<Judge>();
+          // The environment check is slow, so it only runs for commands that
+          // compile code, and only if some caller of this instance asked for it.
+          bool wanted;
+          {
+              std::lock_guard<std::mutex> lock(doctor_mtx_);
+              judge_built_ = true;
+              wanted = doctor_wanted_;
+          }
+          if (wanted) run_doctor();
+          return judge;
+      }) {
+    if (!skip_doctor) want_doctor();
+}
 
-    // Environment Check (skip if requested, since it can be very slow)
-    if (!skip_doctor) {
+void Services::want_doctor() {
+    bool built;
+    {
+        std::lock_guard<std::mutex> lock(doctor_mtx_);
+        doctor_wanted_ = true;
+        built = judge_built_;
+    }
+    if (built) run_doctor();
+}
+
+void Services::run_doctor() {
+    std::call_once(doctor_once_, [] {
         std::vector<std::string> missing;
         if (!CompilerDoctor::check_environment(missing)) {
              fmt::print(fg(fmt::color::yellow), "[!] 警告: 未检测到以下环境工具，可能无法运行代码:\n");
@@ -69,12 +116,74 @@ Services Services::load(const fs::path& root, bool skip_doctor) {
              }
              fmt::print("\n");
         }
-    }
-    
-    return s;
+    });
+}
+
+std::shared_ptr<Services> Services::load(const fs::path& root, bool skip_doctor) {
+    return std::make_shared<Services>(root, load_config_or_report(root), skip_doctor);
 }
 
 
+namespace {
+
+struct SessionSlot {
+    std::mutex mtx;
+    fs::path root;
+    fs::file_time_type config_mtime;
+    std::shared_ptr<Services> services;
+};
+
+SessionSlot& session_slot() {
+    static SessionSlot slot;
+    return slot;
+}
+
+fs::file_time_type config_mtime(const fs::path& root) {
+    std::error_code ec;
+    auto t = fs::last_write_time(Config::config_path(root), ec);
+    return ec ? fs::file_time_type::min() : t;
+}
+
+// Whether two configs open the database with the same settings
+bool same_db_settings(const Config& a, const Config& b) {
+    return a.db_profile == b.db_profile &&
+           a.db_cache_size_kb == b.db_cache_size_kb &&
+           a.db_mmap_size == b.db_mmap_size &&
+           a.db_temp_store == b.db_temp_store &&
+           a.db_wal_autocheckpoint == b.db_wal_autocheckpoint &&
+           a.db_busy_timeout_ms == b.db_busy_timeout_ms;
+}
+
+} // namespace
+
+std::shared_ptr<Services> Services::session(const fs::path& root, bool skip_doctor) {
+    auto& slot = session_slot();
+    // Held while loading so concurrent TUI workers wait for one build instead of racing
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    auto mtime = config_mtime(root);
+    if (slot.services && slot.root == root && slot.config_mtime == mtime) {
+        if (!skip_doctor) slot.services->want_doctor();
+        return slot.services;
+    }
+    auto cfg = load_config_or_report(root);
+    // Only the config changed: keep the open Database (and its writer thread)
+    // rather than opening a second one on the same file
+    std::shared_ptr<Database> reuse_db;
+    if (slot.services && slot.root == root && slot.services->db.built() &&
+        same_db_settings(slot.services->cfg, cfg)) {
+        reuse_db = slot.services->db.shared();
+    }
+    slot.services = std::make_shared<Services>(root, std::move(cfg), skip_doctor, std::move(reuse_db));
+    slot.root = root;
+    slot.config_mtime = mtime;
+    return slot.services;
+}
+
+void Services::reset_session() {
+    auto& slot = session_slot();
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    slot.services.reset();
+}
 
 std::string make_solution_filename(const Problem& prob, const std::string& language) {
     std::string ext = (language == "python" || language == "py") ? ".py" : ".cpp";
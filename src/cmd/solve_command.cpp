@@ -20,7 +20,8 @@ namespace fs = std::filesystem;
 void cmd_solve(CommandContext& ctx) {
     try {
         auto root = find_root_or_die();
-        auto svc = Services::load(root);
+        auto svc_ptr = Services::session(root);
+        auto& svc = *svc_ptr;
 
         Problem prob;
         if (ctx.solve_pid.empty()) {
@@ -30,7 +31,7 @@ void cmd_solve(CommandContext& ctx) {
                 return;
             }
 
-            auto problems = svc.pm->list_problems();
+            auto problems = svc.pm->list_problem_summaries();
             if (problems.empty()) {
                 std::cout << "Problem set is empty. Use pull or new first." << std::endl;
                 return;
@@ -81,7 +82,8 @@ void cmd_solve(CommandContext& ctx) {
                     std::cout << "Cancelled." << std::endl;
                     return;
                 }
-                prob = problems[selected];
+                // Picker rows are summaries; load the full problem (with description) once chosen
+                prob = svc.pm->get_problem(std::to_string(problems[selected].display_id));
 
             } catch (...) {
                 std::cout << "Input problem ID: ";
@@ -132,7 +134,8 @@ void cmd_solve(CommandContext& ctx) {
 void cmd_record(CommandContext& ctx) {
     try {
         auto root = find_root_or_die();
-        auto svc = Services::load(root);
+        auto svc_ptr = Services::session(root);
+        auto& svc = *svc_ptr;
         auto prob = svc.pm->get_problem(ctx.record_pid);
 
         if (prob.id.empty()) {
@@ -207,7 +210,8 @@ void cmd_record(CommandContext& ctx) {
 
 void cmd_hint(CommandContext& ctx) {
     try {
-        auto svc = Services::load(find_root_or_die());
+        auto svc_ptr = Services::session(find_root_or_die());
+        auto& svc = *svc_ptr;
         auto prob = svc.pm->get_problem(ctx.hint_pid);
         if (prob.id.empty()) {
             if (ctx.stream_cb) ctx.stream_cb("[!] Problem not found.\n");
@@ -264,7 +268,7 @@ void cmd_hint(CommandContext& ctx) {
 
         svc.ai->analyze(desc, code, [&filter](std::string chunk) {
             filter.feed(chunk);
-        });
+        }, prob.tags);
 
         filter.flush();
         if (!ctx.stream_cb) std::cout << "\n\n";
@@ -29,18 +29,12 @@ namespace {
             r.verdict = j.value("verdict", "");
             r.pass_count = j.value("pass_count", 0);
             r.total_count = j.value("total_count", 0);
+            r.cached_count = j.value("cached_count", 0);
             
             if (j.contains("cases")) {
                 for (const auto& cj : j["cases"]) {
                     JudgeResult jr;
-                    std::string v = cj.value("verdict", "");
-                    if (v == "AC") jr.verdict = Verdict::AC;
-                    else if (v == "WA") jr.verdict = Verdict::WA;
-                    else if (v == "TLE") jr.verdict = Verdict::TLE;
-                    else if (v == "MLE") jr.verdict = Verdict::MLE;
-                    else if (v == "RE") jr.verdict = Verdict::RE;
-                    else if (v == "CE") jr.verdict = Verdict::CE;
-                    else jr.verdict = Verdict::SE;
+                    jr.verdict = verdict_from_string(cj.value("verdict", ""));
 
                     jr.time_ms = cj.value("time_ms", 0);
                     jr.memory_kb = cj.value("memory_kb", 0);
@@ -48,6 +42,15 @@ namespace {
                     jr.input = cj.value("input", "");
                     jr.output = cj.value("output", "");
                     jr.expected = cj.value("expected", "");
+                    jr.cached = cj.value("cached", false);
+                    if (cj.contains("timing")) {
+                        const auto& t = cj["timing"];
+                        jr.timing.runs = t.value("runs", 1);
+                        jr.timing.min_ms = t.value("min_ms", 0);
+                        jr.timing.median_ms = t.value("median_ms", 0);
+                        jr.timing.max_ms = t.value("max_ms", 0);
+                        jr.timing.cv = t.value("cv", 0.0);
+                    }
                     r.cases.push_back(jr);
                 }
             }
@@ -61,7 +64,8 @@ namespace {
 void cmd_view(CommandContext& ctx) {
     try {
         auto root = find_root_or_die();
-        auto svc = Services::load(root);
+        auto svc_ptr = Services::session(root);
+        auto& svc = *svc_ptr;
         auto prob = svc.pm->get_problem(ctx.solve_pid);
 
         if (prob.id.empty()) { std::cerr << "[!] 题目不存在。" << std::endl; return; }
@@ -103,6 +107,23 @@ void cmd_view(CommandContext& ctx) {
         std::cout << "=== 测试报告: " << ensure_utf8(prob.title).c_str() << " ===" << std::endl;
         std::cout << "Verdict: " << report.verdict.c_str() << std::endl;
         std::cout << "Passed:  " << report.pass_count << "/" << report.total_count << std::endl;
+        if (report.cached_count > 0) {
+            std::cout << "Cached:  " << report.cached_count << "/" << report.total_count << std::endl;
+        }
+        if (auto stats = svc.db->get_attempt_stats(prob.id)) {
+            std::cout << "History: " << stats->attempts << " 次提交, " << stats->accepted << " 次 AC";
+            if (stats->first_ac_at > 0) {
+                std::cout << fmt::format(", 第 {} 次首次通过 (用时 {:.1f} 小时), 最快 {}ms",
+                    stats->attempts_to_ac, stats->time_to_ac() / 3600.0, stats->best_time_ms);
+            }
+            std::cout << std::endl;
+            auto trend = svc.db->get_attempt_trend(prob.id, 10);
+            if (trend.size() > 1) {
+                std::cout << "Trend:  ";
+                for (const auto& pt : trend) std::cout << " " << pt.verdict << "/" << pt.max_time_ms << "ms";
+                std::cout << std::endl;
+            }
+        }
         std::cout << std::endl;
 
         for (size_t i = 0; i < report.cases.size(); ++i) {
@@ -116,6 +137,11 @@ void cmd_view(CommandContext& ctx) {
 
             std::cout << "Case #" << (i+1) << ": ";
             std::cout << v << " (" << c.time_ms << "ms, " << c.memory_kb << "KB)";
+            if (c.cached) std::cout << " [cached]";
+            if (c.timing.runs > 1) {
+                std::cout << fmt::format(" [x{} min/med/max {}/{}/{}ms, CV {:.1f}%]",
+                    c.timing.runs, c.timing.min_ms, c.timing.median_ms, c.timing.max_ms, c.timing.cv * 100);
+            }
             if (c.verdict != Verdict::AC) {
                  std::cout << std::endl;
                  std::cout << "  Input:    " << (c.input.substr(0, 100) + (c.input.size()>100?"...":"")) << std::endl;
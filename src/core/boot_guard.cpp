@@ -212,7 +212,6 @@ bool BootGuard::check(int argc) {
             Config cfg;
             cfg.save(Config::config_path(fs::current_path()));
             Database db(Config::db_path(fs::current_path()).string());
-            db.init_schema();
             
             fmt::print(fg(fmt::color::green), "[+] 初始化成功: {}\n", dir.string());
             record_history(fs::current_path().string());
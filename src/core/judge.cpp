@@ -12,6 +12,8 @@
 #include <cstdlib>
 #include <random>
 #include <cctype>
+#include <cmath>
+#include <algorithm>
 #include "shuati/utils/encoding.hpp"
 
 
@@ -59,7 +61,7 @@ public:
     TempFile(const std::string& extension = ".tmp") {
         auto tmp = fs::temp_directory_path();
         
-        static std::mt19937 rng(std::random_device{}());
+        thread_local std::mt19937 rng(std::random_device{}());
         std::uniform_int_distribution<long long> dist(0, 1000000000);
         
         auto now = std::chrono::system_clock::now().time_since_epoch().count();
@@ -83,12 +85,29 @@ private:
     fs::path path_;
 };
 
-static std::string read_text_file(const std::string& path) {
+// Never pull more than this much of a solution's stderr into memory
+static constexpr size_t kMaxErrorOutputBytes = 64 * 1024;
+
+// Reads at most max_bytes (0 = whole file); a truncated read gets a trailing marker
+static std::string read_text_file(const std::string& path, size_t max_bytes = 0) {
     std::ifstream in(shuati::utils::utf8_path(path), std::ios::in | std::ios::binary);
     if (!in) return "";
-    std::ostringstream ss;
-    ss << in.rdbuf();
-    return ss.str();
+    if (max_bytes == 0) {
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+    // Size by what is on disk, so a short stdout does not pay for the whole cap
+    std::error_code ec;
+    auto on_disk = fs::file_size(shuati::utils::utf8_path(path), ec);
+    size_t want = ec ? max_bytes : static_cast<size_t>(std::min<uintmax_t>(on_disk, max_bytes));
+    std::string buf(want, '\0');
+    in.read(buf.data(), static_cast<std::streamsize>(want));
+    buf.resize(static_cast<size_t>(in.gcount()));
+    if (in && in.peek() != std::char_traits<char>::eof()) {
+        buf += "\n... [truncated]";
+    }
+    return buf;
 }
 
 
@@ -110,6 +129,80 @@ void Judge::cleanup_prepared(const std::string& executable, const std::string& l
     }
 }
 
+bool Judge::near_time_limit(const JudgeResult& res, int time_limit_ms, double band) {
+    if (time_limit_ms <= 0) return false;
+    if (res.verdict != Verdict::AC && res.verdict != Verdict::TLE) return false;
+    return res.time_ms >= time_limit_ms * (1.0 - band);
+}
+
+JudgeResult Judge::run_prepared_repeated(const std::string& executable,
+                                         const TestCase& tc,
+                                         int time_limit_ms,
+                                         int memory_limit_kb,
+                                         const RepeatPolicy& policy) {
+    JudgeResult first = run_case(executable, tc, time_limit_ms, memory_limit_kb);
+    if (policy.repeats <= 1 || !near_time_limit(first, time_limit_ms, policy.band)) {
+        return first;
+    }
+
+    // Re-runs get headroom past the limit so slow runs report their real time
+    // instead of being cut off at exactly the limit.
+    int hard_limit_ms = static_cast<int>(time_limit_ms * (1.0 + policy.band)) + 1;
+    std::vector<JudgeResult> runs;
+    runs.reserve(policy.repeats);
+    for (int i = 0; i < policy.repeats; ++i) {
+        runs.push_back(run_case(executable, tc, hard_limit_ms, memory_limit_kb));
+        // Only AC vs. TLE is decided by the median. WA/RE/MLE/OLE in any run
+        // is not timing noise: it fails the case as reported
+        const auto& r = runs.back();
+        if (r.verdict != Verdict::AC && r.verdict != Verdict::TLE) return r;
+    }
+
+    std::vector<int> times;
+    for (const auto& r : runs) times.push_back(r.time_ms);
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+
+    TimingStats stats;
+    stats.runs = static_cast<int>(n);
+    stats.min_ms = times.front();
+    stats.max_ms = times.back();
+    stats.median_ms = (n % 2 == 1) ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+    double mean = 0;
+    for (int t : times) mean += t;
+    mean /= n;
+    double var = 0;
+    for (int t : times) var += (t - mean) * (t - mean);
+    stats.cv = mean > 0 ? std::sqrt(var / n) / mean : 0.0;
+
+    bool median_tle = stats.median_ms > time_limit_ms;
+
+    // Representative run: closest to the median among runs with the decided
+    // verdict (every run is AC or TLE here), or among all of them if none is
+    const Verdict decided = median_tle ? Verdict::TLE : Verdict::AC;
+    auto closest = [&](bool match_verdict) {
+        const JudgeResult* best = nullptr;
+        for (const auto& r : runs) {
+            if (match_verdict && r.verdict != decided) continue;
+            if (!best || std::abs(r.time_ms - stats.median_ms) < std::abs(best->time_ms - stats.median_ms)) {
+                best = &r;
+            }
+        }
+        return best;
+    };
+    const JudgeResult* rep = closest(true);
+    JudgeResult res = rep ? *rep : *closest(false);
+    res.time_ms = stats.median_ms;
+    res.timing = stats;
+    if (median_tle) {
+        res.verdict = Verdict::TLE;
+        res.output.clear();
+        res.message = fmt::format("Median time {}ms over {} runs exceeds limit {}ms",
+                                  stats.median_ms, stats.runs, time_limit_ms);
+    }
+    return res;
+}
+
 std::string Judge::compile(const std::string& source_file, const std::string& language) {
     if (language == "python" || language == "py") {
         // For sandbox compatibility, return a marker.
@@ -268,6 +361,7 @@ JudgeResult Judge::run_case(const std::string& executable,
     shuati::sandbox::SandboxLimits limits;
     limits.cpu_time_ms = time_limit_ms;
     limits.memory_mb = memory_limit_kb / 1024;
+    limits.output_limit_bytes = output_limit_bytes_;
 
     std::vector<std::string> args;
     std::string executable_program = executable;
@@ -313,9 +407,13 @@ JudgeResult Judge::run_case(const std::string& executable,
         res.verdict = Verdict::TLE;
     } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::MemoryLimitExceeded) {
         res.verdict = Verdict::MLE;
+    } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::OutputLimitExceeded) {
+        res.verdict = Verdict::OLE;
+        res.message = fmt::format("Output limit exceeded (> {} KB)", limits.output_limit_bytes / 1024);
     } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::RuntimeError) {
         res.verdict = Verdict::RE;
-        res.error_output = shuati::utils::ensure_utf8_lossy(shuati::read_text_file(err_file.path()));
+        res.error_output = shuati::utils::ensure_utf8_lossy(
+            shuati::read_text_file(err_file.path(), kMaxErrorOutputBytes));
         if (res.error_output.empty()) {
             res.error_output = fmt::format("Process exited with code {}", sb_res.exit_code);
         }
@@ -333,7 +431,8 @@ JudgeResult Judge::run_case(const std::string& executable,
         res.error_output = "Sandbox Internal Error: " + sb_res.internal_message;
     } else {
         // OK
-        res.output = shuati::utils::ensure_utf8_lossy(shuati::read_text_file(out_file.path()));
+        res.output = shuati::utils::ensure_utf8_lossy(
+            shuati::read_text_file(out_file.path(), static_cast<size_t>(limits.output_limit_bytes)));
         res.verdict = check_output(res.output, tc.output);
         
         if (res.verdict == Verdict::WA) {
@@ -380,6 +479,7 @@ JudgeResult Judge::run_process_redirect(const std::string& cmd,
     shuati::sandbox::SandboxLimits limits;
     limits.cpu_time_ms = time_limit_ms;
     limits.memory_mb = memory_limit_kb / 1024;
+    limits.output_limit_bytes = output_limit_bytes_;
 
     auto sb_res = sb->execute(
         executable,
@@ -398,9 +498,13 @@ JudgeResult Judge::run_process_redirect(const std::string& cmd,
         res.verdict = Verdict::TLE;
     } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::MemoryLimitExceeded) {
         res.verdict = Verdict::MLE;
+    } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::OutputLimitExceeded) {
+        res.verdict = Verdict::OLE;
+        res.message = fmt::format("Output limit exceeded (> {} KB)", limits.output_limit_bytes / 1024);
     } else if (sb_res.status == shuati::sandbox::SandboxResultStatus::RuntimeError) {
         res.verdict = Verdict::RE;
-        std::string err_output = shuati::utils::ensure_utf8_lossy(shuati::read_text_file(err_file.path()));
+        std::string err_output = shuati::utils::ensure_utf8_lossy(
+            shuati::read_text_file(err_file.path(), kMaxErrorOutputBytes));
         res.message = err_output.empty() ? fmt::format("Exit code {}", sb_res.exit_code) : err_output;
         
         // Fallback checking for MLE
@@ -0,0 +1,136 @@
+#include "shuati/judge_cache.hpp"
+#include "shuati/utils/encoding.hpp"
+#include "shuati/utils/string_utils.hpp"
+#include <nlohmann/json.hpp>
+#include <fmt/core.h>
+#include <fstream>
+
+namespace shuati {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kCacheVersion = 2;  // 2: TLE/MLE no longer stored
+constexpr size_t kMaxCachedOutput = 64 * 1024;
+
+} // namespace
+
+JudgeCache::JudgeCache(fs::path path) : path_(std::move(path)) {
+    load();
+}
+
+std::string JudgeCache::hash_executable(const std::string& executable) {
+    constexpr const char* py_prefix = "PYTHON:";
+    std::string file = executable;
+    if (file.rfind(py_prefix, 0) == 0) file = file.substr(std::string(py_prefix).size());
+
+    std::ifstream in(utils::utf8_path(file), std::ios::in | std::ios::binary);
+    if (!in) return {};
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    char buf[64 * 1024];
+    while (in) {
+        in.read(buf, sizeof(buf));
+        auto n = in.gcount();
+        if (n <= 0) break;
+        h = utils::fnv1a_64(std::string_view(buf, static_cast<size_t>(n)), h);
+    }
+    return utils::hash_hex(h);
+}
+
+std::string JudgeCache::make_key(const std::string& exe_hash,
+                                 const TestCase& tc,
+                                 int time_limit_ms,
+                                 int memory_limit_kb) {
+    // Expected output is part of the key: editing a .out file must invalidate the verdict.
+    uint64_t h = utils::fnv1a_64(tc.input);
+    h = utils::fnv1a_64("\x1f", h);
+    h = utils::fnv1a_64(tc.output, h);
+    return fmt::format("{}:{}:{}:{}", exe_hash, utils::hash_hex(h), time_limit_ms, memory_limit_kb);
+}
+
+std::optional<JudgeResult> JudgeCache::lookup(const std::string& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return std::nullopt;
+
+    const auto& e = it->second;
+    JudgeResult r;
+    r.verdict = verdict_from_string(e.verdict);
+    r.time_ms = e.time_ms;
+    r.memory_kb = e.memory_kb;
+    r.message = e.message;
+    r.error_output = e.error_output;
+    r.output = e.output;
+    r.cached = true;
+
+    live_[key] = e;
+    hits_++;
+    return r;
+}
+
+void JudgeCache::store(const std::string& key, const JudgeResult& result, int time_limit_ms, double near_band) {
+    // System errors describe the host, not the solution; never replay them.
+    if (result.verdict == Verdict::SE) return;
+    // A busy machine can turn an AC into a TLE (or back); re-run those every time
+    if (result.verdict == Verdict::TLE || result.verdict == Verdict::MLE) return;
+    if (time_limit_ms > 0 && result.time_ms >= time_limit_ms * (1.0 - near_band)) return;
+
+    Entry e;
+    e.verdict = result.verdict_str();
+    e.time_ms = result.time_ms;
+    e.memory_kb = result.memory_kb;
+    if (result.verdict != Verdict::AC) {
+        e.message = result.message.substr(0, kMaxCachedOutput);
+        e.error_output = result.error_output.substr(0, kMaxCachedOutput);
+        e.output = result.output.substr(0, kMaxCachedOutput);
+    }
+    entries_[key] = e;
+    live_[key] = std::move(e);
+}
+
+void JudgeCache::load() {
+    entries_.clear();
+    std::ifstream in(path_);
+    if (!in) return;
+    try {
+        auto j = nlohmann::json::parse(in);
+        if (j.value("version", 0) != kCacheVersion || !j.contains("entries")) return;
+        for (const auto& [key, ej] : j["entries"].items()) {
+            Entry e;
+            e.verdict = ej.value("verdict", "");
+            e.time_ms = ej.value("time_ms", 0);
+            e.memory_kb = ej.value("memory_kb", 0);
+            e.message = ej.value("message", "");
+            e.error_output = ej.value("error_output", "");
+            e.output = ej.value("output", "");
+            entries_.emplace(key, std::move(e));
+        }
+    } catch (...) {
+        // Corrupt cache is equivalent to an empty one
+        entries_.clear();
+    }
+}
+
+void JudgeCache::save() const {
+    nlohmann::json j;
+    j["version"] = kCacheVersion;
+    j["entries"] = nlohmann::json::object();
+    for (const auto& [key, e] : live_) {
+        nlohmann::json ej = {
+            {"verdict", e.verdict},
+            {"time_ms", e.time_ms},
+            {"memory_kb", e.memory_kb}
+        };
+        if (!e.message.empty()) ej["message"] = e.message;
+        if (!e.error_output.empty()) ej["error_output"] = e.error_output;
+        if (!e.output.empty()) ej["output"] = e.output;
+        j["entries"][key] = std::move(ej);
+    }
+    std::error_code ec;
+    if (path_.has_parent_path()) fs::create_directories(path_.parent_path(), ec);
+    std::ofstream out(path_);
+    out << j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace shuati
@@ -11,7 +11,14 @@ namespace shuati {
 MemoryManager::MemoryManager(Database& db) : db_(db) {}
 
 std::string MemoryManager::get_relevant_context(const std::string& tags) {
-    auto mistakes = db_.get_all_memory_mistakes();
+    // Patterns linked to this problem's tags first, then the global top ones
+    std::vector<MemoryMistake> mistakes;
+    if (!tags.empty()) mistakes = db_.get_memory_mistakes_for_tags(tags, 3);
+    for (auto& m : db_.get_all_memory_mistakes()) {
+        if (mistakes.size() >= 3) break;
+        bool seen = std::any_of(mistakes.begin(), mistakes.end(), [&](const MemoryMistake& x) { return x.id == m.id; });
+        if (!seen) mistakes.push_back(std::move(m));
+    }
     auto mastery = db_.get_all_mastery();
     auto profile = db_.get_user_profile();
     
@@ -23,16 +30,21 @@ std::string MemoryManager::get_relevant_context(const std::string& tags) {
     }
     ss << "\n";
 
-    // Filter mistakes relevant to tags (simple substring match for now)
-    // Or just show top global mistakes if no specific tags matches
-    // For V1 iteration, we just show top 3 global mistakes to keep it simple and robust
     if (!mistakes.empty()) {
         ss << "## Frequent Mistakes (Please Check)\n";
-        int count = 0;
         for (const auto& m : mistakes) {
-            if (count >= 3) break;
             ss << "- " << m.pattern << " (freq: " << m.frequency << ")\n";
-            count++;
+        }
+        ss << "\n";
+    }
+
+    // Solve rate on this problem's tags, or the weakest tags overall
+    auto tag_stats = tags.empty() ? db_.get_weakest_tags(3) : db_.get_tag_stats(tags);
+    if (!tag_stats.empty()) {
+        ss << (tags.empty() ? "## Weakest Tags (Focus Here)\n" : "## Tag Solve Rates\n");
+        for (const auto& t : tag_stats) {
+            ss << fmt::format("- {}: {}/{} solved ({:.0f}%), {} problems\n", t.tag, t.solved, t.attempted,
+                              t.solve_rate() * 100.0, t.problems);
         }
         ss << "\n";
     }
@@ -1,5 +1,6 @@
 #include "shuati/problem_manager.hpp"
 #include "shuati/utils/string_utils.hpp"
+#include "shuati/utils/project_utils.hpp"
 #include <cpr/cpr.h>
 #include <fmt/core.h>
 #include <fmt/color.h>
@@ -8,6 +9,9 @@
 #include <ctime>
 #include "shuati/config.hpp"
 #include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <unordered_map>
 #include "shuati/crawler.hpp"
 
 namespace shuati {
@@ -71,15 +75,6 @@ void ProblemManager::pull_problem(const std::string& url) {
     
     // Save to DB first — if this fails, the file is untouched (DB is source of truth)
     p.content_path = std::filesystem::absolute(filename).string();
-    db_->add_problem(p);
-
-    // Save test cases
-    if (!cases.empty()) {
-        for (const auto& tc : cases) {
-            db_->add_test_case(p.id, tc.input, tc.output, tc.is_sample);
-        }
-        fmt::print(fg(fmt::color::cyan), "    获取到 {} 个测试用例。\n", cases.size());
-    }
 
     ReviewItem r;
     r.problem_id = p.id;
@@ -87,7 +82,12 @@ void ProblemManager::pull_problem(const std::string& url) {
     r.interval = 1;
     r.ease_factor = 2.5;
     r.repetitions = 0;
-    db_->upsert_review(r);
+
+    // Problem, test cases and first review are committed atomically
+    db_->add_problem_with_cases(p, cases, r);
+    if (!cases.empty()) {
+        fmt::print(fg(fmt::color::cyan), "    获取到 {} 个测试用例。\n", cases.size());
+    }
 
     // Write file only after DB insert succeeds
     std::ofstream out(filename);
@@ -147,10 +147,13 @@ std::string ProblemManager::create_local(const std::string& title, const std::st
 
 
 Problem ProblemManager::get_problem(const std::string& id) {
-    // Try parsing as integer first
+    // Try parsing as integer first; the TID -> UUID step is an in-memory lookup
     if (auto tid = utils::try_parse_number<int>(id)) {
-        auto p = db_->get_problem_by_display_id(*tid);
-        if (!p.id.empty()) return p;
+        auto uuid = db_->problem_id_for_tid(*tid);
+        if (!uuid.empty()) {
+            auto p = db_->get_problem(uuid);
+            if (!p.id.empty()) return p;
+        }
     }
 
     // Fallback to UUID string
@@ -158,47 +161,82 @@ Problem ProblemManager::get_problem(const std::string& id) {
 }
 
 void ProblemManager::delete_problem(int tid) {
-    auto p = db_->get_problem_by_display_id(tid);
-    if (!p.id.empty()) delete_problem(p.id);
+    delete_problems({tid});
 }
 
 void ProblemManager::delete_problem(const std::string& id) {
     auto p = db_->get_problem(id);
-    if (p.id.empty()) return;
+    if (p.id.empty() || p.display_id <= 0) return;
+    delete_problems({p.display_id});
+}
+
+namespace {
+
+// Old-format solution files ("<TID>_<title>.cpp|.py") in `dir`, keyed by TID.
+// One directory scan serves a whole batch of deletions.
+std::unordered_map<int, std::vector<std::filesystem::path>> index_tid_solutions(const std::filesystem::path& dir) {
+    std::unordered_map<int, std::vector<std::filesystem::path>> index;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        const auto& path = it->path();
+        auto ext = path.extension();
+        if (ext != ".cpp" && ext != ".py") continue;
+        std::string name = path.filename().string();
+        int tid = 0;
+        auto [rest, err] = std::from_chars(name.data(), name.data() + name.size(), tid);
+        if (err != std::errc() || rest == name.data() || *rest != '_') continue;
+        index[tid].push_back(path);
+    }
+    return index;
+}
+
+} // namespace
+
+int ProblemManager::delete_problems(const std::vector<int>& tids) {
+    // Files are resolved against the project root, as find_solution_file does,
+    // not against the directory the command happens to run from
+    const auto root = utils::find_root_or_die();
+    std::vector<ProblemSummary> doomed;
+    std::vector<int> doomed_tids;
+    for (int tid : tids) {
+        auto p = db_->get_problem_summary_by_display_id(tid);
+        if (!p) continue;
+        doomed_tids.push_back(p->display_id);
+        doomed.push_back(std::move(*p));
+    }
+    if (doomed.empty()) return 0;
 
     // Delete from DB first — if this fails, files are untouched
-    if (p.display_id > 0) db_->delete_problem(p.display_id);
+    int deleted = db_->delete_problems(doomed_tids);
 
     // Only delete files after DB deletion succeeds
-    if (std::filesystem::exists(p.content_path)) {
-        std::filesystem::remove(p.content_path);
+    auto tid_solutions = index_tid_solutions(root);
+    std::error_code ec;
+    for (const auto& p : doomed) {
+        if (!p.content_path.empty()) std::filesystem::remove(root / p.content_path, ec);  // Usually absolute
+        // Delete solution file(s) — both old and new naming formats
+        for (const auto& ext : {".cpp", ".py"}) std::filesystem::remove(root / ("solution_" + p.id + ext), ec);
+        if (auto it = tid_solutions.find(p.display_id); it != tid_solutions.end()) {
+            for (const auto& path : it->second) std::filesystem::remove(path, ec);
+        }
     }
 
-    // Delete solution file(s) — both old and new naming formats
-    for (const auto& ext : {".cpp", ".py"}) {
-        // Old format
-        std::string sol_old = "solution_" + p.id + ext;
-        if (std::filesystem::exists(sol_old)) std::filesystem::remove(sol_old);
-        // New format (TID_title.ext) — scan for files starting with "TID_"
-        std::string tid_prefix = std::to_string(p.display_id) + "_";
-        try {
-            for (const auto& entry : std::filesystem::directory_iterator(".")) {
-                std::string name = entry.path().filename().string();
-                if (name.rfind(tid_prefix, 0) == 0 && name.size() > 4 &&
-                    name.substr(name.size() - std::string(ext).size()) == ext) {
-                    std::filesystem::remove(entry.path());
-                }
-            }
-        } catch (...) {}
+    if (doomed.size() == 1) {
+        fmt::print(fg(fmt::color::green), "[+] 题目已删除: {} (TID: {})\n", doomed[0].title, doomed[0].display_id);
+    } else {
+        fmt::print(fg(fmt::color::green), "[+] 已删除 {} 道题目\n", deleted);
     }
-
-    fmt::print(fg(fmt::color::green), "[+] 题目已删除: {} (TID: {})\n", p.title, p.display_id);
+    return deleted;
 }
 
 std::vector<Problem> ProblemManager::list_problems() {
     return db_->get_all_problems();
 }
 
+std::vector<ProblemSummary> ProblemManager::list_problem_summaries() {
+    return db_->get_problem_summaries();
+}
+
 std::string ProblemManager::fetch_html(const std::string& url) {
     try {
         auto r = cpr::Get(cpr::Url{url}, cpr::Timeout{10000});
@@ -230,36 +268,11 @@ Problem ProblemManager::parse_html(const std::string& html, const std::string& u
     return p;
 }
 
-std::vector<Problem> ProblemManager::filter_problems(const std::vector<Problem>& problems,
-                                                     const std::string& status_filter,
-                                                     const std::string& difficulty_filter,
-                                                     const std::string& source_filter) {
-    std::vector<Problem> result = problems;
-    
-    if (status_filter == "review") {
-        auto reviews = db_->get_due_reviews(std::time(nullptr));
-        std::unordered_set<std::string> due_ids;
-        for (const auto& r : reviews) due_ids.insert(r.problem_id);
-        
-        result.erase(std::remove_if(result.begin(), result.end(),
-            [&](const Problem& p) {
-                if (due_ids.find(p.id) == due_ids.end()) return true;
-                if (difficulty_filter != "all" && p.difficulty != difficulty_filter) return true;
-                if (source_filter != "all" && utils::canonical_source(p.source) != source_filter) return true;
-                return false;
-            }), result.end());
-        return result;
-    }
+ProblemPage ProblemManager::query_problems(const ProblemQuery& query) {
+    return db_->query_problems(query);
+}
 
-    result.erase(std::remove_if(result.begin(), result.end(),
-        [&](const Problem& p) {
-            if (difficulty_filter != "all" && p.difficulty != difficulty_filter) return true;
-            if (source_filter != "all" && utils::canonical_source(p.source) != source_filter) return true;
-            if (status_filter == "ac") return p.last_verdict != "AC";
-            if (status_filter == "failed") return p.last_verdict == "AC" || p.last_verdict.empty() || p.last_verdict == "SKIPPED";
-            if (status_filter == "unaudited") return !p.last_verdict.empty() && p.last_verdict != "SKIPPED";
-            return false;
-        }), result.end());
-    return result;
+int ProblemManager::count_problems(const ProblemQuery& query) {
+    return db_->count_problems(query);
 }
 } // namespace shuati
@@ -25,6 +25,13 @@ private:
         return cached;
     }
 
+    // Catches programs that ignore SIGXFSZ and keep going after EFBIG (e.g. Python)
+    static bool exceeds_output_limit(const std::string& path, long long limit_bytes) {
+        if (path.empty() || limit_bytes <= 0) return false;
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && st.st_size > limit_bytes;
+    }
+
 public:
     LinuxSandbox() = default;
     ~LinuxSandbox() override = default;
@@ -89,6 +96,16 @@ public:
                 setrlimit(RLIMIT_AS, &rl_mem); // Address space limit
             }
 
+            // Output Limit: one byte of slack so exactly-at-limit output stays legal;
+            // crossing it raises SIGXFSZ (or EFBIG if the program ignores the signal)
+            if (limits.output_limit_bytes > 0) {
+                struct rlimit rl_fsize;
+                rl_fsize.rlim_cur = static_cast<rlim_t>(limits.output_limit_bytes) + 1;
+                rl_fsize.rlim_max = rl_fsize.rlim_cur;
+                setrlimit(RLIMIT_FSIZE, &rl_fsize);
+                signal(SIGXFSZ, SIG_DFL);
+            }
+
             // Time Limit
             if (limits.cpu_time_ms > 0) {
                 struct rlimit rl_cpu;
@@ -197,6 +214,8 @@ public:
                                      result.status = SandboxResultStatus::MemoryLimitExceeded;
                                 }
                             }
+                        } else if (sig == SIGXFSZ) {
+                            result.status = SandboxResultStatus::OutputLimitExceeded;
                         } else if (sig == SIGSEGV || sig == SIGABRT) {
                             result.status = SandboxResultStatus::RuntimeError;
                             // Check for MLE disguised as SEGFAULT
@@ -209,6 +228,11 @@ public:
                             result.status = SandboxResultStatus::RuntimeError;
                         }
                     }
+                    if (result.status != SandboxResultStatus::MemoryLimitExceeded &&
+                        (exceeds_output_limit(output_file, limits.output_limit_bytes) ||
+                         exceeds_output_limit(error_file, limits.output_limit_bytes))) {
+                        result.status = SandboxResultStatus::OutputLimitExceeded;
+                    }
                     break;
                 } else if (ret == 0) {
                     // Still running, check time
@@ -10,6 +10,18 @@ namespace shuati {
 namespace sandbox {
 
 class WindowsSandbox : public ISandbox {
+private:
+    static bool exceeds_output_limit(const std::string& path, long long limit_bytes) {
+        if (path.empty() || limit_bytes <= 0) return false;
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        std::wstring w = shuati::utils::utf8_to_wide(path);
+        if (!GetFileAttributesExW(w.c_str(), GetFileExInfoStandard, &data)) return false;
+        ULARGE_INTEGER size;
+        size.HighPart = data.nFileSizeHigh;
+        size.LowPart = data.nFileSizeLow;
+        return size.QuadPart > static_cast<ULONGLONG>(limit_bytes);
+    }
+
 public:
     WindowsSandbox() = default;
     ~WindowsSandbox() override = default;
@@ -132,10 +144,35 @@ public:
         // 7. Resume the Process
         ResumeThread(pi.hThread);
 
-        // 8. Wait for Process with Time Limit
-        auto wait_res = WaitForSingleObject(pi.hProcess, (DWORD)limits.cpu_time_ms);
+        // 8. Wait for Process with Time Limit.
+        // Job Objects cannot cap file size, so with an output limit we wait in
+        // short slices and kill the process once stdout/stderr grow past it.
+        DWORD wait_res = WAIT_TIMEOUT;
+        bool output_exceeded = false;
+        if (limits.output_limit_bytes > 0) {
+            const ULONGLONG start = GetTickCount64();
+            const ULONGLONG budget = (ULONGLONG)limits.cpu_time_ms;
+            while (true) {
+                ULONGLONG elapsed = GetTickCount64() - start;
+                ULONGLONG remaining = elapsed >= budget ? 0 : budget - elapsed;
+                wait_res = WaitForSingleObject(pi.hProcess, (DWORD)(remaining < 20 ? remaining : 20));
+                if (wait_res != WAIT_TIMEOUT) break;
+                if (exceeds_output_limit(output_file, limits.output_limit_bytes) ||
+                    exceeds_output_limit(error_file, limits.output_limit_bytes)) {
+                    output_exceeded = true;
+                    TerminateProcess(pi.hProcess, ~0U);
+                    WaitForSingleObject(pi.hProcess, INFINITE);
+                    break;
+                }
+                if (remaining == 0) break;
+            }
+        } else {
+            wait_res = WaitForSingleObject(pi.hProcess, (DWORD)limits.cpu_time_ms);
+        }
 
-        if (wait_res == WAIT_TIMEOUT) {
+        if (output_exceeded) {
+            result.status = SandboxResultStatus::OutputLimitExceeded;
+        } else if (wait_res == WAIT_TIMEOUT) {
             result.status = SandboxResultStatus::TimeLimitExceeded;
             TerminateProcess(pi.hProcess, ~0U); // Force kill
         } else {
@@ -170,6 +207,11 @@ public:
                  } else {
                      result.status = SandboxResultStatus::OK;
                  }
+                 // Output written between the last poll and exit
+                 if (exceeds_output_limit(output_file, limits.output_limit_bytes) ||
+                     exceeds_output_limit(error_file, limits.output_limit_bytes)) {
+                     result.status = SandboxResultStatus::OutputLimitExceeded;
+                 }
             }
 
             // Retrieve resource usage
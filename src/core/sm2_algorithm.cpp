@@ -49,7 +49,7 @@ int SM2Algorithm::auto_quality(const std::string& verdict, int time_ms, int time
     }
     if (verdict == "WA")  return 2;      // Wrong answer — significant difficulty
     if (verdict == "TLE") return 1;      // Time limit — serious issue
-    // RE, CE, MLE, SE, etc.
+    // RE, CE, MLE, OLE, SE, etc.
     return 0;                            // Complete failure
 }
 
@@ -1,7 +1,15 @@
 #include "shuati/database.hpp"
 #include "shuati/utils/encoding.hpp"
+#include "shuati/utils/string_utils.hpp"
 #include <fmt/core.h>
+#include <sqlite3.h>
 #include <chrono>
+#include <tuple>
+#include <variant>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -14,23 +22,14 @@ using utils::ensure_utf8_lossy;
 namespace {
 
 /**
- * @brief 安全地获取数据库列文本值
+ * @brief 获取数据库列文本值
  * @param col SQLite列对象
- * @return UTF-8编码的字符串，失败返回空字符串
+ * @return 列文本，NULL 返回空字符串
+ * @note 所有写入路径都经过 ensure_utf8_lossy，迁移第 5 步清洗了旧数据，
+ *       库中文本已知是合法 UTF-8，因此读取时不再逐行校验
  */
 static std::string safe_column_text(SQLite::Column col) {
-    try {
-        return ensure_utf8_lossy(col.getString());
-    } catch (...) {
-        try {
-            const void* b = col.getBlob();
-            int n = col.getBytes();
-            if (!b || n <= 0) return {};
-            return ensure_utf8_lossy(std::string((const char*)b, (size_t)n));
-        } catch (...) {
-            return {};
-        }
-    }
+    return col.getString();
 }
 
 /**
@@ -60,20 +59,1068 @@ static Problem fill_problem_from_row(SQLite::Statement& q) {
     return p;
 }
 
+/**
+ * @brief 从投影查询结果填充ProblemSummary（不含description列）
+ * @param q SQLite查询语句（列顺序见 kSummaryColumns）
+ * @return 填充好的ProblemSummary对象
+ */
+static ProblemSummary fill_summary_from_row(SQLite::Statement& q) {
+    ProblemSummary p;
+    p.display_id = q.getColumn(0).getInt();
+    p.id = safe_column_text(q.getColumn(1));
+    p.source = safe_column_text(q.getColumn(2));
+    p.title = safe_column_text(q.getColumn(3));
+    p.url = safe_column_text(q.getColumn(4));
+    p.content_path = safe_column_text(q.getColumn(5));
+    p.tags = safe_column_text(q.getColumn(6));
+    p.difficulty = safe_column_text(q.getColumn(7));
+    p.created_at = q.getColumn(8).getInt64();
+    p.last_verdict = safe_column_text(q.getColumn(9));
+    try { p.pass_count = q.getColumn(10).getInt(); } catch(...) { p.pass_count = 0; }
+    try { p.total_count = q.getColumn(11).getInt(); } catch(...) { p.total_count = 0; }
+    try { p.last_checked_at = q.getColumn(12).getInt64(); } catch(...) { p.last_checked_at = 0; }
+    return p;
+}
+
+constexpr const char* kSummaryColumns =
+    "p.tid, p.id, p.source, p.title, p.url, p.content_path, p.tags, p.difficulty, p.created_at, "
+    "p.last_verdict, p.pass_count, p.total_count, p.last_checked_at";
+
+/**
+ * @brief utils::canonical_source() 的 SQL 版本，用于维护可索引的 source_key 列
+ * @param expr 来源字段或参数占位符（如 "source"、"?2"）
+ * @note 修改 canonical_source() 的规则时需同步修改此处
+ */
+static std::string source_key_sql(const std::string& expr) {
+    return fmt::format(
+        "CASE WHEN lower({0}) LIKE '%leetcode%' THEN 'leetcode' "
+        "WHEN lower({0}) LIKE '%codeforces%' THEN 'codeforces' "
+        "WHEN lower({0}) LIKE '%luogu%' THEN 'luogu' "
+        "WHEN lower({0}) LIKE '%lanqiao%' THEN 'lanqiao' "
+        "WHEN lower({0}) LIKE '%local%' OR {0} IS NULL OR {0} = '' THEN 'local' "
+        "ELSE 'other' END", expr);
+}
+
+static bool column_exists(SQLite::Database& db, const std::string& table, const std::string& column) {
+    SQLite::Statement q(db, fmt::format("PRAGMA table_info({})", table));
+    while (q.executeStep()) {
+        if (q.getColumn(1).getString() == column) return true;
+    }
+    return false;
+}
+
+using SqlArg = std::variant<std::string, int64_t>;
+
+/**
+ * @brief 将 ProblemQuery 的过滤条件翻译为 FROM/WHERE 子句
+ * @param query 查询条件
+ * @param args 输出：按出现顺序排列的绑定参数
+ * @param with_cursor 是否包含 keyset 游标条件（计数时不需要）
+ * @param tag_walk 按行探测 problem_tags 而不是从它连接，分页查询可沿 created_at 索引提前结束
+ * @return 以 " FROM problems p" 开头的 SQL 片段
+ */
+static std::string problem_filter_sql(const ProblemQuery& query, std::vector<SqlArg>& args, bool with_cursor,
+                                      bool tag_walk = false) {
+    std::string sql = " FROM problems p";
+    if (query.status == "review") {
+        sql += " JOIN reviews r ON r.problem_id = p.id AND r.next_review <= ?";
+        args.emplace_back(static_cast<int64_t>(query.now ? query.now : std::time(nullptr)));
+    }
+    if (!query.tag.empty() && !tag_walk) {
+        sql += " JOIN problem_tags pt ON pt.problem_id = p.id AND pt.tag_id = (SELECT id FROM tags WHERE name = ?)";
+        args.emplace_back(ensure_utf8_lossy(shuati::utils::trim(query.tag)));
+    }
+    sql += " WHERE 1=1";
+    if (!query.tag.empty() && tag_walk) {
+        sql += " AND EXISTS (SELECT 1 FROM problem_tags pt WHERE pt.problem_id = p.id"
+               " AND pt.tag_id = (SELECT id FROM tags WHERE name = ?))";
+        args.emplace_back(ensure_utf8_lossy(shuati::utils::trim(query.tag)));
+    }
+
+    if (query.status == "ac") {
+        sql += " AND p.last_verdict = 'AC'";
+    } else if (query.status == "failed") {
+        sql += " AND p.last_verdict NOT IN ('AC', '', 'SKIPPED')";
+    } else if (query.status == "unaudited") {
+        sql += " AND (p.last_verdict IN ('', 'SKIPPED') OR p.last_verdict IS NULL)";
+    }
+    if (!query.difficulty.empty() && query.difficulty != "all") {
+        sql += " AND p.difficulty = ?";
+        args.emplace_back(query.difficulty);
+    }
+    if (!query.source.empty() && query.source != "all") {
+        sql += " AND p.source_key = ?";
+        args.emplace_back(query.source);
+    }
+    if (with_cursor && query.after) {
+        sql += " AND (p.created_at, p.rowid) < (?, ?)";
+        args.emplace_back(static_cast<int64_t>(query.after->created_at));
+        args.emplace_back(static_cast<int64_t>(query.after->rowid));
+    }
+    return sql;
+}
+
+// shuati_plaintext(html): SQL wrapper over utils::html_to_plaintext, called by
+// the FTS triggers of schemas before version 10 while they are migrated
+static void sql_plaintext(sqlite3_context* ctx, int /*argc*/, sqlite3_value** argv) {
+    auto text = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    if (!text) {
+        sqlite3_result_text(ctx, "", 0, SQLITE_STATIC);
+        return;
+    }
+    std::string plain = utils::html_to_plaintext(
+        std::string_view(text, static_cast<size_t>(sqlite3_value_bytes(argv[0]))));
+    sqlite3_result_text(ctx, plain.data(), static_cast<int>(plain.size()), SQLITE_TRANSIENT);
+}
+
+static std::string_view sql_text_arg(sqlite3_value* v) {
+    auto text = reinterpret_cast<const char*>(sqlite3_value_text(v));
+    return text ? std::string_view(text, static_cast<size_t>(sqlite3_value_bytes(v))) : std::string_view{};
+}
+
+// shuati_utf8_valid(text): 1 if text is NULL or well-formed UTF-8
+static void sql_utf8_valid(sqlite3_context* ctx, int /*argc*/, sqlite3_value** argv) {
+    sqlite3_result_int(ctx, utils::is_valid_utf8(sql_text_arg(argv[0])) ? 1 : 0);
+}
+
+// shuati_utf8_lossy(text): utils::ensure_utf8_lossy, NULL stays NULL
+static void sql_utf8_lossy(sqlite3_context* ctx, int /*argc*/, sqlite3_value** argv) {
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    std::string fixed = ensure_utf8_lossy(std::string(sql_text_arg(argv[0])));
+    sqlite3_result_text(ctx, fixed.data(), static_cast<int>(fixed.size()), SQLITE_TRANSIENT);
+}
+
+// Comma-separated tags, trimmed, without empties or repeats, in first-seen order
+static std::vector<std::string> split_tags(const std::string& tags) {
+    std::vector<std::string> out;
+    for (auto tag : shuati::utils::split(tags, ',')) {
+        tag = shuati::utils::trim(tag);
+        if (tag.empty() || std::find(out.begin(), out.end(), tag) != out.end()) continue;
+        out.push_back(std::move(tag));
+    }
+    return out;
+}
+
+// split_tags() as a JSON array of strings, for json_each()
+static std::string tag_list_json(const std::string& tags) {
+    std::string out = "[";
+    for (const auto& tag : split_tags(tags)) {
+        if (out.size() > 1) out += ',';
+        out += '"';
+        for (char c : tag) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out += fmt::format("\\u{:04x}", static_cast<int>(c));
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+    return out + "]";
+}
+
+// shuati_tag_list(tags): tag_list_json() for the tag backfill and the tag
+// triggers of schemas before version 11, NULL gives []
+static void sql_tag_list(sqlite3_context* ctx, int /*argc*/, sqlite3_value** argv) {
+    std::string json = tag_list_json(std::string(sql_text_arg(argv[0])));
+    sqlite3_result_text(ctx, json.data(), static_cast<int>(json.size()), SQLITE_TRANSIENT);
+}
+
+static size_t utf8_length(const std::string& s) {
+    size_t n = 0;
+    for (unsigned char c : s) n += (c & 0xC0) != 0x80;
+    return n;
+}
+
+// Escape LIKE wildcards; used with ESCAPE '\'
+static std::string like_pattern(const std::string& term) {
+    std::string out = "%";
+    for (char c : term) {
+        if (c == '%' || c == '_' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "%";
+}
+
+// Per-connection settings shared by the write connection and the read pool
+static void apply_profile(SQLite::Database& db, const DbProfile& p) {
+    db.setBusyTimeout(p.busy_timeout_ms);
+    db.exec(fmt::format("PRAGMA cache_size = -{};", p.cache_size_kb));
+    db.exec(fmt::format("PRAGMA mmap_size = {};", p.mmap_size));
+    db.exec(p.temp_store_memory ? "PRAGMA temp_store = MEMORY;" : "PRAGMA temp_store = DEFAULT;");
+}
+
+static void bind_args(SQLite::Statement& q, const std::vector<SqlArg>& args) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        int idx = static_cast<int>(i + 1);
+        if (auto s = std::get_if<std::string>(&args[i])) q.bind(idx, *s);
+        else q.bind(idx, std::get<int64_t>(args[i]));
+    }
+}
+
 } // namespace
 
-Database::Database(const std::string& db_path) {
+Database::Database(const std::string& db_path, const DbProfile& profile) : path_(db_path), profile_(profile) {
     std::filesystem::path p(db_path);
     if (p.has_parent_path())
         std::filesystem::create_directories(p.parent_path());
 
     db_ = std::make_unique<SQLite::Database>(db_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    // Only takes effect on a new file (before the first table); older databases
+    // are converted by `shuati db maintain --full`
+    db_->exec("PRAGMA auto_vacuum = INCREMENTAL;");
     // WAL mode: allows concurrent reads while writing (prevents "database is locked" in Companion thread)
     db_->exec("PRAGMA journal_mode=WAL;");
     db_->exec("PRAGMA synchronous=NORMAL;");
     db_->exec("PRAGMA foreign_keys = ON;");
-    init_schema();
-    this->init_indexes(); // 新增：初始化索引
+    // Cache/mmap/temp store; the busy timeout waits for another process's
+    // write (e.g. a concurrent migration) instead of failing
+    apply_profile(*db_, profile_);
+    // Checkpoints run on the connection that commits, i.e. this one
+    db_->exec(fmt::format("PRAGMA wal_autocheckpoint = {};", profile_.wal_autocheckpoint));
+    // Bounds the ANALYZE run by PRAGMA optimize during idle maintenance
+    db_->exec("PRAGMA analysis_limit = 400;");
+    register_sql_functions(*db_);
+    migrate();
+
+    // A reader per core up to a handful: list/status/preview loaders and the
+    // Companion thread rarely exceed that, and each pooled connection keeps its
+    // own page cache and statement cache
+    if (profile_.read_connections <= 0)
+        profile_.read_connections = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 2u, 4u));
+    for (int i = 0; i < profile_.read_connections; ++i)
+        readers_.push_back(std::make_unique<ReadConnection>(db_path, profile_));
+
+    // Report what SQLite actually accepted
+    profile_.cache_size_kb = static_cast<int>(-pragma_int("cache_size"));
+    profile_.mmap_size = pragma_int("mmap_size");
+    profile_.temp_store_memory = pragma_int("temp_store") == 2;
+    profile_.wal_autocheckpoint = static_cast<int>(pragma_int("wal_autocheckpoint"));
+    profile_.busy_timeout_ms = static_cast<int>(pragma_int("busy_timeout"));
+
+    // From here on db_ belongs to the writer thread
+    writer_ = std::thread([this] { writer_loop(); });
+}
+
+Database::~Database() {
+    if (writer_.joinable()) {
+        write_queue_.push(WriteJob{});  // Stop after everything queued before it
+        writer_.join();
+    }
+}
+
+Database::ReadConnection::ReadConnection(const std::string& path, const DbProfile& profile)
+    : db(std::make_unique<SQLite::Database>(path, SQLite::OPEN_READONLY)) {
+    // query_only also rejects writes smuggled in through SQL functions or
+    // ATTACH; mmap serves pages from the OS cache shared by all pool members
+    // instead of copying them into each connection's private cache. (SQLite's
+    // shared-cache mode is not used: it adds table-level locks between the
+    // connections, which is what the pool is meant to avoid.)
+    db->exec("PRAGMA query_only = ON;");
+    apply_profile(*db, profile);
+    register_sql_functions(*db);
+}
+
+DbProfile DbProfile::preset(const std::string& name) {
+    DbProfile p;
+    if (name == "laptop") return p;
+    if (name == "server") {
+        // Memory is plentiful and the library large: keep hot pages and temp
+        // b-trees in RAM, map the whole file, checkpoint less often
+        p.name = "server";
+        p.cache_size_kb = 65536;
+        p.mmap_size = 1LL << 30;
+        p.temp_store_memory = true;
+        p.wal_autocheckpoint = 4000;
+        p.busy_timeout_ms = 15000;
+        return p;
+    }
+    throw std::invalid_argument(fmt::format("未知的数据库性能配置: {} (可选: laptop, server)", name));
+}
+
+std::vector<std::string> DbProfile::preset_names() {
+    return {"laptop", "server"};
+}
+
+int Database::schema_version() {
+    SQLite::Statement q(on_writer_thread() ? *db_ : read_db(), "PRAGMA user_version");
+    return q.executeStep() ? q.getColumn(0).getInt() : 0;
+}
+
+/**
+ * @brief 按 PRAGMA user_version 执行尚未应用的迁移步骤
+ * @note 所有步骤都是幂等的，因此引入版本号之前创建的数据库（user_version = 0）
+ *       会从第 1 步开始安全升级。新增步骤时追加到列表末尾并递增 kSchemaVersion。
+ */
+void Database::migrate() {
+    if (schema_version() >= kSchemaVersion) return;
+
+    const std::vector<std::pair<int, std::function<void()>>> steps = {
+        {1, [this] { init_schema(); init_indexes(); }}, // 引入版本号之前的表结构与索引
+        {2, [this] { init_fulltext(); }},               // FTS5 全文索引
+        {3, [this] { init_attempts(); }},               // 提交历史与汇总表
+        {4, [this] { init_stats(); }},                  // 仪表盘计数器
+        {5, [this] { init_text_encoding(); }},          // 清洗旧数据中的非法 UTF-8
+        {6, [this] { init_tids(); }},                   // 稳定的题目编号 (TID)
+        {7, [this] { init_cascades(); }},               // 删除题目时级联删除用例、复习与错题
+        {8, [this] { init_tags(); }},                   // 标签拆分为 tags / problem_tags 关系表
+        {9, [this] { init_fulltext_keys(); }},          // 全文索引改以 TID 为键
+        {10, [this] { init_fulltext_keys(); }},         // 全文索引触发器只用内置 SQL
+        {11, [this] { init_tag_triggers(); }},          // 标签触发器只用内置 SQL
+    };
+
+    // IMMEDIATE takes the write lock before the version is re-read, so two
+    // processes opening an old database at once do not both run the steps
+    db_->exec("BEGIN IMMEDIATE");
+    try {
+        int version = schema_version();
+        for (const auto& [target, apply] : steps) {
+            if (target <= version) continue;
+            apply();
+            db_->exec(fmt::format("PRAGMA user_version = {}", target));
+        }
+        db_->exec("COMMIT");
+    } catch (...) {
+        try { db_->exec("ROLLBACK"); } catch (...) {}
+        throw;
+    }
+}
+
+bool Database::has_fulltext_index() {
+    std::call_once(fts_once_, [this] { fts_enabled_ = read_db().tableExists("problems_fts"); });
+    return fts_enabled_;
+}
+
+Database::StatementLease Database::cached_statement(const std::string& sql) {
+    const bool write = on_writer_thread();
+    ReadConnection* rc = write ? nullptr : &reader();
+    SQLite::Database& db = write ? *db_ : *rc->db;
+    std::mutex& mtx = write ? stmt_cache_mtx_ : rc->cache_mtx;
+    auto& cache = write ? stmt_cache_ : rc->cache;
+    CachedStatement* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto& slot = cache[sql];
+        if (!slot) slot = std::make_unique<CachedStatement>(db, sql);
+        entry = slot.get();
+    }
+    // Entries are never evicted, so the pointer stays valid outside the map lock
+    return StatementLease(*entry);
+}
+
+/**
+ * @brief 当前线程使用的只读连接
+ * @note 每个线程首次读取时按轮转领取一个编号并一直沿用，
+ *       因此不同线程的查询分散到不同连接上并行执行
+ */
+Database::ReadConnection& Database::reader() {
+    static std::atomic<size_t> next_ticket{0};
+    thread_local const size_t ticket = next_ticket.fetch_add(1, std::memory_order_relaxed);
+    return *readers_[ticket % readers_.size()];
+}
+
+SQLite::Database& Database::read_db() {
+    return readers_.empty() ? *db_ : *reader().db;
+}
+
+size_t Database::cached_statement_count() {
+    size_t n = 0;
+    {
+        std::lock_guard<std::mutex> lock(stmt_cache_mtx_);
+        n += stmt_cache_.size();
+    }
+    for (auto& rc : readers_) {
+        std::lock_guard<std::mutex> lock(rc->cache_mtx);
+        n += rc->cache.size();
+    }
+    return n;
+}
+
+WriteStats Database::write_stats() const {
+    return {write_jobs_.load(), write_batches_.load()};
+}
+
+// ---- Writer thread ----
+
+bool Database::on_writer_thread() const {
+    // Before the thread starts (construction, migrations) the caller owns db_
+    return !writer_.joinable() || std::this_thread::get_id() == writer_.get_id();
+}
+
+/**
+ * @brief 将写操作交给写线程执行并等待其提交
+ * @note 在写线程内调用时直接执行（写方法之间可以相互调用）
+ */
+void Database::run_write(std::function<void()> fn, bool standalone) {
+    if (on_writer_thread()) {
+        fn();
+        return;
+    }
+    WriteJob job{std::move(fn), {}, standalone};
+    auto done = job.done.get_future();
+    write_queue_.push(std::move(job));
+    done.get();  // Rethrows the job's exception
+}
+
+void Database::writer_loop() {
+    bool idle_pending = false;  // Writes since the last idle maintenance pass
+    while (true) {
+        auto jobs = write_queue_.drain();
+        if (jobs.empty()) {
+            // Housekeeping only between bursts, one short pass at a time, so a
+            // write that arrives meanwhile waits at most one pass
+            if (idle_pending) {
+                idle_pending = idle_maintenance();
+                continue;
+            }
+            write_queue_.wait();
+            continue;
+        }
+        auto stop = std::find_if(jobs.begin(), jobs.end(), [](const WriteJob& j) { return !j.fn; });
+        bool stopping = stop != jobs.end();
+        // Nothing is queued after the stop job (it is pushed by the destructor)
+        if (stopping) jobs.erase(stop, jobs.end());
+        // Standalone jobs split the drained jobs into batches, keeping queue order
+        std::vector<WriteJob> batch;
+        for (auto& job : jobs) {
+            if (!job.standalone) {
+                batch.push_back(std::move(job));
+                continue;
+            }
+            if (!batch.empty()) commit_batch(batch);
+            batch.clear();
+            run_standalone(job);
+        }
+        if (!batch.empty()) commit_batch(batch);
+        idle_pending = true;
+        if (stopping) return;
+    }
+}
+
+void Database::run_standalone(WriteJob& job) {
+    ++write_jobs_;
+    try {
+        job.fn();
+        job.done.set_value();
+    } catch (...) {
+        job.done.set_exception(std::current_exception());
+    }
+}
+
+/**
+ * @brief 在一个事务中执行一批写操作，每个操作使用独立的 SAVEPOINT
+ * @note 单个操作失败只回滚它自己；COMMIT 失败则整批失败
+ */
+void Database::commit_batch(std::vector<WriteJob>& jobs) {
+    std::vector<std::exception_ptr> errors(jobs.size());
+    try {
+        db_->exec("BEGIN IMMEDIATE");
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            db_->exec("SAVEPOINT write_job");
+            try {
+                jobs[i].fn();
+                db_->exec("RELEASE write_job");
+            } catch (...) {
+                errors[i] = std::current_exception();
+                db_->exec("ROLLBACK TO write_job");
+                db_->exec("RELEASE write_job");
+            }
+        }
+        db_->exec("COMMIT");
+    } catch (...) {
+        auto err = std::current_exception();
+        try { db_->exec("ROLLBACK"); } catch (...) {}
+        for (auto& e : errors) {
+            if (!e) e = err;
+        }
+    }
+    write_jobs_ += jobs.size();
+    ++write_batches_;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (errors[i]) jobs[i].done.set_exception(errors[i]);
+        else jobs[i].done.set_value();
+    }
+}
+
+// ---- Maintenance ----
+
+long long Database::file_bytes() const {
+    long long total = 0;
+    for (const char* suffix : {"", "-wal"}) {
+        std::error_code ec;
+        auto n = std::filesystem::file_size(path_ + suffix, ec);
+        if (!ec) total += static_cast<long long>(n);
+    }
+    return total;
+}
+
+long long Database::pragma_int(const std::string& pragma) {
+    SQLite::Statement q(*db_, "PRAGMA " + pragma);
+    return q.executeStep() ? q.getColumn(0).getInt64() : 0;
+}
+
+/**
+ * @brief 分步执行 incremental_vacuum，将空闲页归还给文件系统
+ * @return 空闲页已处理完（或数据库未启用增量 auto-vacuum）返回 true，
+ *         截止时间已到且仍有空闲页时返回 false
+ */
+bool Database::vacuum_step(MaintenanceReport& r, Deadline deadline) {
+    constexpr int kPagesPerStep = 64;
+    long long free_pages = pragma_int("freelist_count");
+    while (free_pages > 0) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) break;
+        db_->exec(fmt::format("PRAGMA incremental_vacuum({})", kPagesPerStep));
+        long long left = pragma_int("freelist_count");
+        if (left >= free_pages) break;  // auto_vacuum is off: the pragma is a no-op
+        r.pages_vacuumed += static_cast<int>(free_pages - left);
+        free_pages = left;
+    }
+    r.free_pages_left = static_cast<int>(free_pages);
+    return free_pages == 0 || !deadline || std::chrono::steady_clock::now() < *deadline;
+}
+
+// Checkpoints the whole WAL and truncates it to zero bytes. Returns false if a
+// reader still needed the WAL when the busy timeout ran out.
+bool Database::truncate_wal(int busy_timeout_ms) {
+    db_->setBusyTimeout(busy_timeout_ms);
+    bool done = false;
+    try {
+        SQLite::Statement q(*db_, "PRAGMA wal_checkpoint(TRUNCATE)");
+        done = q.executeStep() && q.getColumn(0).getInt() == 0;
+    } catch (...) {
+        db_->setBusyTimeout(profile_.busy_timeout_ms);
+        throw;
+    }
+    db_->setBusyTimeout(profile_.busy_timeout_ms);
+    return done;
+}
+
+/**
+ * @brief 数据库维护：更新查询规划统计、回收空闲页、截断 WAL
+ * @param budget incremental_vacuum 的时间预算，0 表示不限
+ * @param full 对所有表执行 ANALYZE，并用一次 VACUUM 将旧数据库转换为增量 auto-vacuum
+ * @note 在写线程上执行，且不在批量事务内（VACUUM 与 checkpoint 不能在事务中运行）
+ */
+MaintenanceReport Database::maintain(std::chrono::milliseconds budget, bool full) {
+    if (!on_writer_thread()) {
+        MaintenanceReport r;
+        run_write([&] { r = maintain(budget, full); }, true);
+        return r;
+    }
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    Deadline deadline;
+    if (budget.count() > 0) deadline = start + budget;
+
+    MaintenanceReport r;
+    r.bytes_before = file_bytes();
+    if (full) {
+        if (pragma_int("auto_vacuum") != 2) {
+            // May renumber problems' rowids: nothing persistent refers to them
+            // (the full-text index is keyed by TID since schema 9)
+            db_->exec("PRAGMA auto_vacuum = INCREMENTAL;");
+            db_->exec("VACUUM;");
+            r.converted = true;
+        }
+        db_->exec("ANALYZE;");
+    } else {
+        // 0x10002: also consider tables this connection has not queried yet
+        db_->exec("PRAGMA optimize = 0x10002;");
+    }
+    last_optimize_ = Clock::now();
+    vacuum_step(r, deadline);
+    r.wal_truncated = truncate_wal(profile_.busy_timeout_ms);
+    r.bytes_after = file_bytes();
+    r.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return r;
+}
+
+/**
+ * @brief 写线程空闲时的一次短维护（约 20ms）
+ * @return 仍有空闲页待回收时返回 true，写线程会在下次空闲时继续
+ * @note 不等待读者：WAL 被占用时跳过截断；维护失败不影响后续写入
+ */
+bool Database::idle_maintenance() {
+    using Clock = std::chrono::steady_clock;
+    constexpr auto kBudget = std::chrono::milliseconds(20);
+    constexpr long long kFreePages = 256;        // Leave small freelists for reuse
+    constexpr long long kWalBytes = 16LL << 20;  // Beyond a few autocheckpoints' worth
+    constexpr auto kOptimizeEvery = std::chrono::hours(1);
+    try {
+        MaintenanceReport r;
+        bool more = false;
+        if (pragma_int("freelist_count") > kFreePages)
+            more = !vacuum_step(r, Clock::now() + kBudget);
+        std::error_code ec;
+        auto wal = std::filesystem::file_size(path_ + "-wal", ec);
+        if (!more && !ec && static_cast<long long>(wal) > kWalBytes) truncate_wal(0);
+        if (!more && Clock::now() - last_optimize_ > kOptimizeEvery) {
+            db_->exec("PRAGMA optimize;");
+            last_optimize_ = Clock::now();
+        }
+        return more;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// ---- Library archive ----
+
+namespace {
+
+// Archive row type, its table and the columns carried in the archive
+struct ArchiveTable {
+    const char* type;
+    const char* table;
+    std::vector<std::string> columns;
+};
+
+const ArchiveTable kArchiveProblems{"problem", "problems",
+    {"id", "source", "title", "url", "content_path", "description", "tags", "difficulty", "created_at",
+     "last_verdict", "pass_count", "total_count", "last_checked_at"}};
+
+// Exported right after their problem, in this order
+const std::vector<ArchiveTable> kArchiveChildren = {
+    {"test_case", "test_cases", {"problem_id", "input", "output", "is_sample"}},
+    {"review", "reviews", {"problem_id", "next_review", "interval", "ease_factor", "repetitions"}},
+    {"mistake", "mistakes", {"problem_id", "type", "description", "timestamp"}},
+    {"attempt", "attempts", {"problem_id", "timestamp", "verdict", "pass_count", "total_count",
+                             "max_time_ms", "max_memory_kb", "source_hash"}},
+};
+
+const std::vector<ArchiveTable> kArchiveMemory = {
+    {"memory_mistake", "memory_mistakes", {"tags", "pattern", "frequency", "last_seen", "example_id"}},
+    {"memory_mastery", "memory_mastery", {"skill", "confidence", "last_verified"}},
+    {"user_profile", "user_profile", {"elo_rating", "preferences"}},
+};
+
+std::string column_list(const std::vector<std::string>& columns) {
+    std::string out;
+    for (const auto& c : columns) out += (out.empty() ? "" : ", ") + c;
+    return out;
+}
+
+std::string insert_sql(const ArchiveTable& t, const std::string& suffix = "") {
+    std::string marks;
+    for (size_t i = 0; i < t.columns.size(); ++i) marks += i ? ", ?" : "?";
+    return fmt::format("INSERT INTO {} ({}) VALUES ({}){}", t.table, column_list(t.columns), marks, suffix);
+}
+
+void read_archive_row(SQLite::Statement& q, const ArchiveTable& t, ArchiveRow& row) {
+    row.type = t.type;
+    row.fields.clear();
+    for (int i = 0; i < static_cast<int>(t.columns.size()); ++i) {
+        auto c = q.getColumn(i);
+        ArchiveValue v;
+        switch (c.getType()) {
+            case SQLITE_INTEGER: v = static_cast<int64_t>(c.getInt64()); break;
+            case SQLITE_FLOAT:   v = c.getDouble(); break;
+            case SQLITE_NULL:    v = nullptr; break;
+            default:             v = c.getString(); break;
+        }
+        row.fields.emplace_back(t.columns[i], std::move(v));
+    }
+}
+
+void bind_archive_value(SQLite::Statement& q, int idx, const ArchiveValue* v) {
+    if (!v || std::holds_alternative<std::nullptr_t>(*v)) q.bind(idx);
+    else if (auto i = std::get_if<int64_t>(v)) q.bind(idx, *i);
+    else if (auto d = std::get_if<double>(v)) q.bind(idx, *d);
+    else q.bind(idx, std::get<std::string>(*v));
+}
+
+void bind_archive_row(SQLite::Statement& q, const ArchiveTable& t, const ArchiveRow& row) {
+    for (size_t i = 0; i < t.columns.size(); ++i)
+        bind_archive_value(q, static_cast<int>(i + 1), row.get(t.columns[i]));
+}
+
+std::string archive_text(const ArchiveRow& row, const std::string& column) {
+    auto v = row.get(column);
+    if (!v) return "";
+    if (auto str = std::get_if<std::string>(v)) return *str;
+    if (auto i = std::get_if<int64_t>(v)) return std::to_string(*i);
+    return "";
+}
+
+long long archive_int(const ArchiveRow& row, const std::string& column) {
+    auto v = row.get(column);
+    if (!v) return 0;
+    if (auto i = std::get_if<int64_t>(v)) return *i;
+    if (auto d = std::get_if<double>(v)) return static_cast<long long>(*d);
+    return 0;
+}
+
+} // namespace
+
+/**
+ * @brief 按归档顺序流式导出整个题库
+ * @note 使用独立的只读连接与一个读事务，导出内容来自同一快照；
+ *       逐行回调 sink，内存占用与题库大小无关
+ */
+ArchiveCounts Database::export_archive(const std::function<void(const ArchiveRow&)>& sink) {
+    SQLite::Database src(path_, SQLite::OPEN_READONLY);
+    src.setBusyTimeout(profile_.busy_timeout_ms);
+    src.exec("BEGIN");
+
+    ArchiveCounts counts;
+    long long* child_counts[] = {&counts.test_cases, &counts.reviews, &counts.mistakes, &counts.attempts};
+    std::vector<std::unique_ptr<SQLite::Statement>> children;
+    for (const auto& t : kArchiveChildren) {
+        // Indexed by problem_id; attempts in time order so rollups can be replayed
+        const char* order = std::string_view(t.type) == "attempt" ? "timestamp, id" : "rowid";
+        children.push_back(std::make_unique<SQLite::Statement>(
+            src, fmt::format("SELECT {} FROM {} WHERE problem_id = ? ORDER BY {}", column_list(t.columns), t.table, order)));
+    }
+
+    ArchiveRow row;
+    SQLite::Statement problems(src, fmt::format("SELECT {} FROM problems ORDER BY rowid", column_list(kArchiveProblems.columns)));
+    while (problems.executeStep()) {
+        std::string id = problems.getColumn(0).getString();
+        read_archive_row(problems, kArchiveProblems, row);
+        sink(row);
+        ++counts.problems;
+        for (size_t i = 0; i < children.size(); ++i) {
+            auto& q = *children[i];
+            q.bind(1, id);
+            while (q.executeStep()) {
+                read_archive_row(q, kArchiveChildren[i], row);
+                sink(row);
+                ++*child_counts[i];
+            }
+            q.reset();
+        }
+    }
+    for (const auto& t : kArchiveMemory) {
+        SQLite::Statement q(src, fmt::format("SELECT {} FROM {} ORDER BY rowid", column_list(t.columns), t.table));
+        while (q.executeStep()) {
+            read_archive_row(q, t, row);
+            sink(row);
+            ++counts.memory;
+        }
+    }
+    src.exec("COMMIT");
+    return counts;
+}
+
+void Database::import_archive(const std::vector<ArchiveRow>& batch, ConflictPolicy policy, ArchiveImportState& state) {
+    if (!on_writer_thread()) return run_write([&] { import_archive(batch, policy, state); });
+    for (const auto& row : batch) import_row(row, policy, state);
+}
+
+void Database::import_row(const ArchiveRow& row, ConflictPolicy policy, ArchiveImportState& state) {
+    auto& counts = state.counts;
+    if (row.type == kArchiveProblems.type) {
+        Problem p;
+        p.id = archive_text(row, "id");
+        p.source = archive_text(row, "source");
+        p.title = archive_text(row, "title");
+        p.url = archive_text(row, "url");
+        p.content_path = archive_text(row, "content_path");
+        p.description = archive_text(row, "description");
+        p.tags = archive_text(row, "tags");
+        p.difficulty = archive_text(row, "difficulty");
+        p.created_at = archive_int(row, "created_at");
+        p.last_verdict = archive_text(row, "last_verdict");
+        p.pass_count = static_cast<int>(archive_int(row, "pass_count"));
+        p.total_count = static_cast<int>(archive_int(row, "total_count"));
+        p.last_checked_at = archive_int(row, "last_checked_at");
+        state.problem_id = p.id;
+        state.accept_children = false;
+
+        // The same problem may exist under its id, under another id with the same url, or both
+        std::vector<std::string> existing;
+        {
+            auto q_stmt = cached_statement("SELECT id FROM problems WHERE id = ?1 OR (url = ?2 AND ?2 != '')");
+            auto& q = *q_stmt;
+            q.bind(1, p.id);
+            q.bind(2, p.url);
+            while (q.executeStep()) existing.push_back(q.getColumn(0).getString());
+        }
+        if (!existing.empty()) {
+            if (policy == ConflictPolicy::Fail)
+                throw std::runtime_error(fmt::format("导入冲突: 题目 {} 已存在", p.id));
+            if (policy == ConflictPolicy::Skip) {
+                ++counts.skipped;
+                return;
+            }
+            for (const auto& id : existing) {
+                for (const auto& t : kArchiveChildren) {
+                    auto d_stmt = cached_statement(fmt::format("DELETE FROM {} WHERE problem_id = ?", t.table));
+                    auto& d = *d_stmt;
+                    d.bind(1, id);
+                    d.exec();
+                }
+                if (id == p.id) continue;
+                // Stored under another id: the archive's id takes its place
+                auto d_stmt = cached_statement("DELETE FROM problems WHERE id = ?");
+                auto& d = *d_stmt;
+                d.bind(1, id);
+                d.exec();
+                forget_tid(id);
+                ++counts.rekeyed;
+            }
+        }
+        add_problem(p);
+        state.accept_children = true;
+        ++counts.problems;
+        return;
+    }
+
+    long long* child_counts[] = {&counts.test_cases, &counts.reviews, &counts.mistakes, &counts.attempts};
+    for (size_t i = 0; i < kArchiveChildren.size(); ++i) {
+        const auto& t = kArchiveChildren[i];
+        if (row.type != t.type) continue;
+        if (!state.accept_children || archive_text(row, "problem_id") != state.problem_id) {
+            ++counts.skipped;
+            return;
+        }
+        auto q_stmt = cached_statement(insert_sql(t));
+        auto& q = *q_stmt;
+        bind_archive_row(q, t, row);
+        q.exec();
+        ++*child_counts[i];
+        return;
+    }
+
+    if (row.type == "user_profile") {
+        // Always present locally: only a profile still at its defaults counts as free
+        auto q_stmt = cached_statement(
+            "UPDATE user_profile SET elo_rating = ?, preferences = ? "
+            "WHERE id = 1 AND (?3 OR (elo_rating = 1200 AND preferences = '{}'))");
+        auto& q = *q_stmt;
+        bind_archive_row(q, kArchiveMemory[2], row);
+        q.bind(3, policy == ConflictPolicy::Replace ? 1 : 0);
+        if (q.exec() > 0) {
+            ++counts.memory;
+        } else if (policy == ConflictPolicy::Fail) {
+            throw std::runtime_error("导入冲突: 本地用户档案已存在");
+        } else {
+            ++counts.skipped;
+        }
+        return;
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        const auto& t = kArchiveMemory[i];
+        if (row.type != t.type) continue;
+        // memory_mistakes is keyed by pattern, memory_mastery by skill
+        const std::string key = i == 0 ? "pattern" : "skill";
+        std::string suffix;
+        if (policy == ConflictPolicy::Skip) {
+            suffix = fmt::format(" ON CONFLICT({}) DO NOTHING", key);
+        } else if (policy == ConflictPolicy::Replace) {
+            suffix = fmt::format(" ON CONFLICT({}) DO UPDATE SET ", key);
+            bool first = true;
+            for (const auto& c : t.columns) {
+                if (c == key) continue;
+                suffix += fmt::format("{}{} = excluded.{}", first ? "" : ", ", c, c);
+                first = false;
+            }
+        }
+        auto q_stmt = cached_statement(insert_sql(t, suffix));
+        auto& q = *q_stmt;
+        bind_archive_row(q, t, row);
+        int changed = 0;
+        try {
+            changed = q.exec();
+        } catch (const SQLite::Exception& e) {
+            if (policy == ConflictPolicy::Fail)
+                throw std::runtime_error(fmt::format("导入冲突: {} {} 已存在", t.type, archive_text(row, key)));
+            throw;
+        }
+        if (changed > 0) ++counts.memory;
+        else ++counts.skipped;
+        return;
+    }
+    ++counts.skipped;  // Row type from a newer version
+}
+
+void Database::register_sql_functions(SQLite::Database& db) {
+    using SqlFunction = void (*)(sqlite3_context*, int, sqlite3_value**);
+    const std::pair<const char*, SqlFunction> functions[] = {
+        {"shuati_plaintext", sql_plaintext},
+        {"shuati_utf8_valid", sql_utf8_valid},
+        {"shuati_utf8_lossy", sql_utf8_lossy},
+        {"shuati_tag_list", sql_tag_list},
+    };
+    for (const auto& [name, fn] : functions) {
+        int rc = sqlite3_create_function_v2(db.getHandle(), name, 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                                            nullptr, fn, nullptr, nullptr, nullptr);
+        if (rc != SQLITE_OK) {
+            throw std::runtime_error(std::string("注册 SQL 函数失败: ") + sqlite3_errstr(rc));
+        }
+    }
+}
+
+/**
+ * @brief 将已有数据中的非法 UTF-8 替换为 '?'（迁移第 5 步）
+ * @note 旧版本在 Linux 上写入时不做校验。此步之后库中文本都是合法 UTF-8，
+ *       safe_column_text 读取时直接返回。每张表只扫描一遍；清洗后与已有
+ *       主键/唯一键冲突的行 (UPDATE OR IGNORE) 保持原样。
+ *       题目 ID 是外键引用的父键，不能逐表原地改写：先生成新旧 ID 对照，
+ *       在延迟外键检查下同时改写 problems.id 与所有引用它的列。
+ */
+void Database::init_text_encoding() {
+    // Reset at COMMIT/ROLLBACK; the constraints are checked once, after every column moved
+    db_->exec("PRAGMA defer_foreign_keys = ON");
+    db_->exec("DROP TABLE IF EXISTS temp.problem_rekey");
+    db_->exec("CREATE TEMP TABLE problem_rekey (old_id TEXT PRIMARY KEY, new_id TEXT NOT NULL UNIQUE)");
+    // A repaired id that is already taken, or shared by two bad ids, keeps its old bytes
+    db_->exec("INSERT OR IGNORE INTO temp.problem_rekey (old_id, new_id) "
+              "SELECT id, shuati_utf8_lossy(id) FROM problems "
+              "WHERE NOT shuati_utf8_valid(id) AND shuati_utf8_lossy(id) NOT IN (SELECT id FROM problems) "
+              "ORDER BY rowid");
+    // {table, column, one row per problem}
+    static const std::vector<std::tuple<std::string, std::string, bool>> key_columns = {
+        {"problems", "id", true},
+        {"test_cases", "problem_id", false},
+        {"reviews", "problem_id", true},
+        {"mistakes", "problem_id", false},
+        {"attempts", "problem_id", false},
+        {"attempt_problem_stats", "problem_id", true},
+        {"problem_tags", "problem_id", false},
+        {"memory_mistakes", "example_id", false},
+    };
+    for (const auto& [table, column, unique] : key_columns) {
+        if (!db_->tableExists(table)) continue;
+        // The new id names no problem, so a row already keyed by it is an orphan
+        if (unique && table != "problems") {
+            db_->exec(fmt::format("DELETE FROM {} WHERE {} IN (SELECT new_id FROM temp.problem_rekey)", table, column));
+        }
+        db_->exec(fmt::format(
+            "UPDATE {0} SET {1} = (SELECT new_id FROM temp.problem_rekey WHERE old_id = {0}.{1}) "
+            "WHERE {1} IN (SELECT old_id FROM temp.problem_rekey)", table, column));
+    }
+    db_->exec("DROP TABLE temp.problem_rekey");
+
+    // Everything else; key columns were handled above
+    static const std::vector<std::pair<std::string, std::vector<std::string>>> text_columns = {
+        {"problems", {"source", "title", "url", "content_path", "description", "tags", "difficulty",
+                      "last_verdict", "source_key"}},
+        {"test_cases", {"input", "output"}},
+        {"mistakes", {"type", "description"}},
+        {"attempts", {"verdict"}},
+        {"attempt_tag_weeks", {"tag"}},
+        {"problem_stats", {"key"}},
+        {"memory_mistakes", {"tags", "pattern"}},
+        {"memory_mastery", {"skill"}},
+        {"user_profile", {"preferences"}},
+    };
+    for (const auto& [table, columns] : text_columns) {
+        std::string set, valid;
+        for (const auto& c : columns) {
+            set += fmt::format("{}{} = shuati_utf8_lossy({})", set.empty() ? "" : ", ", c, c);
+            valid += fmt::format("{}shuati_utf8_valid({})", valid.empty() ? "" : " AND ", c);
+        }
+        db_->exec(fmt::format("UPDATE OR IGNORE {} SET {} WHERE NOT ({})", table, set, valid));
+    }
+}
+
+/**
+ * @brief 初始化 FTS5 全文索引（标题、标签、纯文本题面）
+ * @note 使用 trigram 分词器以支持中文子串检索；由触发器与 problems 表保持同步。
+ *       触发器只用内置 SQL，写入原始题面；纯文本由 init_fulltext_keys 重建。
+ *       SQLite 未编译 FTS5/trigram 时跳过（不创建表），search_problems 改用 LIKE 扫描。
+ */
+void Database::init_fulltext() {
+    try {
+        bool existed = db_->tableExists("problems_fts");
+        db_->exec("CREATE VIRTUAL TABLE IF NOT EXISTS problems_fts "
+                  "USING fts5(title, tags, body, tokenize='trigram')");
+        db_->exec(
+            "CREATE TRIGGER IF NOT EXISTS problems_fts_ai AFTER INSERT ON problems BEGIN "
+            "  INSERT INTO problems_fts(rowid, title, tags, body) "
+            "  VALUES (new.rowid, new.title, new.tags, new.description); "
+            "END");
+        db_->exec(
+            "CREATE TRIGGER IF NOT EXISTS problems_fts_ad AFTER DELETE ON problems BEGIN "
+            "  DELETE FROM problems_fts WHERE rowid = old.rowid; "
+            "END");
+        db_->exec(
+            "CREATE TRIGGER IF NOT EXISTS problems_fts_au AFTER UPDATE OF title, tags, description ON problems "
+            "WHEN old.title IS NOT new.title OR old.tags IS NOT new.tags OR old.description IS NOT new.description "
+            "BEGIN "
+            "  UPDATE problems_fts SET title = new.title, tags = new.tags, "
+            "    body = new.description WHERE rowid = old.rowid; "
+            "END");
+        if (!existed) {
+            db_->exec("INSERT INTO problems_fts(rowid, title, tags, body) "
+                      "SELECT rowid, title, tags, description FROM problems");
+        }
+    } catch (const std::exception&) {
+        // No FTS5 in this SQLite build: leave the index out
+    }
+}
+
+/**
+ * @brief 全文索引改以 TID 为键（迁移第 9 步）
+ * @note problems 没有 INTEGER PRIMARY KEY，VACUUM 可能重排 rowid，以 rowid
+ *       为键的索引会让搜索结果指向别的题目。TID 由 problems_tid_assign 在插入
+ *       之后写入，因此索引行在 tid 确定时写入：插入时已带 tid 的行由
+ *       problems_fts_ai 处理，其余由 problems_fts_tid 处理，与触发器的执行
+ *       顺序无关。重建索引内容一次。
+ *       触发器只用内置 SQL（写入原始 HTML 题面），sqlite3 命令行、旧版本等
+ *       未注册本程序函数的连接也能照常写 problems；本程序的写入随后由
+ *       index_plaintext 把题面换成纯文本（迁移第 10 步据此重建触发器）。
+ */
+void Database::init_fulltext_keys() {
+    if (!db_->tableExists("problems_fts")) return;
+    for (const char* t : {"problems_fts_ai", "problems_fts_ad", "problems_fts_au", "problems_fts_tid"}) {
+        db_->exec(fmt::format("DROP TRIGGER IF EXISTS {}", t));
+    }
+    db_->exec(
+        "CREATE TRIGGER problems_fts_ai AFTER INSERT ON problems WHEN new.tid IS NOT NULL BEGIN "
+        "  INSERT INTO problems_fts(rowid, title, tags, body) "
+        "  VALUES (new.tid, new.title, new.tags, new.description); "
+        "END");
+    db_->exec(
+        "CREATE TRIGGER problems_fts_tid AFTER UPDATE OF tid ON problems WHEN old.tid IS NOT new.tid BEGIN "
+        "  DELETE FROM problems_fts WHERE rowid = old.tid; "
+        "  INSERT INTO problems_fts(rowid, title, tags, body) "
+        "  SELECT new.tid, new.title, new.tags, new.description WHERE new.tid IS NOT NULL; "
+        "END");
+    db_->exec(
+        "CREATE TRIGGER problems_fts_ad AFTER DELETE ON problems BEGIN "
+        "  DELETE FROM problems_fts WHERE rowid = old.tid; "
+        "END");
+    db_->exec(
+        "CREATE TRIGGER problems_fts_au AFTER UPDATE OF title, tags, description ON problems "
+        "WHEN old.title IS NOT new.title OR old.tags IS NOT new.tags OR old.description IS NOT new.description "
+        "BEGIN "
+        "  UPDATE problems_fts SET title = new.title, tags = new.tags, "
+        "    body = new.description WHERE rowid = new.tid; "
+        "END");
+    db_->exec("DELETE FROM problems_fts");
+    SQLite::Statement rows(*db_, "SELECT tid, title, tags, description FROM problems WHERE tid IS NOT NULL");
+    SQLite::Statement insert(*db_, "INSERT INTO problems_fts(rowid, title, tags, body) VALUES (?, ?, ?, ?)");
+    while (rows.executeStep()) {
+        insert.bind(1, rows.getColumn(0).getInt64());
+        insert.bind(2, safe_column_text(rows.getColumn(1)));
+        insert.bind(3, safe_column_text(rows.getColumn(2)));
+        insert.bind(4, utils::html_to_plaintext(safe_column_text(rows.getColumn(3))));
+        insert.exec();
+        insert.reset();
+    }
+}
+
+/**
+ * @brief 把本程序写入的题面在全文索引中换成纯文本
+ * @note 触发器只能写入原始 HTML；纯文本与原文相同时不必再写一次。
+ */
+void Database::index_plaintext(const std::string& id, const std::string& description) {
+    if (!has_fulltext_index()) return;
+    std::string plain = utils::html_to_plaintext(description);
+    if (plain == description) return;
+    auto q_stmt = cached_statement("UPDATE problems_fts SET body = ?1 WHERE rowid = (SELECT tid FROM problems WHERE id = ?2)");
+    auto& q = *q_stmt;
+    q.bind(1, plain);
+    q.bind(2, id);
+    q.exec();
 }
 
 void Database::init_schema() {
@@ -95,8 +1142,15 @@ void Database::init_schema() {
         "  last_verdict TEXT DEFAULT '',"
         "  pass_count INTEGER DEFAULT 0,"
         "  total_count INTEGER DEFAULT 0,"
-        "  last_checked_at INTEGER DEFAULT 0"
+        "  last_checked_at INTEGER DEFAULT 0,"
+        "  source_key TEXT"
         ")");
+
+    // source_key = canonical_source(source), so source filters can use an index
+    if (!column_exists(*db_, "problems", "source_key")) {
+        db_->exec("ALTER TABLE problems ADD COLUMN source_key TEXT");
+        db_->exec("UPDATE problems SET source_key = " + source_key_sql("source"));
+    }
     
     // 清理旧schema的视图和触发器
     try {
@@ -186,9 +1240,15 @@ void Database::init_indexes() {
     try {
         db_->exec("CREATE UNIQUE INDEX IF NOT EXISTS idx_problems_url_uniq ON problems(url)");
     } catch (const std::exception&) {}
-    db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_created ON problems(created_at DESC)");
     db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_difficulty ON problems(difficulty)");
     db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_source ON problems(source)");
+    // 列表过滤/分页索引（见 query_problems）。created_at 使用升序：
+    // 索引隐含的 rowid 后缀也是升序，倒序扫描即得到 (created_at, rowid) DESC，无需临时排序。
+    db_->exec("DROP INDEX IF EXISTS idx_problems_created");  // 旧的 created_at DESC 索引
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_created_at ON problems(created_at)");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_filter "
+              "ON problems(last_verdict, difficulty, source_key, created_at)");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_problems_source_key ON problems(source_key, created_at)");
     
     // 复习查询优化索引
     db_->exec("CREATE INDEX IF NOT EXISTS idx_reviews_next ON reviews(next_review ASC)");
@@ -215,25 +1275,380 @@ void Database::init_indexes() {
     db_->exec("CREATE INDEX IF NOT EXISTS idx_memory_mistakes_freq ON memory_mistakes(frequency DESC, last_seen DESC)");
 }
 
+/**
+ * @brief 创建提交历史表（只追加）及其汇总表
+ * @note 汇总表由 record_attempt 增量维护。已有题目的最后一次测试结果作为
+ *       第一条历史记录导入，使统计在升级后不为空。
+ */
+void Database::init_attempts() {
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS attempts ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  problem_id TEXT NOT NULL,"
+        "  timestamp INTEGER NOT NULL,"
+        "  verdict TEXT NOT NULL,"
+        "  pass_count INTEGER DEFAULT 0,"
+        "  total_count INTEGER DEFAULT 0,"
+        "  max_time_ms INTEGER DEFAULT 0,"
+        "  max_memory_kb INTEGER DEFAULT 0,"
+        "  source_hash TEXT DEFAULT ''"
+        ")");
+    // 覆盖索引：单题耗时趋势与按时间窗口的统计都不回表
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_attempts_problem "
+              "ON attempts(problem_id, timestamp, verdict, max_time_ms, max_memory_kb)");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_attempts_timestamp ON attempts(timestamp, verdict)");
+
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS attempt_problem_stats ("
+        "  problem_id TEXT PRIMARY KEY,"
+        "  attempts INTEGER NOT NULL DEFAULT 0,"
+        "  accepted INTEGER NOT NULL DEFAULT 0,"
+        "  first_attempt_at INTEGER NOT NULL DEFAULT 0,"
+        "  last_attempt_at INTEGER NOT NULL DEFAULT 0,"
+        "  first_ac_at INTEGER NOT NULL DEFAULT 0,"
+        "  attempts_to_ac INTEGER NOT NULL DEFAULT 0,"
+        "  best_time_ms INTEGER NOT NULL DEFAULT 0"
+        ") WITHOUT ROWID");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_attempt_problem_stats_ac "
+              "ON attempt_problem_stats(first_ac_at) WHERE first_ac_at > 0");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS attempt_weeks ("
+        "  week_start INTEGER PRIMARY KEY,"
+        "  attempts INTEGER NOT NULL DEFAULT 0,"
+        "  accepted INTEGER NOT NULL DEFAULT 0,"
+        "  solved INTEGER NOT NULL DEFAULT 0"
+        ")");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS attempt_tag_weeks ("
+        "  tag TEXT NOT NULL,"
+        "  week_start INTEGER NOT NULL,"
+        "  attempts INTEGER NOT NULL DEFAULT 0,"
+        "  accepted INTEGER NOT NULL DEFAULT 0,"
+        "  solved INTEGER NOT NULL DEFAULT 0,"
+        "  PRIMARY KEY (tag, week_start)"
+        ") WITHOUT ROWID");
+
+    db_->exec(
+        "INSERT INTO attempts (problem_id,timestamp,verdict,pass_count,total_count) "
+        "SELECT id, last_checked_at, last_verdict, pass_count, total_count FROM problems "
+        "WHERE last_checked_at > 0 AND last_verdict IS NOT NULL AND last_verdict <> '' "
+        "AND NOT EXISTS (SELECT 1 FROM attempts) ORDER BY last_checked_at");
+    recompute_attempt_rollups();
+}
+
+/**
+ * @brief 创建由触发器维护的统计表
+ * @note problem_stats 按 (维度, 值) 计数题目：total、source（source_key）、
+ *       difficulty、verdict（last_verdict）；review_due_days 按 next_review 所在的
+ *       UTC 日期计数复习项。所有写入都经过触发器，不依赖调用方。
+ */
+void Database::init_stats() {
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS problem_stats ("
+        "  dimension TEXT NOT NULL,"
+        "  key TEXT NOT NULL,"
+        "  count INTEGER NOT NULL DEFAULT 0,"
+        "  PRIMARY KEY (dimension, key)"
+        ") WITHOUT ROWID");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS review_due_days ("
+        "  day INTEGER PRIMARY KEY,"
+        "  count INTEGER NOT NULL DEFAULT 0"
+        ")");
+
+    // 计数归零的行随即删除，表的大小只取决于不同取值的个数
+    static const char* kAddProblem =
+        "INSERT INTO problem_stats (dimension, key, count) VALUES "
+        "('source', COALESCE(new.source_key, ''), 1), "
+        "('difficulty', COALESCE(new.difficulty, ''), 1), "
+        "('verdict', COALESCE(new.last_verdict, ''), 1) "
+        "ON CONFLICT(dimension, key) DO UPDATE SET count = count + 1;";
+    static const char* kRemoveProblem =
+        "UPDATE problem_stats SET count = count - 1 WHERE (dimension, key) IN (VALUES "
+        "('source', COALESCE(old.source_key, '')), "
+        "('difficulty', COALESCE(old.difficulty, '')), "
+        "('verdict', COALESCE(old.last_verdict, ''))); "
+        "DELETE FROM problem_stats WHERE count <= 0;";
+    db_->exec(fmt::format(
+        "CREATE TRIGGER IF NOT EXISTS problem_stats_ai AFTER INSERT ON problems BEGIN "
+        "  INSERT INTO problem_stats (dimension, key, count) VALUES ('total', '', 1) "
+        "  ON CONFLICT(dimension, key) DO UPDATE SET count = count + 1; {} "
+        "END", kAddProblem));
+    db_->exec(fmt::format(
+        "CREATE TRIGGER IF NOT EXISTS problem_stats_ad AFTER DELETE ON problems BEGIN "
+        "  UPDATE problem_stats SET count = count - 1 WHERE dimension = 'total'; {} "
+        "END", kRemoveProblem));
+    db_->exec(fmt::format(
+        "CREATE TRIGGER IF NOT EXISTS problem_stats_au AFTER UPDATE OF source_key, difficulty, last_verdict "
+        "ON problems WHEN old.source_key IS NOT new.source_key OR old.difficulty IS NOT new.difficulty "
+        "OR old.last_verdict IS NOT new.last_verdict BEGIN {} {} END", kRemoveProblem, kAddProblem));
+
+    static const char* kAddReview =
+        "INSERT INTO review_due_days (day, count) VALUES (COALESCE(new.next_review, 0) / 86400, 1) "
+        "ON CONFLICT(day) DO UPDATE SET count = count + 1;";
+    static const char* kRemoveReview =
+        "UPDATE review_due_days SET count = count - 1 WHERE day = COALESCE(old.next_review, 0) / 86400; "
+        "DELETE FROM review_due_days WHERE day = COALESCE(old.next_review, 0) / 86400 AND count <= 0;";
+    db_->exec(fmt::format("CREATE TRIGGER IF NOT EXISTS review_due_days_ai AFTER INSERT ON reviews BEGIN {} END",
+                          kAddReview));
+    db_->exec(fmt::format("CREATE TRIGGER IF NOT EXISTS review_due_days_ad AFTER DELETE ON reviews BEGIN {} END",
+                          kRemoveReview));
+    db_->exec(fmt::format(
+        "CREATE TRIGGER IF NOT EXISTS review_due_days_au AFTER UPDATE OF next_review ON reviews "
+        "WHEN old.next_review IS NOT new.next_review BEGIN {} {} END", kRemoveReview, kAddReview));
+
+    // 回填现有数据
+    db_->exec("DELETE FROM problem_stats");
+    db_->exec(
+        "INSERT INTO problem_stats (dimension, key, count) "
+        "SELECT 'total', '', COUNT(*) FROM problems "
+        "UNION ALL SELECT 'source', COALESCE(source_key, ''), COUNT(*) FROM problems GROUP BY 2 "
+        "UNION ALL SELECT 'difficulty', COALESCE(difficulty, ''), COUNT(*) FROM problems GROUP BY 2 "
+        "UNION ALL SELECT 'verdict', COALESCE(last_verdict, ''), COUNT(*) FROM problems GROUP BY 2");
+    db_->exec("DELETE FROM review_due_days");
+    db_->exec("INSERT INTO review_due_days (day, count) "
+              "SELECT COALESCE(next_review, 0) / 86400, COUNT(*) FROM reviews GROUP BY 1");
+}
+
+/**
+ * @brief 为题目分配稳定编号 tid（迁移第 6 步）
+ * @note 此前 TID 就是 rowid：删除后编号会被复用，VACUUM 也可能重排。
+ *       现有题目保留原编号 (tid = rowid)；之后由 tid_allocator 单调递增分配，
+ *       删除的编号不再复用。add_problem 在 INSERT 中直接取号；
+ *       未指定 tid 的其他 INSERT 由触发器补上。
+ */
+void Database::init_tids() {
+    if (!column_exists(*db_, "problems", "tid")) {
+        db_->exec("ALTER TABLE problems ADD COLUMN tid INTEGER");
+    }
+    db_->exec("UPDATE problems SET tid = rowid WHERE tid IS NULL");
+    db_->exec("CREATE UNIQUE INDEX IF NOT EXISTS idx_problems_tid ON problems(tid)");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS tid_allocator ("
+        "  id INTEGER PRIMARY KEY CHECK (id = 1),"
+        "  next_tid INTEGER NOT NULL"
+        ")");
+    db_->exec("INSERT OR IGNORE INTO tid_allocator (id, next_tid) "
+              "SELECT 1, COALESCE(MAX(tid), 0) + 1 FROM problems");
+    db_->exec(
+        "CREATE TRIGGER IF NOT EXISTS problems_tid_ai AFTER INSERT ON problems WHEN new.tid IS NOT NULL BEGIN "
+        "  UPDATE tid_allocator SET next_tid = MAX(next_tid, new.tid + 1) WHERE id = 1; "
+        "END");
+    db_->exec(
+        "CREATE TRIGGER IF NOT EXISTS problems_tid_assign AFTER INSERT ON problems WHEN new.tid IS NULL BEGIN "
+        "  UPDATE problems SET tid = (SELECT next_tid FROM tid_allocator WHERE id = 1) WHERE rowid = new.rowid; "
+        "  UPDATE tid_allocator SET next_tid = next_tid + 1 WHERE id = 1; "
+        "END");
+}
+
+/**
+ * @brief 子表外键改为 ON DELETE CASCADE（迁移第 7 步）
+ * @note SQLite 不能修改已有外键，只能重建表：新建、复制、删除旧表、改名。
+ *       已经指向不存在题目的孤儿行不会复制。DROP TABLE 会带走表上的
+ *       索引和触发器，所以重建后重新创建索引，并重跑 init_stats
+ *       恢复复习计数的触发器和数据。
+ */
+void Database::init_cascades() {
+    struct ChildTable {
+        const char* name;
+        const char* columns;
+    };
+    static const ChildTable kChildren[] = {
+        {"mistakes",
+         "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "  problem_id TEXT,"
+         "  type TEXT,"
+         "  description TEXT,"
+         "  timestamp INTEGER,"},
+        {"reviews",
+         "  problem_id TEXT PRIMARY KEY,"
+         "  next_review INTEGER,"
+         "  interval INTEGER DEFAULT 1,"
+         "  ease_factor REAL DEFAULT 2.5,"
+         "  repetitions INTEGER DEFAULT 0,"},
+        {"test_cases",
+         "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "  problem_id TEXT NOT NULL,"
+         "  input TEXT,"
+         "  output TEXT,"
+         "  is_sample INTEGER DEFAULT 1,"},
+    };
+    bool rebuilt = false;
+    for (const auto& t : kChildren) {
+        {
+            SQLite::Statement q(*db_, "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = ?");
+            q.bind(1, t.name);
+            if (q.executeStep() && q.getColumn(0).getString().find("ON DELETE CASCADE") != std::string::npos)
+                continue;
+        }
+        db_->exec(fmt::format(
+            "CREATE TABLE {0}_new ({1}"
+            "  FOREIGN KEY(problem_id) REFERENCES problems(id) ON DELETE CASCADE"
+            ")", t.name, t.columns));
+        db_->exec(fmt::format(
+            "INSERT INTO {0}_new SELECT * FROM {0} "
+            "WHERE problem_id IS NULL OR problem_id IN (SELECT id FROM problems)", t.name));
+        db_->exec(fmt::format("DROP TABLE {}", t.name));
+        db_->exec(fmt::format("ALTER TABLE {0}_new RENAME TO {0}", t.name));
+        rebuilt = true;
+    }
+    if (!rebuilt) return;
+    init_indexes();
+    init_stats();
+}
+
+// `row` is new, old or a table alias. attempted/solved follow the list
+// filters ("unaudited" = '' or SKIPPED)
+static std::string tag_attempted_sql(const char* row) {
+    return fmt::format("(COALESCE({}.last_verdict, '') NOT IN ('', 'SKIPPED'))", row);
+}
+
+static std::string tag_solved_sql(const char* row) {
+    return fmt::format("(COALESCE({}.last_verdict, '') = 'AC')", row);
+}
+
+// Adds (op "+") or removes (op "-") `row` from the counters of its linked tags
+static std::string tag_counters_sql(const char* row, const char* op) {
+    return fmt::format("UPDATE tags SET problems = problems {1} 1, attempted = attempted {1} {2}, "
+                       "solved = solved {1} {3} "
+                       "WHERE id IN (SELECT tag_id FROM problem_tags WHERE problem_id = {0}.id);",
+                       row, op, tag_attempted_sql(row), tag_solved_sql(row));
+}
+
+static std::string tag_unlink_sql() {
+    return tag_counters_sql("old", "-") + " DELETE FROM problem_tags WHERE problem_id = old.id;";
+}
+
+/**
+ * @brief 将逗号分隔的标签拆分为关系表（迁移第 8 步）
+ * @note tags 每个标签一行，并带有按题目最后结果维护的计数
+ *       (problems / attempted / solved)；problem_tags 与 memory_mistake_tags
+ *       是链接表。problems.tags 与 memory_mistakes.tags 仍是原始文本，
+ *       链接和计数都由触发器跟随维护，其他写入方无需改动（见
+ *       init_tag_triggers）。按标签的统计只读 tags 表，按标签筛题走
+ *       (tag_id, problem_id) 主键。
+ */
+void Database::init_tags() {
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS tags ("
+        "  id INTEGER PRIMARY KEY,"
+        "  name TEXT NOT NULL UNIQUE,"
+        "  problems INTEGER NOT NULL DEFAULT 0,"
+        "  attempted INTEGER NOT NULL DEFAULT 0,"
+        "  solved INTEGER NOT NULL DEFAULT 0"
+        ")");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS problem_tags ("
+        "  tag_id INTEGER NOT NULL REFERENCES tags(id),"
+        "  problem_id TEXT NOT NULL REFERENCES problems(id) ON DELETE CASCADE,"
+        "  PRIMARY KEY (tag_id, problem_id)"
+        ") WITHOUT ROWID");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_problem_tags_problem ON problem_tags(problem_id)");
+    db_->exec(
+        "CREATE TABLE IF NOT EXISTS memory_mistake_tags ("
+        "  tag_id INTEGER NOT NULL REFERENCES tags(id),"
+        "  mistake_id INTEGER NOT NULL REFERENCES memory_mistakes(id) ON DELETE CASCADE,"
+        "  PRIMARY KEY (tag_id, mistake_id)"
+        ") WITHOUT ROWID");
+    db_->exec("CREATE INDEX IF NOT EXISTS idx_memory_mistake_tags_mistake ON memory_mistake_tags(mistake_id)");
+
+    init_tag_triggers();
+    // BEFORE: the counters need the row's verdict; the cascade then finds nothing left
+    db_->exec(fmt::format("CREATE TRIGGER IF NOT EXISTS problem_tags_bd BEFORE DELETE ON problems BEGIN {} END",
+                          tag_unlink_sql()));
+    // Verdict changes with the tags unchanged (record_attempt); otherwise problem_tags_au covers it
+    db_->exec(fmt::format(
+        "CREATE TRIGGER IF NOT EXISTS problem_tags_verdict_au AFTER UPDATE OF last_verdict ON problems "
+        "WHEN old.tags IS new.tags AND ({0} IS NOT {1} OR {2} IS NOT {3}) BEGIN "
+        "  UPDATE tags SET attempted = attempted + {1} - {0}, solved = solved + {3} - {2} "
+        "  WHERE id IN (SELECT tag_id FROM problem_tags WHERE problem_id = new.id); "
+        "END", tag_attempted_sql("old"), tag_attempted_sql("new"), tag_solved_sql("old"), tag_solved_sql("new")));
+
+    // 回填现有数据（重复执行时整体重建，tags 的 id 保持不变）
+    db_->exec("DELETE FROM problem_tags");
+    db_->exec("DELETE FROM memory_mistake_tags");
+    db_->exec("INSERT OR IGNORE INTO tags (name) "
+              "SELECT j.value FROM problems p, json_each(shuati_tag_list(p.tags)) j "
+              "UNION ALL SELECT j.value FROM memory_mistakes m, json_each(shuati_tag_list(m.tags)) j");
+    db_->exec("INSERT OR IGNORE INTO problem_tags (tag_id, problem_id) "
+              "SELECT t.id, p.id FROM problems p, json_each(shuati_tag_list(p.tags)) j JOIN tags t ON t.name = j.value");
+    db_->exec("INSERT OR IGNORE INTO memory_mistake_tags (tag_id, mistake_id) "
+              "SELECT t.id, m.id FROM memory_mistakes m, json_each(shuati_tag_list(m.tags)) j "
+              "JOIN tags t ON t.name = j.value");
+    db_->exec(fmt::format(
+        "UPDATE tags SET (problems, attempted, solved) = ("
+        "  SELECT COUNT(*), COALESCE(SUM({}), 0), COALESCE(SUM({}), 0) FROM problem_tags pt "
+        "  JOIN problems p ON p.id = pt.problem_id WHERE pt.tag_id = tags.id)",
+        tag_attempted_sql("p"), tag_solved_sql("p")));
+}
+
+/**
+ * @brief 创建随 tags 文本维护链接的触发器（迁移第 11 步重建）
+ * @note 拆分标签用内置 SQL 的递归 CTE，与 split_tags 规则一致（逗号分隔、
+ *       去除首尾空白、丢弃空项，重复项由主键去重），因此 sqlite3 命令行、
+ *       旧版本等未注册本程序函数的连接也能照常写 problems 与 memory_mistakes。
+ */
+void Database::init_tag_triggers() {
+    // Each tag of `tags` as a row of column `tag`
+    auto tag_rows = [](const char* tags) {
+        return fmt::format(
+            "WITH RECURSIVE split(rest, tag) AS ("
+            "  SELECT COALESCE({}, '') || ',', NULL"
+            "  UNION ALL SELECT substr(rest, instr(rest, ',') + 1),"
+            "    trim(substr(rest, 1, instr(rest, ',') - 1), ' ' || char(9) || char(10) || char(13))"
+            "  FROM split WHERE rest != ''"
+            ") SELECT tag FROM split WHERE tag != ''", tags);
+    };
+    auto link = [&](const char* table, const char* column) {
+        return fmt::format("INSERT OR IGNORE INTO tags (name) {0}; "
+                           "INSERT OR IGNORE INTO {1} (tag_id, {2}) "
+                           "  SELECT id, new.id FROM tags WHERE name IN ({0});",
+                           tag_rows("new.tags"), table, column);
+    };
+
+    for (const char* t : {"problem_tags_ai", "problem_tags_au", "memory_mistake_tags_ai", "memory_mistake_tags_au"}) {
+        db_->exec(fmt::format("DROP TRIGGER IF EXISTS {}", t));
+    }
+    const std::string problem_link = link("problem_tags", "problem_id") + " " + tag_counters_sql("new", "+");
+    db_->exec(fmt::format("CREATE TRIGGER problem_tags_ai AFTER INSERT ON problems BEGIN {} END", problem_link));
+    db_->exec(fmt::format(
+        "CREATE TRIGGER problem_tags_au AFTER UPDATE OF tags ON problems "
+        "WHEN old.tags IS NOT new.tags BEGIN {} {} END", tag_unlink_sql(), problem_link));
+    const std::string memory_link = link("memory_mistake_tags", "mistake_id");
+    db_->exec(fmt::format("CREATE TRIGGER memory_mistake_tags_ai AFTER INSERT ON memory_mistakes "
+                          "BEGIN {} END", memory_link));
+    db_->exec(fmt::format(
+        "CREATE TRIGGER memory_mistake_tags_au AFTER UPDATE OF tags ON memory_mistakes "
+        "WHEN old.tags IS NOT new.tags BEGIN DELETE FROM memory_mistake_tags WHERE mistake_id = old.id; {} END",
+        memory_link));
+}
+
 // ---- Problem CRUD Operations ----
 
 void Database::add_problem(const Problem& p) {
-    SQLite::Statement q(*db_,
+    if (!on_writer_thread()) return run_write([&] { add_problem(p); });
+    static const std::string sql =
         "INSERT INTO problems (id,source,title,url,content_path,description,tags,difficulty,created_at,"
-        "last_verdict,pass_count,total_count,last_checked_at) "
-        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13) "
+        "last_verdict,pass_count,total_count,last_checked_at,source_key,tid) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, " + source_key_sql("?2") + ", "
+        "(SELECT next_tid FROM tid_allocator WHERE id = 1)) "
         "ON CONFLICT(id) DO UPDATE SET "
         "source=excluded.source, title=excluded.title, url=excluded.url, "
         "content_path=excluded.content_path, description=excluded.description, "
         "tags=excluded.tags, difficulty=excluded.difficulty, "
         "created_at=excluded.created_at, last_verdict=excluded.last_verdict, "
-        "pass_count=excluded.pass_count, total_count=excluded.total_count, last_checked_at=excluded.last_checked_at");
-    q.bind(1, ensure_utf8_lossy(p.id));
+        "pass_count=excluded.pass_count, total_count=excluded.total_count, last_checked_at=excluded.last_checked_at, "
+        "source_key=excluded.source_key";
+    auto q_stmt = cached_statement(sql);
+    auto& q = *q_stmt;
+    const std::string id = ensure_utf8_lossy(p.id);
+    const std::string description = ensure_utf8_lossy(p.description);
+    q.bind(1, id);
     q.bind(2, ensure_utf8_lossy(p.source));
     q.bind(3, ensure_utf8_lossy(p.title));
     q.bind(4, ensure_utf8_lossy(p.url));
     q.bind(5, ensure_utf8_lossy(p.content_path));
-    q.bind(6, ensure_utf8_lossy(p.description));
+    q.bind(6, description);
     q.bind(7, ensure_utf8_lossy(p.tags));
     q.bind(8, ensure_utf8_lossy(p.difficulty));
     q.bind(9, static_cast<int64_t>(p.created_at ? p.created_at : std::time(nullptr)));
@@ -242,10 +1657,27 @@ void Database::add_problem(const Problem& p) {
     q.bind(12, p.total_count);
     q.bind(13, static_cast<int64_t>(p.last_checked_at));
     q.exec();
+    index_plaintext(id, description);
+    // An insert (as opposed to an update) gets a new TID; drop any entry cached
+    // for this id before another process deleted it
+    forget_tid(p.id);
+}
+
+void Database::add_problem_with_cases(const Problem& p, const std::vector<TestCase>& cases,
+                                      const std::optional<ReviewItem>& review) {
+    if (!on_writer_thread()) return run_write([&] { add_problem_with_cases(p, cases, review); });
+    // Runs as one write job, so it commits (or rolls back) as a unit; the
+    // cached INSERT is reused for every case
+    add_problem(p);
+    for (const auto& tc : cases) {
+        add_test_case(p.id, tc.input, tc.output, tc.is_sample);
+    }
+    if (review) upsert_review(*review);
 }
 
 bool Database::problem_exists(const std::string& url) {
-    SQLite::Statement q(*db_, "SELECT 1 FROM problems WHERE url=? LIMIT 1");
+    auto q_stmt = cached_statement("SELECT 1 FROM problems WHERE url=? LIMIT 1");
+    auto& q = *q_stmt;
     q.bind(1, url);
     return q.executeStep();
 }
@@ -254,21 +1686,161 @@ std::vector<Problem> Database::get_all_problems() {
     std::vector<Problem> out;
     out.reserve(100); // 预分配空间优化
     
-    SQLite::Statement q(*db_, 
-        "SELECT rowid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
+    auto q_stmt = cached_statement(
+        "SELECT tid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
         "last_verdict, pass_count, total_count, last_checked_at "
         "FROM problems ORDER BY created_at DESC");
+    auto& q = *q_stmt;
     while (q.executeStep()) {
         out.push_back(fill_problem_from_row(q));
     }
     return out;
 }
 
+std::vector<ProblemSummary> Database::get_problem_summaries() {
+    std::vector<ProblemSummary> out;
+    out.reserve(100);
+
+    auto q_stmt = cached_statement(
+        fmt::format("SELECT {} FROM problems p ORDER BY p.created_at DESC", kSummaryColumns));
+    auto& q = *q_stmt;
+    while (q.executeStep()) {
+        out.push_back(fill_summary_from_row(q));
+    }
+    return out;
+}
+
+std::optional<ProblemSummary> Database::get_problem_summary_by_display_id(int tid) {
+    auto q_stmt = cached_statement(fmt::format("SELECT {} FROM problems p WHERE p.tid = ? LIMIT 1", kSummaryColumns));
+    auto& q = *q_stmt;
+    q.bind(1, tid);
+    if (q.executeStep()) return fill_summary_from_row(q);
+    return std::nullopt;
+}
+
+ProblemPage Database::query_problems(const ProblemQuery& query) {
+    // Paging through a common tag: walking created_at reads about
+    // total * rows / tagged problems rows, each cheaper than a joined row that
+    // has to be sorted. A rare tag is joined from its links.
+    bool tag_walk = false;
+    if (!query.tag.empty() && query.limit > 0) {
+        auto c_stmt = cached_statement(
+            "SELECT (SELECT problems FROM tags WHERE name = ?), "
+            "(SELECT count FROM problem_stats WHERE dimension = 'total')");
+        auto& c = *c_stmt;
+        c.bind(1, ensure_utf8_lossy(shuati::utils::trim(query.tag)));
+        if (c.executeStep()) {
+            double tagged = c.getColumn(0).getDouble(), total = c.getColumn(1).getDouble();
+            double rows = static_cast<double>(query.limit) + query.offset + 1;
+            tag_walk = tagged > 0 && 2 * total * rows < 5 * tagged * tagged;
+        }
+    }
+    // The due flag is one primary-key probe per returned row, so a page never
+    // reads more of reviews than its own rows
+    std::vector<SqlArg> args{static_cast<int64_t>(query.now ? query.now : std::time(nullptr))};
+    // rowid (column 13) only feeds the cursor
+    std::string sql = fmt::format(
+        "SELECT {}, p.rowid, "
+        "EXISTS (SELECT 1 FROM reviews rv WHERE rv.problem_id = p.id AND rv.next_review <= ?){} "
+        "ORDER BY p.created_at DESC, p.rowid DESC",
+        kSummaryColumns, problem_filter_sql(query, args, true, tag_walk));
+    // One extra row tells us whether another page follows
+    if (query.limit > 0) {
+        sql += " LIMIT ?";
+        args.emplace_back(static_cast<int64_t>(query.limit) + 1);
+        if (query.offset > 0) {
+            sql += " OFFSET ?";
+            args.emplace_back(static_cast<int64_t>(query.offset));
+        }
+    }
+
+    auto q_stmt = cached_statement(sql);
+    auto& q = *q_stmt;
+    bind_args(q, args);
+
+    ProblemPage page;
+    if (query.limit > 0) page.rows.reserve(query.limit);
+    long long last_rowid = 0;
+    while (q.executeStep()) {
+        if (query.limit > 0 && static_cast<int>(page.rows.size()) == query.limit) {
+            page.next = ProblemCursor{page.rows.back().created_at, last_rowid};
+            break;
+        }
+        page.rows.push_back(fill_summary_from_row(q));
+        page.rows.back().review_due = q.getColumn(14).getInt() != 0;
+        last_rowid = q.getColumn(13).getInt64();
+    }
+    return page;
+}
+
+std::vector<ProblemSearchHit> Database::search_problems(const std::string& query, int limit) {
+    std::vector<std::string> terms;
+    std::istringstream iss(query);
+    for (std::string t; iss >> t;) terms.push_back(t);
+    if (terms.empty()) return {};
+
+    // Trigram MATCH needs at least three characters per term
+    bool fts = has_fulltext_index();
+    bool use_match = fts && std::all_of(terms.begin(), terms.end(),
+        [](const std::string& t) { return utf8_length(t) >= 3; });
+
+    std::vector<SqlArg> args;
+    std::string sql;
+    if (use_match) {
+        std::string expr;
+        for (const auto& t : terms) {
+            std::string quoted;
+            for (char c : t) quoted += (c == '"') ? std::string("\"\"") : std::string(1, c);
+            expr += (expr.empty() ? "\"" : " \"") + quoted + "\"";
+        }
+        // Title hits weigh most, then tags, then the statement
+        sql = fmt::format(
+            "SELECT {}, snippet(problems_fts, 2, '[', ']', '...', 12), bm25(problems_fts, 10.0, 5.0, 1.0) AS score "
+            "FROM problems_fts JOIN problems p ON p.tid = problems_fts.rowid "
+            "WHERE problems_fts MATCH ? ORDER BY score LIMIT ?", kSummaryColumns);
+        args.emplace_back(expr);
+    } else {
+        std::string body = fts ? "f.body" : "p.description";
+        sql = fmt::format("SELECT {}, '', 0 FROM problems p", kSummaryColumns);
+        if (fts) sql += " JOIN problems_fts f ON f.rowid = p.tid";
+        sql += " WHERE 1=1";
+        for (const auto& t : terms) {
+            sql += fmt::format(" AND (p.title LIKE ? ESCAPE '\\' OR p.tags LIKE ? ESCAPE '\\' OR {} LIKE ? ESCAPE '\\')", body);
+            for (int i = 0; i < 3; ++i) args.emplace_back(like_pattern(t));
+        }
+        sql += " ORDER BY (p.title LIKE ? ESCAPE '\\') DESC, p.created_at DESC LIMIT ?";
+        args.emplace_back(like_pattern(terms.front()));
+    }
+    args.emplace_back(static_cast<int64_t>(limit > 0 ? limit : -1));
+
+    auto q_stmt = cached_statement(sql);
+    auto& q = *q_stmt;
+    bind_args(q, args);
+    std::vector<ProblemSearchHit> hits;
+    while (q.executeStep()) {
+        ProblemSearchHit hit;
+        hit.problem = fill_summary_from_row(q);
+        hit.snippet = safe_column_text(q.getColumn(13));
+        hit.score = q.getColumn(14).getDouble();
+        hits.push_back(std::move(hit));
+    }
+    return hits;
+}
+
+int Database::count_problems(const ProblemQuery& query) {
+    std::vector<SqlArg> args;
+    auto q_stmt = cached_statement("SELECT count(*)" + problem_filter_sql(query, args, false));
+    auto& q = *q_stmt;
+    bind_args(q, args);
+    return q.executeStep() ? q.getColumn(0).getInt() : 0;
+}
+
 Problem Database::get_problem(const std::string& id) {
-    SQLite::Statement q(*db_, 
-        "SELECT rowid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
+    auto q_stmt = cached_statement(
+        "SELECT tid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
         "last_verdict, pass_count, total_count, last_checked_at "
         "FROM problems WHERE id=? LIMIT 1");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(id));
     if (q.executeStep()) {
         return fill_problem_from_row(q);
@@ -277,10 +1849,11 @@ Problem Database::get_problem(const std::string& id) {
 }
 
 Problem Database::get_problem_by_display_id(int tid) {
-    SQLite::Statement q(*db_, 
-        "SELECT rowid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
+    auto q_stmt = cached_statement(
+        "SELECT tid, id,source,title,url,content_path,description,tags,difficulty,created_at, "
         "last_verdict, pass_count, total_count, last_checked_at "
-        "FROM problems WHERE rowid=? LIMIT 1");
+        "FROM problems WHERE tid=? LIMIT 1");
+    auto& q = *q_stmt;
     q.bind(1, tid);
     if (q.executeStep()) {
         return fill_problem_from_row(q);
@@ -288,49 +1861,108 @@ Problem Database::get_problem_by_display_id(int tid) {
     return {};
 }
 
-void Database::delete_problem(int tid) {
-    // Get UUID first to delete related records
-    std::string uuid;
+void Database::load_tid_map() {
+    std::call_once(tid_map_once_, [this] {
+        auto q_stmt = cached_statement("SELECT tid, id FROM problems WHERE tid IS NOT NULL");
+        auto& q = *q_stmt;
+        std::unique_lock lock(tid_map_mtx_);
+        while (q.executeStep()) {
+            int t = q.getColumn(0).getInt();
+            std::string id = safe_column_text(q.getColumn(1));
+            tid_by_id_.emplace(id, t);
+            id_by_tid_.emplace(t, std::move(id));
+        }
+    });
+}
+
+std::string Database::problem_id_for_tid(int tid) {
+    load_tid_map();
     {
-        SQLite::Statement q(*db_, "SELECT id FROM problems WHERE rowid=? LIMIT 1");
-        q.bind(1, tid);
-        if (q.executeStep()) uuid = safe_column_text(q.getColumn(0));
+        std::shared_lock lock(tid_map_mtx_);
+        if (auto it = id_by_tid_.find(tid); it != id_by_tid_.end()) return it->second;
     }
-    
-    if (uuid.empty()) return;
+    // Added since the map was loaded, possibly by another process
+    auto q_stmt = cached_statement("SELECT id FROM problems WHERE tid=? LIMIT 1");
+    auto& q = *q_stmt;
+    q.bind(1, tid);
+    if (!q.executeStep()) return {};
+    std::string id = safe_column_text(q.getColumn(0));
+    std::unique_lock lock(tid_map_mtx_);
+    tid_by_id_[id] = tid;
+    id_by_tid_[tid] = id;
+    return id;
+}
 
-    db_->exec("BEGIN TRANSACTION");
-    try {
-        // 使用参数化查询批量删除相关记录
-        SQLite::Statement q1(*db_, "DELETE FROM mistakes WHERE problem_id=?"); 
-        q1.bind(1, uuid); 
-        q1.exec();
-        
-        SQLite::Statement q2(*db_, "DELETE FROM reviews WHERE problem_id=?"); 
-        q2.bind(1, uuid); 
-        q2.exec();
-        
-        SQLite::Statement q_tc(*db_, "DELETE FROM test_cases WHERE problem_id=?"); 
-        q_tc.bind(1, uuid); 
-        q_tc.exec();
-        
-        SQLite::Statement q3(*db_, "DELETE FROM problems WHERE id=?"); 
-        q3.bind(1, uuid); 
-        q3.exec();
-        
-        db_->exec("COMMIT");
-    } catch (...) {
-        db_->exec("ROLLBACK");
-        throw;
+int Database::tid_for_problem_id(const std::string& id) {
+    load_tid_map();
+    {
+        std::shared_lock lock(tid_map_mtx_);
+        if (auto it = tid_by_id_.find(id); it != tid_by_id_.end()) return it->second;
+    }
+    auto q_stmt = cached_statement("SELECT tid FROM problems WHERE id=? LIMIT 1");
+    auto& q = *q_stmt;
+    q.bind(1, ensure_utf8_lossy(id));
+    if (!q.executeStep() || q.getColumn(0).isNull()) return 0;
+    int tid = q.getColumn(0).getInt();
+    std::unique_lock lock(tid_map_mtx_);
+    tid_by_id_[id] = tid;
+    id_by_tid_[tid] = id;
+    return tid;
+}
+
+// Drops a problem id from the TID map after its row was deleted or re-inserted
+void Database::forget_tid(const std::string& id) {
+    std::unique_lock lock(tid_map_mtx_);
+    if (auto it = tid_by_id_.find(id); it != tid_by_id_.end()) {
+        id_by_tid_.erase(it->second);
+        tid_by_id_.erase(it);
+    }
+}
+
+void Database::delete_problem(int tid) {
+    delete_problems({tid});
+}
+
+/**
+ * @brief 批量删除题目
+ * @note 一个写任务内完成，要么全部删除要么全部保留；用例、复习和错题
+ *       由外键 ON DELETE CASCADE 一并删除（提交记录保留，用于历史统计）
+ */
+int Database::delete_problems(const std::vector<int>& tids) {
+    if (!on_writer_thread()) {
+        int deleted = 0;
+        run_write([&] { deleted = delete_problems(tids); });
+        return deleted;
+    }
+    int deleted = 0;
+    for (int tid : tids) {
+        std::string uuid;
+        {
+            auto q_stmt = cached_statement("SELECT id FROM problems WHERE tid=? LIMIT 1");
+            auto& q = *q_stmt;
+            q.bind(1, tid);
+            if (q.executeStep()) uuid = safe_column_text(q.getColumn(0));
+        }
+        if (uuid.empty()) continue;
+
+        auto d_stmt = cached_statement("DELETE FROM problems WHERE id=?");
+        auto& d = *d_stmt;
+        d.bind(1, uuid);
+        d.exec();
+        forget_tid(uuid);
+        ++deleted;
     }
+    return deleted;
 }
 
 // ---- Status & Mistake Management ----
 
 void Database::update_problem_status(const std::string& pid, const std::string& verdict, 
                                      int pass_count, int total_count) {
-    SQLite::Statement q(*db_, 
+    if (!on_writer_thread()) return run_write([&] { update_problem_status(pid, verdict, pass_count, total_count); });
+    auto q_stmt = cached_statement(
         "UPDATE problems SET last_verdict=?, pass_count=?, total_count=?, last_checked_at=? WHERE id=?");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(verdict));
     q.bind(2, pass_count);
     q.bind(3, total_count);
@@ -339,9 +1971,286 @@ void Database::update_problem_status(const std::string& pid, const std::string&
     q.exec();
 }
 
+/**
+ * @brief 周起点（UTC 周一 00:00）。1970-01-01 是周四，故偏移 3 天
+ */
+long long Database::week_start(long long timestamp) {
+    constexpr long long kDay = 86400, kWeek = 7 * kDay;
+    long long shifted = timestamp + 3 * kDay;
+    long long rem = shifted % kWeek;
+    if (rem < 0) rem += kWeek;
+    return timestamp - rem;
+}
+
+long long Database::record_attempt(const Attempt& a) {
+    long long id = 0;
+    if (!on_writer_thread()) {
+        run_write([&] { id = record_attempt(a); });
+        return id;
+    }
+    {
+        auto q_stmt = cached_statement(
+            "INSERT INTO attempts (problem_id,timestamp,verdict,pass_count,total_count,max_time_ms,"
+            "max_memory_kb,source_hash) VALUES (?,?,?,?,?,?,?,?)");
+        auto& q = *q_stmt;
+        q.bind(1, ensure_utf8_lossy(a.problem_id));
+        q.bind(2, static_cast<int64_t>(a.timestamp));
+        q.bind(3, ensure_utf8_lossy(a.verdict));
+        q.bind(4, a.pass_count);
+        q.bind(5, a.total_count);
+        q.bind(6, a.max_time_ms);
+        q.bind(7, a.max_memory_kb);
+        q.bind(8, a.source_hash);
+        q.exec();
+        id = db_->getLastInsertRowid();
+    }
+    std::string tags;
+    {
+        auto q_stmt = cached_statement("SELECT tags FROM problems WHERE id=?");
+        auto& q = *q_stmt;
+        q.bind(1, ensure_utf8_lossy(a.problem_id));
+        if (q.executeStep()) tags = safe_column_text(q.getColumn(0));
+    }
+    apply_attempt_rollups(a, tags);
+    {
+        auto q_stmt = cached_statement(
+            "UPDATE problems SET last_verdict=?, pass_count=?, total_count=?, last_checked_at=? WHERE id=?");
+        auto& q = *q_stmt;
+        q.bind(1, ensure_utf8_lossy(a.verdict));
+        q.bind(2, a.pass_count);
+        q.bind(3, a.total_count);
+        q.bind(4, static_cast<int64_t>(a.timestamp));
+        q.bind(5, ensure_utf8_lossy(a.problem_id));
+        q.exec();
+    }
+    return id;
+}
+
+/**
+ * @brief 将一次提交计入汇总表（调用方负责事务）
+ * @param tags 题目的逗号分隔标签，每个标签各计一份
+ */
+void Database::apply_attempt_rollups(const Attempt& a, const std::string& tags) {
+    const std::string pid = ensure_utf8_lossy(a.problem_id);
+    const bool ac = a.verdict == "AC";
+    bool first_ac = false;
+    {
+        auto q_stmt = cached_statement("SELECT first_ac_at FROM attempt_problem_stats WHERE problem_id=?");
+        auto& q = *q_stmt;
+        q.bind(1, pid);
+        first_ac = ac && (!q.executeStep() || q.getColumn(0).getInt64() == 0);
+    }
+    {
+        // DO UPDATE 中未加 excluded. 的列是更新前的旧值
+        auto q_stmt = cached_statement(
+            "INSERT INTO attempt_problem_stats (problem_id,attempts,accepted,first_attempt_at,last_attempt_at,"
+            "first_ac_at,attempts_to_ac,best_time_ms) VALUES (?1,1,?2,?3,?3,?4,?5,?6) "
+            "ON CONFLICT(problem_id) DO UPDATE SET "
+            "  attempts = attempts + 1,"
+            "  accepted = accepted + excluded.accepted,"
+            "  first_attempt_at = min(first_attempt_at, excluded.first_attempt_at),"
+            "  last_attempt_at = max(last_attempt_at, excluded.last_attempt_at),"
+            "  attempts_to_ac = CASE WHEN first_ac_at = 0 AND excluded.first_ac_at > 0 "
+            "                   THEN attempts + 1 ELSE attempts_to_ac END,"
+            "  first_ac_at = CASE WHEN first_ac_at = 0 THEN excluded.first_ac_at ELSE first_ac_at END,"
+            "  best_time_ms = CASE WHEN excluded.accepted = 0 THEN best_time_ms "
+            "                 WHEN accepted = 0 THEN excluded.best_time_ms "
+            "                 ELSE min(best_time_ms, excluded.best_time_ms) END");
+        auto& q = *q_stmt;
+        q.bind(1, pid);
+        q.bind(2, ac ? 1 : 0);
+        q.bind(3, static_cast<int64_t>(a.timestamp));
+        q.bind(4, static_cast<int64_t>(ac ? a.timestamp : 0));
+        q.bind(5, ac ? 1 : 0);
+        q.bind(6, ac ? a.max_time_ms : 0);
+        q.exec();
+    }
+
+    const int64_t week = week_start(a.timestamp);
+    {
+        auto q_stmt = cached_statement(
+            "INSERT INTO attempt_weeks (week_start,attempts,accepted,solved) VALUES (?,1,?,?) "
+            "ON CONFLICT(week_start) DO UPDATE SET attempts = attempts + 1, "
+            "accepted = accepted + excluded.accepted, solved = solved + excluded.solved");
+        auto& q = *q_stmt;
+        q.bind(1, week);
+        q.bind(2, ac ? 1 : 0);
+        q.bind(3, first_ac ? 1 : 0);
+        q.exec();
+    }
+    for (const auto& tag : split_tags(tags)) {
+        auto q_stmt = cached_statement(
+            "INSERT INTO attempt_tag_weeks (tag,week_start,attempts,accepted,solved) VALUES (?,?,1,?,?) "
+            "ON CONFLICT(tag, week_start) DO UPDATE SET attempts = attempts + 1, "
+            "accepted = accepted + excluded.accepted, solved = solved + excluded.solved");
+        auto& q = *q_stmt;
+        q.bind(1, ensure_utf8_lossy(tag));
+        q.bind(2, week);
+        q.bind(3, ac ? 1 : 0);
+        q.bind(4, first_ac ? 1 : 0);
+        q.exec();
+    }
+}
+
+/**
+ * @brief 清空并按时间顺序重放全部提交以重建汇总表（调用方负责事务）
+ */
+void Database::recompute_attempt_rollups() {
+    db_->exec("DELETE FROM attempt_problem_stats");
+    db_->exec("DELETE FROM attempt_weeks");
+    db_->exec("DELETE FROM attempt_tag_weeks");
+    SQLite::Statement q(*db_,
+        "SELECT a.problem_id, a.timestamp, a.verdict, a.max_time_ms, COALESCE(p.tags, '') "
+        "FROM attempts a LEFT JOIN problems p ON p.id = a.problem_id ORDER BY a.timestamp, a.id");
+    while (q.executeStep()) {
+        Attempt a;
+        a.problem_id = safe_column_text(q.getColumn(0));
+        a.timestamp = q.getColumn(1).getInt64();
+        a.verdict = safe_column_text(q.getColumn(2));
+        a.max_time_ms = q.getColumn(3).getInt();
+        apply_attempt_rollups(a, safe_column_text(q.getColumn(4)));
+    }
+}
+
+void Database::rebuild_attempt_rollups() {
+    if (!on_writer_thread()) return run_write([&] { rebuild_attempt_rollups(); });
+    recompute_attempt_rollups();
+}
+
+std::vector<AttemptPoint> Database::get_attempt_trend(const std::string& pid, int limit) {
+    std::vector<AttemptPoint> out;
+    auto q_stmt = cached_statement(
+        "SELECT timestamp, verdict, max_time_ms, max_memory_kb FROM attempts "
+        "WHERE problem_id=? ORDER BY timestamp DESC LIMIT ?");
+    auto& q = *q_stmt;
+    q.bind(1, ensure_utf8_lossy(pid));
+    q.bind(2, limit);
+    while (q.executeStep()) {
+        AttemptPoint pt;
+        pt.timestamp = q.getColumn(0).getInt64();
+        pt.verdict = safe_column_text(q.getColumn(1));
+        pt.max_time_ms = q.getColumn(2).getInt();
+        pt.max_memory_kb = q.getColumn(3).getInt();
+        out.push_back(std::move(pt));
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+static ProblemAttemptStats fill_attempt_stats_from_row(SQLite::Statement& q) {
+    ProblemAttemptStats s;
+    s.problem_id = safe_column_text(q.getColumn(0));
+    s.attempts = q.getColumn(1).getInt();
+    s.accepted = q.getColumn(2).getInt();
+    s.first_attempt_at = q.getColumn(3).getInt64();
+    s.last_attempt_at = q.getColumn(4).getInt64();
+    s.first_ac_at = q.getColumn(5).getInt64();
+    s.attempts_to_ac = q.getColumn(6).getInt();
+    s.best_time_ms = q.getColumn(7).getInt();
+    return s;
+}
+
+std::optional<ProblemAttemptStats> Database::get_attempt_stats(const std::string& pid) {
+    auto q_stmt = cached_statement(
+        "SELECT problem_id,attempts,accepted,first_attempt_at,last_attempt_at,first_ac_at,attempts_to_ac,"
+        "best_time_ms FROM attempt_problem_stats WHERE problem_id=?");
+    auto& q = *q_stmt;
+    q.bind(1, ensure_utf8_lossy(pid));
+    if (!q.executeStep()) return std::nullopt;
+    return fill_attempt_stats_from_row(q);
+}
+
+std::vector<ProblemAttemptStats> Database::get_recent_solves(int limit) {
+    std::vector<ProblemAttemptStats> out;
+    auto q_stmt = cached_statement(
+        "SELECT problem_id,attempts,accepted,first_attempt_at,last_attempt_at,first_ac_at,attempts_to_ac,"
+        "best_time_ms FROM attempt_problem_stats WHERE first_ac_at > 0 ORDER BY first_ac_at DESC LIMIT ?");
+    auto& q = *q_stmt;
+    q.bind(1, limit);
+    while (q.executeStep()) out.push_back(fill_attempt_stats_from_row(q));
+    return out;
+}
+
+std::vector<AttemptRollup> Database::get_weekly_attempts(long long since, const std::string& tag) {
+    std::vector<AttemptRollup> out;
+    auto q_stmt = cached_statement(tag.empty()
+        ? "SELECT '', week_start, attempts, accepted, solved FROM attempt_weeks "
+          "WHERE week_start >= ? ORDER BY week_start"
+        : "SELECT tag, week_start, attempts, accepted, solved FROM attempt_tag_weeks "
+          "WHERE week_start >= ? AND tag = ? ORDER BY week_start");
+    auto& q = *q_stmt;
+    q.bind(1, static_cast<int64_t>(week_start(since)));
+    if (!tag.empty()) q.bind(2, ensure_utf8_lossy(tag));
+    while (q.executeStep()) {
+        AttemptRollup r;
+        r.tag = safe_column_text(q.getColumn(0));
+        r.week_start = q.getColumn(1).getInt64();
+        r.attempts = q.getColumn(2).getInt();
+        r.accepted = q.getColumn(3).getInt();
+        r.solved = q.getColumn(4).getInt();
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+std::vector<AttemptRollup> Database::get_tag_attempts(long long since) {
+    std::vector<AttemptRollup> out;
+    const int64_t from = week_start(since);
+    auto q_stmt = cached_statement(
+        "SELECT tag, SUM(attempts), SUM(accepted), SUM(solved) FROM attempt_tag_weeks "
+        "WHERE week_start >= ? GROUP BY tag ORDER BY SUM(attempts) DESC, tag");
+    auto& q = *q_stmt;
+    q.bind(1, from);
+    while (q.executeStep()) {
+        AttemptRollup r;
+        r.tag = safe_column_text(q.getColumn(0));
+        r.week_start = from;
+        r.attempts = q.getColumn(1).getInt();
+        r.accepted = q.getColumn(2).getInt();
+        r.solved = q.getColumn(3).getInt();
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+static TagStats fill_tag_stats_from_row(SQLite::Statement& q) {
+    TagStats t;
+    t.tag = safe_column_text(q.getColumn(0));
+    t.problems = q.getColumn(1).getInt();
+    t.attempted = q.getColumn(2).getInt();
+    t.solved = q.getColumn(3).getInt();
+    return t;
+}
+
+std::vector<TagStats> Database::get_tag_stats(const std::string& tags) {
+    std::vector<TagStats> out;
+    auto q_stmt = cached_statement(tags.empty()
+        ? "SELECT name, problems, attempted, solved FROM tags WHERE problems > 0 ORDER BY problems DESC, name"
+        : "SELECT name, problems, attempted, solved FROM tags "
+          "WHERE name IN (SELECT value FROM json_each(?)) AND problems > 0 ORDER BY problems DESC, name");
+    auto& q = *q_stmt;
+    if (!tags.empty()) q.bind(1, tag_list_json(ensure_utf8_lossy(tags)));
+    while (q.executeStep()) out.push_back(fill_tag_stats_from_row(q));
+    return out;
+}
+
+std::vector<TagStats> Database::get_weakest_tags(int limit, int min_attempted) {
+    std::vector<TagStats> out;
+    auto q_stmt = cached_statement(
+        "SELECT name, problems, attempted, solved FROM tags WHERE attempted >= max(?, 1) "
+        "ORDER BY CAST(solved AS REAL) / attempted, attempted DESC, name LIMIT ?");
+    auto& q = *q_stmt;
+    q.bind(1, min_attempted);
+    q.bind(2, limit);
+    while (q.executeStep()) out.push_back(fill_tag_stats_from_row(q));
+    return out;
+}
+
 void Database::log_mistake(const std::string& pid, const std::string& type, const std::string& desc) {
-    SQLite::Statement q(*db_, 
+    if (!on_writer_thread()) return run_write([&] { log_mistake(pid, type, desc); });
+    auto q_stmt = cached_statement(
         "INSERT INTO mistakes (problem_id,type,description,timestamp) VALUES (?,?,?,?)");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(pid));
     q.bind(2, ensure_utf8_lossy(type));
     q.bind(3, ensure_utf8_lossy(desc));
@@ -351,9 +2260,10 @@ void Database::log_mistake(const std::string& pid, const std::string& type, cons
 
 std::vector<Mistake> Database::get_mistakes_for(const std::string& pid) {
     std::vector<Mistake> out;
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT id,problem_id,type,description,timestamp FROM mistakes "
         "WHERE problem_id=? ORDER BY timestamp DESC");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(pid));
     while (q.executeStep()) {
         out.push_back({
@@ -367,8 +2277,9 @@ std::vector<Mistake> Database::get_mistakes_for(const std::string& pid) {
 
 std::vector<std::pair<std::string, int>> Database::get_mistake_stats() {
     std::vector<std::pair<std::string, int>> out;
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT type, count(*) as cnt FROM mistakes GROUP BY type ORDER BY cnt DESC");
+    auto& q = *q_stmt;
     while (q.executeStep()) {
         out.emplace_back(safe_column_text(q.getColumn(0)), q.getColumn(1).getInt());
     }
@@ -377,10 +2288,62 @@ std::vector<std::pair<std::string, int>> Database::get_mistake_stats() {
 
 // ---- Review / SM-2 System ----
 
+/**
+ * @brief 读取仪表盘计数（见 init_stats），与题库规模无关
+ * @note 今天之前的到期复习直接取按日汇总；今天的部分按秒精确计算（走 idx_reviews_next）
+ */
+LibraryStats Database::get_library_stats(long long now, int upcoming_days) {
+    if (now <= 0) now = std::time(nullptr);
+    LibraryStats s;
+    {
+        auto q_stmt = cached_statement("SELECT dimension, key, count FROM problem_stats");
+        auto& q = *q_stmt;
+        while (q.executeStep()) {
+            std::string dim = q.getColumn(0).getString();
+            std::string key = safe_column_text(q.getColumn(1));
+            int count = q.getColumn(2).getInt();
+            if (dim == "total") s.total = count;
+            else if (dim == "source") s.by_source[key] = count;
+            else if (dim == "difficulty") s.by_difficulty[key] = count;
+            else if (dim == "verdict") s.by_verdict[key] = count;
+        }
+    }
+    const long long today = now / 86400;
+    {
+        auto q_stmt = cached_statement(
+            "SELECT (SELECT COALESCE(SUM(count), 0) FROM review_due_days WHERE day < ?1) + "
+            "(SELECT COUNT(*) FROM reviews WHERE next_review >= ?1 * 86400 AND next_review <= ?2)");
+        auto& q = *q_stmt;
+        q.bind(1, static_cast<int64_t>(today));
+        q.bind(2, static_cast<int64_t>(now));
+        if (q.executeStep()) s.due_reviews = q.getColumn(0).getInt();
+    }
+    if (upcoming_days > 0) {
+        // 今天剩余的部分单独计数，之后按日汇总
+        auto q_stmt = cached_statement(
+            "SELECT ?1, COUNT(*) FROM reviews WHERE next_review > ?2 AND next_review < (?1 + 1) * 86400 "
+            "UNION ALL SELECT day, count FROM review_due_days WHERE day > ?1 AND day < ?1 + ?3");
+        auto& q = *q_stmt;
+        q.bind(1, static_cast<int64_t>(today));
+        q.bind(2, static_cast<int64_t>(now));
+        q.bind(3, upcoming_days);
+        while (q.executeStep()) {
+            int count = q.getColumn(1).getInt();
+            if (count > 0) s.upcoming_reviews.emplace_back(q.getColumn(0).getInt64() * 86400, count);
+        }
+    }
+    return s;
+}
+
 void Database::upsert_review(const ReviewItem& r) {
-    SQLite::Statement q(*db_,
-        "INSERT OR REPLACE INTO reviews (problem_id,next_review,interval,ease_factor,repetitions) "
-        "VALUES (?,?,?,?,?)");
+    if (!on_writer_thread()) return run_write([&] { upsert_review(r); });
+    // 使用 UPSERT 而非 INSERT OR REPLACE：REPLACE 的隐式删除不触发 DELETE 触发器，
+    // 会使 review_due_days 计数失准
+    auto q_stmt = cached_statement(
+        "INSERT INTO reviews (problem_id,next_review,interval,ease_factor,repetitions) "
+        "VALUES (?,?,?,?,?) ON CONFLICT(problem_id) DO UPDATE SET next_review=excluded.next_review, "
+        "interval=excluded.interval, ease_factor=excluded.ease_factor, repetitions=excluded.repetitions");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(r.problem_id));
     q.bind(2, static_cast<int64_t>(r.next_review));
     q.bind(3, r.interval);
@@ -393,10 +2356,11 @@ std::vector<ReviewItem> Database::get_due_reviews(long long now) {
     std::vector<ReviewItem> out;
     out.reserve(50); // 预分配空间
     
-    SQLite::Statement q(*db_,
+    auto q_stmt = cached_statement(
         "SELECT r.problem_id, p.title, r.next_review, r.interval, r.ease_factor, r.repetitions "
         "FROM reviews r JOIN problems p ON r.problem_id=p.id "
         "WHERE r.next_review <= ? ORDER BY r.next_review ASC");
+    auto& q = *q_stmt;
     q.bind(1, static_cast<int64_t>(now));
     while (q.executeStep()) {
         out.push_back({
@@ -409,9 +2373,10 @@ std::vector<ReviewItem> Database::get_due_reviews(long long now) {
 }
 
 ReviewItem Database::get_review(const std::string& pid) {
-    SQLite::Statement q(*db_,
+    auto q_stmt = cached_statement(
         "SELECT problem_id, '', next_review, interval, ease_factor, repetitions "
         "FROM reviews WHERE problem_id=? LIMIT 1");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(pid));
     if (q.executeStep()) {
         return {
@@ -427,8 +2392,10 @@ ReviewItem Database::get_review(const std::string& pid) {
 
 void Database::add_test_case(const std::string& problem_id, const std::string& input, 
                              const std::string& output, bool is_sample) {
-    SQLite::Statement q(*db_, 
+    if (!on_writer_thread()) return run_write([&] { add_test_case(problem_id, input, output, is_sample); });
+    auto q_stmt = cached_statement(
         "INSERT INTO test_cases (problem_id,input,output,is_sample) VALUES (?,?,?,?)");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(problem_id));
     q.bind(2, ensure_utf8_lossy(input));
     q.bind(3, ensure_utf8_lossy(output));
@@ -438,9 +2405,10 @@ void Database::add_test_case(const std::string& problem_id, const std::string& i
 
 std::vector<std::pair<std::string, std::string>> Database::get_test_cases(const std::string& problem_id) {
     std::vector<std::pair<std::string, std::string>> out;
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT input, output FROM test_cases WHERE problem_id=? "
         "ORDER BY is_sample DESC, id ASC");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(problem_id));
     while (q.executeStep()) {
         out.emplace_back(safe_column_text(q.getColumn(0)), safe_column_text(q.getColumn(1)));
@@ -452,12 +2420,14 @@ std::vector<std::pair<std::string, std::string>> Database::get_test_cases(const
 
 void Database::upsert_memory_mistake(const std::string& tags, const std::string& pattern, 
                                      const std::string& example_id) {
+    if (!on_writer_thread()) return run_write([&] { upsert_memory_mistake(tags, pattern, example_id); });
     // 使用UPSERT语法优化（SQLite 3.24+）
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "INSERT INTO memory_mistakes (tags, pattern, frequency, last_seen, example_id) "
         "VALUES (?, ?, 1, ?, ?) "
         "ON CONFLICT(pattern) DO UPDATE SET "
         "frequency = frequency + 1, last_seen = ?, example_id = ?");
+    auto& q = *q_stmt;
     
     auto now = static_cast<int64_t>(std::time(nullptr));
     q.bind(1, ensure_utf8_lossy(tags));
@@ -473,9 +2443,33 @@ std::vector<MemoryMistake> Database::get_all_memory_mistakes() {
     std::vector<MemoryMistake> out;
     out.reserve(100);
     
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT id, tags, pattern, frequency, last_seen, example_id FROM memory_mistakes "
         "ORDER BY frequency DESC, last_seen DESC");
+    auto& q = *q_stmt;
+    while (q.executeStep()) {
+        MemoryMistake m;
+        m.id = q.getColumn(0).getInt();
+        m.tags = safe_column_text(q.getColumn(1));
+        m.pattern = safe_column_text(q.getColumn(2));
+        m.frequency = q.getColumn(3).getInt();
+        m.last_seen = q.getColumn(4).getInt64();
+        m.example_id = safe_column_text(q.getColumn(5));
+        out.push_back(m);
+    }
+    return out;
+}
+
+std::vector<MemoryMistake> Database::get_memory_mistakes_for_tags(const std::string& tags, int limit) {
+    std::vector<MemoryMistake> out;
+    auto q_stmt = cached_statement(
+        "SELECT id, tags, pattern, frequency, last_seen, example_id FROM memory_mistakes WHERE id IN ("
+        "  SELECT mt.mistake_id FROM memory_mistake_tags mt JOIN tags t ON t.id = mt.tag_id "
+        "  WHERE t.name IN (SELECT value FROM json_each(?))) "
+        "ORDER BY frequency DESC, last_seen DESC LIMIT ?");
+    auto& q = *q_stmt;
+    q.bind(1, tag_list_json(ensure_utf8_lossy(tags)));
+    q.bind(2, limit);
     while (q.executeStep()) {
         MemoryMistake m;
         m.id = q.getColumn(0).getInt();
@@ -492,9 +2486,11 @@ std::vector<MemoryMistake> Database::get_all_memory_mistakes() {
 // ---- Mastery System ----
 
 void Database::upsert_mastery(const std::string& skill, double confidence) {
-    SQLite::Statement q(*db_, 
+    if (!on_writer_thread()) return run_write([&] { upsert_mastery(skill, confidence); });
+    auto q_stmt = cached_statement(
         "INSERT INTO memory_mastery (skill, confidence, last_verified) VALUES (?, ?, ?) "
         "ON CONFLICT(skill) DO UPDATE SET confidence=?, last_verified=?");
+    auto& q = *q_stmt;
     
     auto now = static_cast<int64_t>(std::time(nullptr));
     q.bind(1, ensure_utf8_lossy(skill));
@@ -506,8 +2502,9 @@ void Database::upsert_mastery(const std::string& skill, double confidence) {
 }
 
 std::optional<Mastery> Database::get_mastery(const std::string& skill) {
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT id, skill, confidence, last_verified FROM memory_mastery WHERE skill=? LIMIT 1");
+    auto& q = *q_stmt;
     q.bind(1, ensure_utf8_lossy(skill));
     if (q.executeStep()) {
         Mastery m;
@@ -522,9 +2519,10 @@ std::optional<Mastery> Database::get_mastery(const std::string& skill) {
 
 std::vector<Mastery> Database::get_all_mastery() {
     std::vector<Mastery> out;
-    SQLite::Statement q(*db_, 
+    auto q_stmt = cached_statement(
         "SELECT id, skill, confidence, last_verified FROM memory_mastery "
         "ORDER BY confidence DESC");
+    auto& q = *q_stmt;
     while (q.executeStep()) {
         Mastery m;
         m.id = q.getColumn(0).getInt();
@@ -539,28 +2537,25 @@ std::vector<Mastery> Database::get_all_mastery() {
 // ---- User Profile ----
 
 void Database::update_user_profile(int elo, const std::string& preferences) {
-    db_->exec("BEGIN");
-    try {
-        if (elo > 0) {
-            SQLite::Statement q(*db_, "UPDATE user_profile SET elo_rating=? WHERE id=1");
-            q.bind(1, elo);
-            q.exec();
-        }
-        if (!preferences.empty()) {
-            SQLite::Statement q(*db_, "UPDATE user_profile SET preferences=? WHERE id=1");
-            q.bind(1, ensure_utf8_lossy(preferences));
-            q.exec();
-        }
-        db_->exec("COMMIT");
-    } catch (...) {
-        db_->exec("ROLLBACK");
-        throw;
+    if (!on_writer_thread()) return run_write([&] { update_user_profile(elo, preferences); });
+    if (elo > 0) {
+        auto q_stmt = cached_statement("UPDATE user_profile SET elo_rating=? WHERE id=1");
+        auto& q = *q_stmt;
+        q.bind(1, elo);
+        q.exec();
+    }
+    if (!preferences.empty()) {
+        auto q_stmt = cached_statement("UPDATE user_profile SET preferences=? WHERE id=1");
+        auto& q = *q_stmt;
+        q.bind(1, ensure_utf8_lossy(preferences));
+        q.exec();
     }
 }
 
 UserProfile Database::get_user_profile() {
     UserProfile p;
-    SQLite::Statement q(*db_, "SELECT elo_rating, preferences FROM user_profile WHERE id=1 LIMIT 1");
+    auto q_stmt = cached_statement("SELECT elo_rating, preferences FROM user_profile WHERE id=1 LIMIT 1");
+    auto& q = *q_stmt;
     if (q.executeStep()) {
         p.elo_rating = q.getColumn(0).getInt();
         p.preferences = safe_column_text(q.getColumn(1));
@@ -0,0 +1,223 @@
+#include "shuati/library_archive.hpp"
+#include <nlohmann/json.hpp>
+#include <fmt/core.h>
+#include <zlib.h>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace shuati {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr const char* kFormatName = "shuati-library";
+
+// gzip stream through zlib. Opened with "wbT" it writes plain text, and
+// reading accepts both compressed and plain files.
+class GzFile {
+public:
+    GzFile(const fs::path& path, const char* mode) {
+#ifdef _WIN32
+        file_ = gzopen_w(path.wstring().c_str(), mode);
+#else
+        file_ = gzopen(path.string().c_str(), mode);
+#endif
+        if (!file_) throw std::runtime_error("无法打开文件: " + path.string());
+        gzbuffer(file_, 256 * 1024);
+    }
+    ~GzFile() {
+        if (file_) gzclose(file_);
+    }
+    GzFile(const GzFile&) = delete;
+    GzFile& operator=(const GzFile&) = delete;
+
+    void write(const std::string& data) {
+        if (data.empty()) return;
+        if (gzwrite(file_, data.data(), static_cast<unsigned>(data.size())) != static_cast<int>(data.size()))
+            throw std::runtime_error("写入归档失败: " + error());
+    }
+
+    void close() {
+        int rc = gzclose(file_);
+        file_ = nullptr;
+        if (rc != Z_OK) throw std::runtime_error("写入归档失败 (磁盘已满?)");
+    }
+
+    // Next line without its '\n'; false at end of file
+    bool getline(std::string& line) {
+        line.clear();
+        while (true) {
+            if (pos_ == len_) {
+                int n = gzread(file_, buf_, sizeof(buf_));
+                if (n < 0) throw std::runtime_error("读取归档失败: " + error());
+                if (n == 0) return !line.empty();
+                pos_ = 0;
+                len_ = static_cast<size_t>(n);
+            }
+            const char* start = buf_ + pos_;
+            auto nl = static_cast<const char*>(std::memchr(start, '\n', len_ - pos_));
+            if (nl) {
+                line.append(start, nl);
+                pos_ = static_cast<size_t>(nl - buf_) + 1;
+                return true;
+            }
+            line.append(start, len_ - pos_);
+            pos_ = len_;
+        }
+    }
+
+private:
+    std::string error() {
+        int code = 0;
+        const char* msg = gzerror(file_, &code);
+        return msg ? msg : "";
+    }
+
+    gzFile file_ = nullptr;
+    char buf_[64 * 1024];
+    size_t pos_ = 0;
+    size_t len_ = 0;
+};
+
+bool is_gzip_name(const fs::path& file) {
+    return file.extension() == ".gz";
+}
+
+std::string to_line(const ArchiveRow& row) {
+    json j;
+    j["t"] = row.type;
+    for (const auto& [name, value] : row.fields) {
+        std::visit([&j, &name](const auto& v) { j[name] = v; }, value);
+    }
+    // Invalid UTF-8 (binary test data) becomes U+FFFD instead of aborting the export
+    return j.dump(-1, ' ', false, json::error_handler_t::replace) + "\n";
+}
+
+ArchiveRow from_json(const json& j) {
+    ArchiveRow row;
+    row.type = j.value("t", "");
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        if (it.key() == "t") continue;
+        const auto& v = it.value();
+        ArchiveValue value;
+        if (v.is_null()) value = nullptr;
+        else if (v.is_number_integer() || v.is_boolean()) value = v.get<int64_t>();
+        else if (v.is_number_float()) value = v.get<double>();
+        else if (v.is_string()) value = v.get<std::string>();
+        else value = v.dump();
+        row.fields.emplace_back(it.key(), std::move(value));
+    }
+    return row;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+std::optional<ConflictPolicy> LibraryArchive::parse_policy(const std::string& name) {
+    if (name == "skip") return ConflictPolicy::Skip;
+    if (name == "replace") return ConflictPolicy::Replace;
+    if (name == "fail") return ConflictPolicy::Fail;
+    return std::nullopt;
+}
+
+/**
+ * @brief 流式导出整个题库
+ * @note 先写入 <file>.partial，完成后改名，中断的导出不会留下残缺的归档
+ */
+ArchiveCounts LibraryArchive::export_to(Database& db, const fs::path& file, const Progress& progress) {
+    const auto start = std::chrono::steady_clock::now();
+    fs::path partial = file;
+    partial += ".partial";
+    try {
+        GzFile out(partial, is_gzip_name(file) ? "wb6" : "wbT");
+        json header = {{"t", "header"},
+                       {"format", kFormatName},
+                       {"version", kFormatVersion},
+                       {"schema", Database::kSchemaVersion},
+                       {"exported_at", static_cast<long long>(std::time(nullptr))}};
+        out.write(header.dump() + "\n");
+
+        long long rows = 0;
+        auto counts = db.export_archive([&](const ArchiveRow& row) {
+            out.write(to_line(row));
+            if (++rows % static_cast<long long>(kBatchRows) == 0 && progress) progress(rows, elapsed_ms(start));
+        });
+        out.write(json{{"t", "end"}, {"rows", counts.rows()}}.dump() + "\n");
+        out.close();
+        if (progress) progress(rows, elapsed_ms(start));
+        fs::rename(partial, file);
+        return counts;
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(partial, ec);
+        throw;
+    }
+}
+
+/**
+ * @brief 流式导入归档
+ * @note 每 kBatchRows 行（或 kBatchBytes 字节）作为一个写事务提交；
+ *       结束后按导入的提交记录重建汇总表
+ */
+ArchiveCounts LibraryArchive::import_from(Database& db, const fs::path& file, ConflictPolicy policy,
+                                          const Progress& progress) {
+    const auto start = std::chrono::steady_clock::now();
+    GzFile in(file, "rb");
+    std::string line;
+    json header;
+    try {
+        if (in.getline(line)) header = json::parse(line);
+    } catch (const json::parse_error&) {}
+    if (!header.is_object() || header.value("format", "") != kFormatName)
+        throw std::runtime_error("不是 shuati 题库归档: " + file.string());
+    int version = header.value("version", 0);
+    if (version > kFormatVersion)
+        throw std::runtime_error(fmt::format("归档格式版本 {} 高于当前程序支持的 {}，请先升级 shuati", version, kFormatVersion));
+
+    ArchiveImportState state;
+    std::vector<ArchiveRow> batch;
+    size_t batch_bytes = 0;
+    long long line_no = 1;
+    bool complete = false;
+    auto flush = [&] {
+        if (batch.empty()) return;
+        db.import_archive(batch, policy, state);
+        batch.clear();
+        batch_bytes = 0;
+        if (progress) progress(state.counts.rows() + state.counts.skipped, elapsed_ms(start));
+    };
+
+    while (in.getline(line)) {
+        ++line_no;
+        if (line.empty()) continue;
+        json j;
+        try {
+            j = json::parse(line);
+        } catch (const json::parse_error&) {
+            throw std::runtime_error(fmt::format("归档第 {} 行格式错误", line_no));
+        }
+        if (j.value("t", "") == "end") {
+            complete = true;
+            break;
+        }
+        batch.push_back(from_json(j));
+        batch_bytes += line.size();
+        if (batch.size() >= kBatchRows || batch_bytes >= kBatchBytes) flush();
+    }
+    flush();
+    // Attempts were inserted as rows, and a replaced problem loses its old ones
+    if (state.counts.problems > 0) db.rebuild_attempt_rollups();
+
+    if (!complete)
+        throw std::runtime_error(fmt::format("归档不完整 (缺少结束标记)，已导入 {} 行", state.counts.rows()));
+    return state.counts;
+}
+
+} // namespace shuati
@@ -0,0 +1,995 @@
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "shuati/database.hpp"
+#include "shuati/utils/encoding.hpp"
+
+using namespace shuati;
+
+static void check(bool cond, const std::string& msg) {
+    if (!cond) {
+        std::cerr << "FAILED: " << msg << "\n";
+        exit(1);
+    }
+}
+
+static Problem make_problem(int i, const std::string& source, const std::string& diff,
+                            const std::string& verdict) {
+    Problem p;
+    p.id = "p" + std::to_string(i);
+    p.source = source;
+    p.title = "Problem " + std::to_string(i);
+    p.url = "https://example.com/" + p.id;
+    p.description = "<p>statement</p>";
+    p.difficulty = diff;
+    p.created_at = 1000 + (i / 2);  // pairs share a timestamp: exercises the rowid tie-break
+    p.last_verdict = verdict;
+    return p;
+}
+
+void test_query_problems() {
+    std::string db_path = "test_database.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        const std::vector<std::string> sources = {"LeetCode", "Codeforces", "local", "AtCoder"};
+        const std::vector<std::string> diffs = {"easy", "medium", "hard"};
+        const std::vector<std::string> verdicts = {"AC", "WA", "", "SKIPPED", "TLE"};
+        for (int i = 0; i < 60; ++i) {
+            db.add_problem(make_problem(i, sources[i % sources.size()], diffs[i % diffs.size()],
+                                        verdicts[i % verdicts.size()]));
+        }
+
+        std::cout << "Testing unfiltered keyset pagination...\n";
+        ProblemQuery q;
+        q.limit = 25;
+        std::vector<ProblemSummary> all;
+        int pages = 0;
+        while (true) {
+            auto page = db.query_problems(q);
+            all.insert(all.end(), page.rows.begin(), page.rows.end());
+            ++pages;
+            if (!page.next) break;
+            check(static_cast<int>(page.rows.size()) == q.limit, "full page before cursor");
+            q.after = page.next;
+        }
+        check(pages == 3, "expected 3 pages, got " + std::to_string(pages));
+        check(all.size() == 60, "expected 60 rows, got " + std::to_string(all.size()));
+        for (size_t i = 1; i < all.size(); ++i) {
+            bool ordered = all[i - 1].created_at > all[i].created_at ||
+                           (all[i - 1].created_at == all[i].created_at &&
+                            all[i - 1].display_id > all[i].display_id);
+            check(ordered, "rows must be ordered by (created_at, insertion order) DESC without repeats");
+        }
+
+        std::cout << "Testing SQL filters...\n";
+        ProblemQuery f;
+        f.status = "ac";
+        auto ac = db.query_problems(f).rows;
+        check(ac.size() == 12, "ac count");
+        for (const auto& p : ac) check(p.last_verdict == "AC", "ac filter");
+        check(db.count_problems(f) == 12, "count_problems(ac)");
+
+        f.status = "failed";
+        auto failed = db.query_problems(f).rows;
+        check(failed.size() == 24, "failed count");
+        f.status = "unaudited";
+        check(db.count_problems(f) == 24, "unaudited count");
+
+        ProblemQuery s;
+        s.source = "leetcode";
+        s.difficulty = "easy";
+        auto lc = db.query_problems(s).rows;
+        // i % 4 == 0 && i % 3 == 0  ->  i % 12 == 0
+        check(lc.size() == 5, "leetcode+easy count, got " + std::to_string(lc.size()));
+        s.source = "other";
+        s.difficulty = "all";
+        check(db.count_problems(s) == 15, "non-canonical source maps to 'other'");
+
+        std::cout << "Testing offset paging and review join...\n";
+        ProblemQuery o;
+        o.limit = 10;
+        o.offset = 55;
+        auto tail = db.query_problems(o);
+        check(tail.rows.size() == 5 && !tail.next, "offset tail page");
+
+        ReviewItem r;
+        r.problem_id = "p3";
+        r.next_review = 500;
+        db.upsert_review(r);
+        ProblemQuery rq;
+        rq.status = "review";
+        rq.now = 1000;
+        auto due = db.query_problems(rq).rows;
+        check(due.size() == 1 && due[0].id == "p3", "review filter");
+
+        // The due flag comes with each page, next to the filter arguments
+        r.problem_id = "p4";
+        r.next_review = 2000;
+        db.upsert_review(r);
+        ProblemQuery flagged;
+        flagged.difficulty = "all";
+        flagged.limit = 100;
+        flagged.now = 1000;
+        int flagged_due = 0;
+        for (const auto& p : db.query_problems(flagged).rows) {
+            if (p.review_due) ++flagged_due;
+            if (p.id == "p3") check(p.review_due, "review_due set");
+            if (p.id == "p4") check(!p.review_due, "review_due not yet");
+        }
+        check(flagged_due == 1, "review_due only for due rows");
+        flagged.now = 3000;
+        flagged_due = 0;
+        for (const auto& p : db.query_problems(flagged).rows) flagged_due += p.review_due;
+        check(flagged_due == 2, "review_due follows now");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_query_problems passed.\n";
+}
+
+void test_search_problems() {
+    std::string db_path = "test_database_search.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        Problem a = make_problem(1, "Luogu", "medium", "");
+        a.title = "背包问题";
+        a.tags = "dp";
+        a.description = "<p>有 <b>N</b> 件物品和一个容量为 V 的背包&nbsp;求最大价值。</p>";
+        db.add_problem(a);
+        Problem b = make_problem(2, "LeetCode", "easy", "");
+        b.title = "Twin Sum";
+        b.tags = "hash";
+        b.description = "<p>Given an array of integers, return indices of the two numbers.</p>";
+        db.add_problem(b);
+
+        std::cout << "Testing full-text search...\n";
+        check(db.has_fulltext_index(), "FTS5 trigram index should be available");
+        auto hits = db.search_problems("最大价值");
+        check(hits.size() == 1 && hits[0].problem.id == "p1", "CJK statement match");
+        check(hits[0].snippet.find("[最大价值]") != std::string::npos, "snippet highlights match: " + hits[0].snippet);
+        check(db.search_problems("<b>").empty(), "markup is not indexed");
+        check(db.search_problems("INTEGERS array").size() == 1, "multi-term, case-insensitive match");
+
+        std::cout << "Testing short-term fallback...\n";
+        hits = db.search_problems("背包");
+        check(hits.size() == 1 && hits[0].problem.id == "p1", "two-character term falls back to LIKE");
+        check(db.search_problems("d%").empty(), "LIKE wildcards are escaped");
+
+        std::cout << "Testing trigger sync...\n";
+        b.title = "Three Sum";
+        db.add_problem(b);
+        check(db.search_problems("Twin").empty(), "update trigger drops old title");
+        check(db.search_problems("Three").size() == 1, "update trigger indexes new title");
+        db.delete_problem(db.get_problem("p1").display_id);
+        check(db.search_problems("最大价值").empty(), "delete trigger removes the row");
+        db.add_problem(a);
+    }
+    {
+        // VACUUM may renumber rowids of a table without INTEGER PRIMARY KEY
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("UPDATE problems SET rowid = 1000 - rowid");
+    }
+    {
+        std::cout << "Testing index keyed by TID...\n";
+        Database db(db_path);
+        auto hits = db.search_problems("最大价值");
+        check(hits.size() == 1 && hits[0].problem.id == "p1", "renumbered rowids do not move hits");
+        hits = db.search_problems("Three Sum");
+        check(hits.size() == 1 && hits[0].problem.id == "p2", "renumbered rowids do not move hits (2)");
+        check(db.search_problems("背包").size() == 1, "LIKE fallback joins by TID");
+    }
+    {
+        // Other clients (sqlite3 CLI, older builds) have none of the app's SQL functions
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("UPDATE problems SET title = 'Two Sum', description = '<p>哈希表计数</p>' WHERE id = 'p2'");
+        SQLite::Statement q(raw, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' "
+                                 "AND name LIKE 'problems_fts%' AND sql LIKE '%shuati%'");
+        check(q.executeStep() && q.getColumn(0).getInt() == 0, "FTS triggers use built-in SQL only");
+    }
+    {
+        std::cout << "Testing writes from other clients...\n";
+        Database db(db_path);
+        auto hits = db.search_problems("哈希表计数");
+        check(hits.size() == 1 && hits[0].problem.id == "p2", "outside write indexed");
+        check(db.search_problems("Three Sum").empty(), "outside write replaced the old title");
+        Problem b = db.get_problem("p2");
+        b.description = "<p>用 <i>哈希表</i> 计数</p>";
+        db.add_problem(b);
+        check(db.search_problems("<i>").empty(), "app writes index the plaintext");
+        check(db.search_problems("哈希表").size() == 1, "app writes index the plaintext (2)");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_search_problems passed.\n";
+}
+
+void test_statement_cache() {
+    std::string db_path = "test_database_stmt.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        for (int i = 0; i < 4; ++i) db.add_problem(make_problem(i, "local", "easy", ""));
+
+        std::cout << "Testing statement reuse...\n";
+        db.get_problem("p1");
+        db.add_test_case("p1", "1\n", "1\n");
+        size_t warm = db.cached_statement_count();
+        for (int i = 0; i < 50; ++i) {
+            check(db.get_problem("p" + std::to_string(i % 4)).id == "p" + std::to_string(i % 4), "get_problem via cache");
+            db.add_test_case("p1", std::to_string(i), std::to_string(i));
+        }
+        check(db.cached_statement_count() == warm, "repeated calls must not prepare new statements");
+        check(db.get_test_cases("p1").size() == 51, "cached insert wrote every row");
+
+        // A reader leaving its statement mid-result must not pin a read snapshot
+        check(db.problem_exists("https://example.com/p2"), "problem_exists");
+        {
+            SQLite::Database other(db_path, SQLite::OPEN_READWRITE);
+            other.exec("UPDATE problems SET title='changed' WHERE id='p2'");
+        }
+        check(db.get_problem("p2").title == "changed", "cached statements see other connections' commits");
+
+        std::cout << "Testing concurrent use of the shared connection...\n";
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&db, t] {
+                for (int i = 0; i < 200; ++i) {
+                    if (db.get_problem("p" + std::to_string((t + i) % 4)).id.empty()) {
+                        std::cerr << "FAILED: concurrent get_problem\n";
+                        exit(1);
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_statement_cache passed.\n";
+}
+
+void test_add_problem_with_cases() {
+    std::string db_path = "test_database_bulk.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        std::vector<TestCase> cases;
+        for (int i = 0; i < 150; ++i) cases.push_back({std::to_string(i) + "\n", std::to_string(i * 2) + "\n", i < 3});
+
+        std::cout << "Testing bulk insert...\n";
+        ReviewItem r;
+        r.problem_id = "p1";
+        r.next_review = 42;
+        db.add_problem_with_cases(make_problem(1, "Codeforces", "hard", ""), cases, r);
+        check(db.get_test_cases("p1").size() == 150, "all cases stored");
+        check(db.get_review("p1").next_review == 42, "review stored");
+
+        std::cout << "Testing rollback on failure...\n";
+        {
+            // Make the 100th case fail after the problem row has been written
+            SQLite::Database other(db_path, SQLite::OPEN_READWRITE);
+            other.exec("CREATE TRIGGER fail_case BEFORE INSERT ON test_cases WHEN new.input = '99\n' "
+                       "BEGIN SELECT RAISE(ABORT, 'injected failure'); END");
+        }
+        bool threw = false;
+        try {
+            db.add_problem_with_cases(make_problem(2, "Codeforces", "hard", ""), cases);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        check(threw, "failure must propagate");
+        check(db.get_problem("p2").id.empty(), "problem row rolled back");
+        check(db.get_test_cases("p2").empty(), "no orphan test cases");
+        check(db.search_problems("Problem 2").empty(), "FTS row rolled back");
+        check(db.get_test_cases("p1").size() == 150, "earlier import untouched");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_add_problem_with_cases passed.\n";
+}
+
+void test_migrations() {
+    std::string db_path = "test_database_migrate.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        std::cout << "Testing schema version on a new database...\n";
+        Database db(db_path);
+        check(db.schema_version() == Database::kSchemaVersion, "new database should be at the latest version");
+        db.add_problem(make_problem(1, "Codeforces", "easy", "AC"));
+    }
+    {
+        // A database created before versioning reports user_version = 0 and
+        // only knows the last verdict of each problem
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("DROP TABLE attempts");
+        raw.exec("UPDATE problems SET last_checked_at = 1704067200 WHERE id = 'p1'");
+        raw.exec("PRAGMA user_version = 0");
+    }
+    {
+        std::cout << "Testing upgrade of an unversioned database...\n";
+        Database db(db_path);
+        check(db.schema_version() == Database::kSchemaVersion, "migrations should bring the version up to date");
+        check(db.get_problem("p1").title == "Problem 1", "existing rows survive the migration");
+        check(db.search_problems("Problem 1").size() == 1, "full-text index not duplicated by re-run");
+        auto stats = db.get_attempt_stats("p1");
+        check(stats && stats->attempts == 1 && stats->first_ac_at == 1704067200,
+              "last verdict imported as the first attempt");
+    }
+    {
+        // Schema 9 indexed the statement through an app-defined function
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("DROP TRIGGER problems_fts_au");
+        raw.exec("CREATE TRIGGER problems_fts_au AFTER UPDATE OF title, tags, description ON problems BEGIN "
+                 "UPDATE problems_fts SET body = shuati_plaintext(new.description) WHERE rowid = new.tid; END");
+        raw.exec("PRAGMA user_version = 9");
+    }
+    {
+        std::cout << "Testing upgrade drops app functions from the FTS triggers...\n";
+        { Database db(db_path); }
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("UPDATE problems SET title = 'Problem One' WHERE id = 'p1'");
+        Database db(db_path);
+        check(db.search_problems("Problem One").size() == 1, "outside write indexed after the upgrade");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_migrations passed.\n";
+}
+
+void test_attempts() {
+    std::string db_path = "test_database_attempts.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        auto p1 = make_problem(1, "Codeforces", "easy", "");
+        p1.tags = "dp, greedy";
+        auto p2 = make_problem(2, "Codeforces", "easy", "");
+        p2.tags = "dp";
+        db.add_problem(p1);
+        db.add_problem(p2);
+
+        const long long monday = 1704067200;  // 2024-01-01 00:00 UTC
+        check(Database::week_start(monday) == monday, "Monday starts its own week");
+        check(Database::week_start(monday + 6 * 86400 + 3600) == monday, "Sunday belongs to the previous Monday");
+
+        auto attempt = [&](const std::string& pid, long long ts, const std::string& verdict, int time_ms) {
+            Attempt a;
+            a.problem_id = pid;
+            a.timestamp = ts;
+            a.verdict = verdict;
+            a.pass_count = verdict == "AC" ? 3 : 1;
+            a.total_count = 3;
+            a.max_time_ms = time_ms;
+            a.max_memory_kb = 1024;
+            a.source_hash = "abc";
+            return db.record_attempt(a);
+        };
+
+        std::cout << "Testing attempt history...\n";
+        attempt("p1", monday + 100, "WA", 50);
+        attempt("p1", monday + 200, "TLE", 1000);
+        attempt("p1", monday + 7300, "AC", 400);
+        attempt("p1", monday + 8 * 86400, "AC", 300);  // next week, already solved
+        attempt("p2", monday + 8 * 86400, "WA", 10);
+
+        auto stats = db.get_attempt_stats("p1");
+        check(stats.has_value(), "p1 has stats");
+        check(stats->attempts == 4 && stats->accepted == 2, "p1 attempt counts");
+        check(stats->attempts_to_ac == 3, "p1 accepted on the third attempt");
+        check(stats->time_to_ac() == 7200, "p1 time to AC");
+        check(stats->best_time_ms == 300, "best time only counts AC runs");
+        check(!db.get_attempt_stats("p3").has_value(), "no stats without attempts");
+        check(db.get_problem("p2").last_verdict == "WA", "record_attempt updates last verdict");
+
+        auto trend = db.get_attempt_trend("p1", 3);
+        check(trend.size() == 3 && trend.front().verdict == "TLE" && trend.back().max_time_ms == 300,
+              "trend returns the latest attempts oldest first");
+
+        auto weeks = db.get_weekly_attempts(monday);
+        check(weeks.size() == 2, "two weeks of history");
+        check(weeks[0].attempts == 3 && weeks[0].accepted == 1 && weeks[0].solved == 1, "first week rollup");
+        check(weeks[1].attempts == 2 && weeks[1].accepted == 1 && weeks[1].solved == 0, "second week rollup");
+        auto dp_weeks = db.get_weekly_attempts(monday, "dp");
+        check(dp_weeks.size() == 2 && dp_weeks[1].attempts == 2, "per-tag weekly rollup");
+
+        auto tags = db.get_tag_attempts(monday);
+        check(tags.size() == 2 && tags[0].tag == "dp" && tags[0].attempts == 5, "dp is most attempted");
+        check(tags[1].tag == "greedy" && tags[1].solved == 1, "greedy counts p1's first AC");
+        check(db.get_recent_solves().size() == 1, "only p1 solved");
+
+        std::cout << "Testing rollup rebuild matches incremental updates...\n";
+        db.rebuild_attempt_rollups();
+        auto rebuilt = db.get_tag_attempts(monday);
+        check(rebuilt.size() == tags.size() && rebuilt[0].attempts == tags[0].attempts &&
+              rebuilt[1].solved == tags[1].solved, "rebuilt tag rollups");
+        check(db.get_attempt_stats("p1")->attempts_to_ac == 3, "rebuilt problem stats");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_attempts passed.\n";
+}
+
+void test_library_stats() {
+    std::string db_path = "test_database_stats.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+
+    {
+        Database db(db_path);
+        std::cout << "Testing trigger-maintained library stats...\n";
+        db.add_problem(make_problem(1, "Codeforces", "easy", ""));
+        db.add_problem(make_problem(2, "Codeforces", "hard", "AC"));
+        db.add_problem(make_problem(3, "LeetCode", "easy", "WA"));
+
+        auto s = db.get_library_stats(1000);
+        check(s.total == 3, "total counter");
+        check(s.by_source["codeforces"] == 2 && s.by_source["leetcode"] == 1, "source counters");
+        check(s.by_difficulty["easy"] == 2, "difficulty counters");
+        check(s.verdict("AC") == 1 && s.verdict("") == 1, "verdict counters");
+
+        db.update_problem_status("p1", "AC", 3, 3);
+        db.update_problem_status("p3", "WA", 1, 3);  // unchanged verdict
+        db.delete_problem(db.get_problem("p2").display_id);
+        s = db.get_library_stats(1000);
+        check(s.total == 2 && s.verdict("AC") == 1 && s.verdict("WA") == 1, "counters follow updates and deletes");
+        check(s.verdict("") == 0 && !s.by_difficulty.count("hard"), "empty buckets are dropped");
+
+        const long long day = 86400, now = 100 * day + 3600;
+        auto review = [&](const std::string& pid, long long next) {
+            ReviewItem r;
+            r.problem_id = pid;
+            r.next_review = next;
+            db.upsert_review(r);
+        };
+        review("p1", now - 5 * day);   // overdue
+        review("p3", now - 60);        // due earlier today
+        s = db.get_library_stats(now);
+        check(s.due_reviews == 2, "due reviews");
+        review("p3", now + 600);       // rescheduled later today
+        review("p1", now + 2 * day);
+        s = db.get_library_stats(now);
+        check(s.due_reviews == 0, "rescheduled reviews are no longer due");
+        check(s.upcoming_reviews.size() == 2 && s.upcoming_reviews[0].first == 100 * day &&
+              s.upcoming_reviews[1] == std::make_pair(102 * day, 1), "upcoming reviews bucketed by day");
+        check(db.get_due_reviews(now + 3 * day).size() == 2, "counters agree with get_due_reviews");
+        check(db.get_library_stats(now + 3 * day).due_reviews == 2, "due count after the buckets pass");
+    }
+
+    std::filesystem::remove(db_path);
+    std::cout << "test_library_stats passed.\n";
+}
+
+void test_write_queue() {
+    std::cout << "Testing MPSC queue ordering...\n";
+    {
+        utils::MpscQueue<int> q;
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&q, t] { for (int i = 0; i < 1000; ++i) q.push(t * 1000 + i); });
+        }
+        for (auto& p : producers) p.join();
+        auto items = q.drain();
+        check(items.size() == 4000, "every pushed item drained");
+        std::vector<int> last(4, -1);
+        for (int v : items) {
+            check(v % 1000 > last[v / 1000], "per-producer order preserved");
+            last[v / 1000] = v % 1000;
+        }
+        check(q.drain().empty(), "queue empty after drain");
+    }
+
+    std::string db_path = "test_database_writer.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        Database db(db_path);
+        std::cout << "Testing concurrent writers...\n";
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 8; ++t) {
+            writers.emplace_back([&db, t] {
+                for (int i = 0; i < 25; ++i) {
+                    int n = t * 100 + i;
+                    db.add_problem_with_cases(make_problem(n, "local", "easy", ""), {{"1\n", "1\n", true}});
+                    if (db.get_problem("p" + std::to_string(n)).id.empty()) {
+                        std::cerr << "FAILED: write not visible to its caller after return\n";
+                        exit(1);
+                    }
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        check(db.count_problems(ProblemQuery{}) == 200, "all concurrent writes committed");
+        auto stats = db.write_stats();
+        check(stats.jobs == 200 && stats.batches >= 1 && stats.batches <= stats.jobs, "writer counters");
+        std::cout << "  200 writes in " << stats.batches << " transactions\n";
+
+        std::cout << "Testing that a failing write does not affect its batch...\n";
+        bool threw = false;
+        try {
+            // Same url as p0: violates the unique index
+            auto dup = make_problem(9999, "local", "easy", "");
+            dup.url = "https://example.com/p0";
+            db.add_problem(dup);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        check(threw, "constraint error reaches the caller");
+        db.add_problem(make_problem(10000, "local", "easy", ""));
+        check(!db.get_problem("p10000").id.empty(), "writer keeps working after a failed job");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_write_queue passed.\n";
+}
+
+void test_db_profile() {
+    std::string db_path = "test_database_profile.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        auto server = DbProfile::preset("server");
+        check(server.temp_store_memory && server.cache_size_kb > DbProfile{}.cache_size_kb, "server preset");
+        bool threw = false;
+        try { DbProfile::preset("desktop"); } catch (const std::invalid_argument&) { threw = true; }
+        check(threw, "unknown preset rejected");
+
+        server.wal_autocheckpoint = 2500;
+        Database db(db_path, server);
+        const auto& eff = db.profile();
+        check(eff.name == "server" && eff.cache_size_kb == 65536 && eff.temp_store_memory, "pragmas applied");
+        check(eff.wal_autocheckpoint == 2500 && eff.busy_timeout_ms == 15000, "overrides applied");
+        check(eff.read_connections > 0, "read pool size resolved");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_db_profile passed.\n";
+}
+
+void test_read_pool() {
+    std::string db_path = "test_database_pool.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        DbProfile profile;
+        profile.read_connections = 3;
+        Database db(db_path, profile);
+        check(db.read_pool_size() == 3, "read pool size");
+        check(db.profile().read_connections == 3 && db.profile().name == "laptop", "effective profile");
+        for (int i = 0; i < 50; ++i) db.add_problem(make_problem(i, "local", "easy", ""));
+        db.count_problems(ProblemQuery{});
+        size_t single = db.cached_statement_count();
+
+        std::cout << "Testing parallel readers alongside a writer...\n";
+        std::atomic<bool> ok{true};
+        std::thread writer([&db] {
+            for (int i = 50; i < 100; ++i) db.add_problem(make_problem(i, "local", "easy", ""));
+        });
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 6; ++t) {
+            readers.emplace_back([&db, &ok, t] {
+                int seen = 0;
+                for (int i = 0; i < 20; ++i) {
+                    int n = db.count_problems(ProblemQuery{});
+                    if (n < seen || n < 50 || n > 100) ok = false;  // Committed data only, never goes back
+                    seen = n;
+                    if (db.get_problem("p" + std::to_string((t * 7 + i) % 50)).id.empty()) ok = false;
+                }
+            });
+        }
+        for (auto& r : readers) r.join();
+        writer.join();
+        check(ok, "pooled readers see consistent committed data");
+        check(db.count_problems(ProblemQuery{}) == 100, "writes visible to readers");
+        check(db.cached_statement_count() > single, "statements prepared on several pooled connections");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_read_pool passed.\n";
+}
+
+void test_maintenance() {
+    std::string db_path = "test_database_maintain.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        Database db(db_path);
+        std::cout << "Testing maintenance after bulk deletes...\n";
+        std::string body(4000, 'x');
+        for (int i = 0; i < 300; ++i) {
+            auto p = make_problem(i, "local", "easy", "");
+            p.description = body + std::to_string(i);
+            db.add_problem_with_cases(p, {{body, body, true}});
+        }
+        auto before = db.maintain();
+        check(before.wal_truncated, "WAL checkpointed and truncated");
+        for (int i = 0; i < 300; ++i) db.delete_problem(i + 1);
+        auto r = db.maintain();
+        std::cout << "  reclaimed " << r.reclaimed_bytes() << " bytes, " << r.pages_vacuumed << " pages\n";
+        check(r.pages_vacuumed > 0 && r.free_pages_left == 0, "free pages released");
+        check(r.bytes_after < before.bytes_after, "file shrinks below its pre-delete size");
+        check(r.wal_truncated && r.reclaimed_bytes() > 0, "reclaimed bytes reported");
+        check(db.count_problems(ProblemQuery{}) == 0, "deletes committed");
+
+        db.add_problem(make_problem(1000, "local", "easy", ""));
+        check(!db.get_problem("p1000").id.empty(), "writes continue after maintenance");
+        auto full = db.maintain(std::chrono::milliseconds(0), true);
+        check(!full.converted, "new databases already use incremental auto-vacuum");
+    }
+    std::filesystem::remove(db_path);
+
+    std::cout << "Testing conversion of a database without auto-vacuum...\n";
+    {
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        raw.exec("CREATE TABLE legacy (x INTEGER)");
+    }
+    {
+        Database db(db_path);
+        // Gaps in the rowids: the converting VACUUM is free to renumber them
+        for (int i = 0; i < 20; ++i) {
+            auto p = make_problem(i, "local", "easy", "");
+            p.title = "Vacuum title " + std::to_string(i * 1001);
+            db.add_problem(p);
+        }
+        for (int i = 0; i < 20; i += 2) db.delete_problem(db.tid_for_problem_id("p" + std::to_string(i)));
+        check(db.maintain(std::chrono::milliseconds(0), true).converted, "full maintenance converts");
+        check(!db.maintain(std::chrono::milliseconds(0), true).converted, "conversion runs once");
+        auto hits = db.search_problems("title 19019");
+        check(hits.size() == 1 && hits[0].problem.id == "p19", "search hits survive the VACUUM");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_maintenance passed.\n";
+}
+
+void test_text_encoding() {
+    using utils::is_valid_utf8;
+    using utils::is_valid_utf8_scalar;
+    std::cout << "Testing UTF-8 validation...\n";
+    const std::string long_ascii(100, 'a');
+    const std::vector<std::pair<std::string, bool>> cases = {
+        {"", true},
+        {long_ascii, true},
+        {long_ascii + "统计区间和 😀 é", true},
+        {long_ascii + "\xF4\x8F\xBF\xBF", true},      // U+10FFFF
+        {long_ascii + "\x80", false},                    // Stray continuation
+        {long_ascii + "\xC0\xAF", false},               // Overlong '/'
+        {long_ascii + "\xE0\x80\xAF", false},          // Overlong three-byte form
+        {long_ascii + "\xED\xA0\x80", false},          // Surrogate
+        {long_ascii + "\xF4\x90\x80\x80", false},     // Above U+10FFFF
+        {long_ascii + "\xE7\xBB", false},               // Truncated at the end
+        {std::string(15, 'a') + "\xE7\xBB\x9F" + long_ascii, true},  // Sequence spans a block boundary
+        {std::string(15, 'a') + "\xE7" + long_ascii, false},
+    };
+    for (const auto& [text, valid] : cases) {
+        check(is_valid_utf8(text) == valid, "is_valid_utf8 on case of length " + std::to_string(text.size()));
+        check(is_valid_utf8_scalar(text) == valid, "scalar validator agrees");
+    }
+    check(utils::ensure_utf8_lossy("ok\xFFok") != "ok\xFFok" &&
+              is_valid_utf8(utils::ensure_utf8_lossy("ok\xFFok")),
+          "lossy conversion repairs invalid text");
+
+    std::string db_path = "test_database_utf8.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        Database db(db_path);
+        auto p = make_problem(1, "local", "easy", "");
+        p.title = "Bad \xC3 title";
+        db.add_problem_with_cases(p, {{"1\n", "2\xFF\n", true}});
+        check(is_valid_utf8(db.get_problem("p1").title), "invalid text repaired on write");
+        check(is_valid_utf8(db.get_test_cases("p1")[0].second), "test case output repaired on write");
+        db.add_problem(make_problem(2, "local", "easy", ""));
+    }
+    {
+        // Rows written by an older version that never validated
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("UPDATE problems SET title = 'Old ' || x'E7BB' || ' title', tags = x'FF' WHERE id = 'p2'");
+        // A bad problem id that test cases, a review and history refer to
+        raw.exec("PRAGMA foreign_keys = ON");
+        raw.exec("INSERT INTO problems (id, source, title, created_at) VALUES ('bad' || x'FF', 'local', 'Bad id', 1)");
+        raw.exec("INSERT INTO test_cases (problem_id, input, output) VALUES ('bad' || x'FF', '1', '1')");
+        raw.exec("INSERT INTO reviews (problem_id, next_review) VALUES ('bad' || x'FF', 5)");
+        raw.exec("INSERT INTO mistakes (problem_id, type) VALUES ('bad' || x'FF', 'WA')");
+        raw.exec("INSERT INTO attempts (problem_id, timestamp, verdict) VALUES ('bad' || x'FF', 1, 'WA')");
+        raw.exec("PRAGMA user_version = 4");
+    }
+    {
+        std::cout << "Testing upgrade repairs stored text...\n";
+        Database db(db_path);
+        check(db.schema_version() == Database::kSchemaVersion, "text migration applied");
+        auto p2 = db.get_problem("p2");
+        check(is_valid_utf8(p2.title) && p2.title.rfind("Old ", 0) == 0, "old title repaired");
+        check(p2.tags == "?", "old tags repaired");
+        check(db.get_problem("p1").title == "Bad ? title", "rows already repaired on write unchanged");
+        const std::string rekeyed = utils::ensure_utf8_lossy("bad\xFF");
+        check(db.get_problem(rekeyed).title == "Bad id", "bad problem id repaired");
+        check(db.get_test_cases(rekeyed).size() == 1 && db.get_review(rekeyed).next_review == 5,
+              "test cases and review follow the repaired id");
+        SQLite::Database raw(db_path, SQLite::OPEN_READONLY);
+        SQLite::Statement fk(raw, "PRAGMA foreign_key_check");
+        check(!fk.executeStep(), "no dangling references after re-keying");
+        SQLite::Statement moved(raw, "SELECT (SELECT COUNT(*) FROM mistakes WHERE problem_id = ?1) + "
+                                     "(SELECT COUNT(*) FROM attempts WHERE problem_id = ?1)");
+        moved.bind(1, rekeyed);
+        check(moved.executeStep() && moved.getColumn(0).getInt() == 2, "history follows the repaired id");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_text_encoding passed.\n";
+}
+
+void test_stable_tids() {
+    std::string db_path = "test_database_tid.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    {
+        Database db(db_path);
+        std::cout << "Testing TID allocation...\n";
+        for (int i = 1; i <= 4; ++i) db.add_problem(make_problem(i, "local", "easy", ""));
+        check(db.get_problem("p4").display_id == 4, "TIDs allocated in insert order");
+        check(db.problem_id_for_tid(2) == "p2" && db.tid_for_problem_id("p3") == 3, "map resolves both ways");
+
+        db.delete_problem(4);
+        db.delete_problem(2);
+        check(db.problem_id_for_tid(4).empty() && db.tid_for_problem_id("p2") == 0, "deleted TIDs leave the map");
+        db.add_problem(make_problem(5, "local", "easy", ""));
+        check(db.get_problem("p5").display_id == 5, "deleted TIDs are not reused");
+        db.add_problem(make_problem(2, "local", "easy", ""));
+        check(db.tid_for_problem_id("p2") == 6, "re-added problem gets a fresh TID");
+        auto p3 = db.get_problem("p3");
+        p3.title = "Renamed";
+        db.add_problem(p3);
+        check(db.get_problem_by_display_id(3).title == "Renamed", "updates keep the TID");
+        auto summary = db.get_problem_summary_by_display_id(3);
+        check(summary && summary->id == "p3" && summary->title == "Renamed", "summary by TID");
+        check(!db.get_problem_summary_by_display_id(4), "no summary for a deleted TID");
+
+        db.maintain(std::chrono::milliseconds(0), true);  // May VACUUM
+        check(db.get_problem_by_display_id(3).id == "p3" && db.problem_id_for_tid(5) == "p5",
+              "TIDs survive maintenance");
+    }
+    {
+        // Rows inserted by another connection without a TID
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("INSERT INTO problems (id, title, created_at) VALUES ('raw', 'Raw', 1)");
+    }
+    {
+        Database db(db_path);
+        check(db.problem_id_for_tid(7) == "raw", "trigger assigns the next TID to raw inserts");
+        db.add_problem(make_problem(8, "local", "easy", ""));
+        check(db.get_problem("p8").display_id == 8, "allocator continues after the trigger");
+    }
+    {
+        // A schema-5 library: TIDs were rowids and may have gaps
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        raw.exec("DROP TRIGGER problems_tid_ai");
+        raw.exec("DROP TRIGGER problems_tid_assign");
+        raw.exec("DROP INDEX idx_problems_tid");
+        raw.exec("DROP TABLE tid_allocator");
+        raw.exec("DROP TRIGGER problems_fts_tid");
+        raw.exec("UPDATE problems SET tid = NULL");
+        raw.exec("PRAGMA user_version = 5");
+    }
+    {
+        std::cout << "Testing upgrade keeps the old numbers...\n";
+        Database db(db_path);
+        for (const auto& p : db.get_all_problems()) {
+            SQLite::Database raw(db_path, SQLite::OPEN_READONLY);
+            SQLite::Statement q(raw, "SELECT rowid FROM problems WHERE id = ?");
+            q.bind(1, p.id);
+            check(q.executeStep() && q.getColumn(0).getInt() == p.display_id, "TID initialised from rowid");
+        }
+        int max_tid = 0;
+        for (const auto& p : db.get_all_problems()) max_tid = std::max(max_tid, p.display_id);
+        db.add_problem(make_problem(9, "local", "easy", ""));
+        check(db.get_problem("p9").display_id == max_tid + 1, "allocator starts after the largest TID");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_stable_tids passed.\n";
+}
+
+void test_cascading_deletes() {
+    std::string db_path = "test_database_cascade.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    auto rows = [&](const std::string& sql) {
+        SQLite::Database raw(db_path, SQLite::OPEN_READONLY);
+        SQLite::Statement q(raw, sql);
+        return q.executeStep() ? q.getColumn(0).getInt() : -1;
+    };
+    auto seed = [](Database& db, int from, int to) {
+        for (int i = from; i <= to; ++i) {
+            ReviewItem r;
+            r.problem_id = "p" + std::to_string(i);
+            r.next_review = 86400LL * i;
+            db.add_problem_with_cases(make_problem(i, "local", "easy", "WA"), {{"1\n", "1\n", true}, {"2\n", "2\n", false}}, r);
+            db.log_mistake(r.problem_id, "WA", "off by one");
+            Attempt a;
+            a.problem_id = r.problem_id;
+            a.timestamp = 1000 + i;
+            a.verdict = "WA";
+            db.record_attempt(a);
+        }
+    };
+    {
+        Database db(db_path);
+        std::cout << "Testing batch delete cascades...\n";
+        seed(db, 1, 6);
+        check(db.delete_problems({2, 4, 99, 6}) == 3, "unknown TIDs ignored");
+        check(rows("SELECT COUNT(*) FROM test_cases") == 6, "test cases cascade");
+        check(rows("SELECT COUNT(*) FROM reviews") == 3 && rows("SELECT COUNT(*) FROM mistakes") == 3,
+              "reviews and mistakes cascade");
+        check(rows("SELECT COUNT(*) FROM attempts") == 6, "attempt history kept");
+        check(db.get_library_stats(86400LL * 6).due_reviews == 3, "due counters follow cascaded reviews");
+        check(db.problem_id_for_tid(4).empty() && db.get_problem("p4").id.empty(), "deleted problems gone");
+        db.delete_problem(1);
+        check(rows("SELECT COUNT(*) FROM test_cases WHERE problem_id = 'p1'") == 0, "single delete cascades");
+    }
+    {
+        // A schema-6 library: child tables without ON DELETE CASCADE, plus an orphan row
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        for (std::string t : {"mistakes", "reviews", "test_cases"}) {
+            raw.exec("ALTER TABLE " + t + " RENAME TO " + t + "_v6");
+            raw.exec("CREATE TABLE " + t + " AS SELECT * FROM " + t + "_v6");
+            raw.exec("DROP TABLE " + t + "_v6");
+        }
+        raw.exec("INSERT INTO test_cases (id, problem_id, input, output, is_sample) VALUES (100, 'gone', '', '', 1)");
+        raw.exec("PRAGMA user_version = 6");
+    }
+    {
+        std::cout << "Testing upgrade adds the cascades...\n";
+        Database db(db_path);
+        check(rows("SELECT COUNT(*) FROM sqlite_master WHERE name IN ('mistakes', 'reviews', 'test_cases') "
+                   "AND sql LIKE '%ON DELETE CASCADE%'") == 3, "child tables rebuilt");
+        check(rows("SELECT COUNT(*) FROM test_cases") == 4, "rows kept, orphans dropped");
+        check(rows("SELECT COUNT(*) FROM sqlite_master WHERE name = 'idx_test_cases_problem'") == 1, "indexes recreated");
+        db.delete_problems({3});
+        check(rows("SELECT COUNT(*) FROM test_cases") == 2 && rows("SELECT COUNT(*) FROM reviews") == 1,
+              "upgraded tables cascade");
+        check(db.get_library_stats(86400LL * 6).due_reviews == 1, "review counters rebuilt");
+        seed(db, 7, 7);
+        check(db.get_test_cases("p7").size() == 2, "AUTOINCREMENT still works after the rebuild");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_cascading_deletes passed.\n";
+}
+
+void test_tags() {
+    std::string db_path = "test_database_tags.db";
+    if (std::filesystem::exists(db_path)) std::filesystem::remove(db_path);
+    auto tag = [](Database& db, const std::string& name) {
+        auto rows = db.get_tag_stats(name);
+        return rows.empty() ? TagStats{} : rows[0];
+    };
+    {
+        Database db(db_path);
+        std::cout << "Testing tag links and counters...\n";
+        const char* verdicts[] = {"AC", "WA", "", "AC", "TLE", "SKIPPED"};
+        for (int i = 1; i <= 6; ++i) {
+            auto p = make_problem(i, "local", "easy", verdicts[i - 1]);
+            p.tags = i % 2 ? " dp, greedy ,dp" : "graph,dp";
+            db.add_problem(p);
+        }
+        auto dp = tag(db, "dp");
+        check(dp.problems == 6 && dp.attempted == 4 && dp.solved == 2, "dp counts every problem once");
+        check(tag(db, "greedy").problems == 3 && tag(db, "graph").problems == 3, "tags trimmed and split");
+        check(db.get_tag_stats().size() == 3 && db.get_tag_stats()[0].tag == "dp", "most problems first");
+
+        ProblemQuery q;
+        q.tag = "graph";
+        check(db.count_problems(q) == 3, "tag filter");
+        q.status = "ac";
+        auto page = db.query_problems(q);
+        check(page.rows.size() == 1 && page.rows[0].id == "p4", "tag filter combines with status");
+        ProblemQuery paged;
+        paged.tag = "dp";
+        paged.limit = 2;
+        std::vector<std::string> walked;
+        while (true) {
+            auto pg = db.query_problems(paged);
+            for (const auto& r : pg.rows) walked.push_back(r.id);
+            if (!pg.next) break;
+            paged.after = pg.next;
+        }
+        check(walked.size() == 6 && walked[0] == "p6" && walked[5] == "p1", "paging a common tag keeps the order");
+
+        Attempt a;
+        a.problem_id = "p2";
+        a.timestamp = 2000;
+        a.verdict = "AC";
+        db.record_attempt(a);
+        check(tag(db, "graph").solved == 2 && tag(db, "graph").attempted == 2, "verdict change moves counters");
+        auto p3 = db.get_problem("p3");
+        p3.tags = "math";
+        p3.last_verdict = "AC";
+        db.add_problem(p3);
+        check(tag(db, "greedy").problems == 2 && tag(db, "greedy").attempted == 2, "retagged problem leaves old tags");
+        check(tag(db, "math").problems == 1 && tag(db, "math").solved == 1, "and joins new ones with its new verdict");
+        db.delete_problems({db.tid_for_problem_id("p1"), db.tid_for_problem_id("p4")});
+        dp = tag(db, "dp");
+        check(dp.problems == 3 && dp.solved == 1 && dp.attempted == 2, "deletes leave the counters");
+        check(tag(db, "graph").problems == 2, "deleted problem unlinked");
+
+        auto weakest = db.get_weakest_tags(5, 1);
+        check(!weakest.empty() && weakest[0].tag == "greedy" && weakest[0].solve_rate() == 0.0, "weakest tag first");
+        check(weakest.back().tag == "math", "strongest tag last");
+
+        std::cout << "Testing memory mistakes by tag...\n";
+        db.upsert_memory_mistake("dp", "Forget to init DP array", "p1");
+        db.upsert_memory_mistake("graph, bfs", "Visited set too late", "p2");
+        db.upsert_memory_mistake("graph, bfs", "Visited set too late", "p2");
+        db.upsert_memory_mistake("math", "Overflow in product", "p3");
+        auto hits = db.get_memory_mistakes_for_tags("bfs,dp");
+        check(hits.size() == 2 && hits[0].pattern == "Visited set too late", "mistakes matched by tag, most frequent first");
+        check(db.get_memory_mistakes_for_tags("strings").empty(), "no match for unknown tags");
+        check(tag(db, "bfs").tag.empty(), "memory-only tags have no problems");
+    }
+    {
+        // A schema-7 library: only the comma-separated columns
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        for (const char* t : {"problem_tags_ai", "problem_tags_au", "problem_tags_bd", "problem_tags_verdict_au",
+                              "memory_mistake_tags_ai", "memory_mistake_tags_au"})
+            raw.exec(std::string("DROP TRIGGER ") + t);
+        raw.exec("DROP TABLE problem_tags");
+        raw.exec("DROP TABLE memory_mistake_tags");
+        raw.exec("DROP TABLE tags");
+        raw.exec("PRAGMA user_version = 7");
+    }
+    {
+        std::cout << "Testing upgrade builds the tag tables...\n";
+        Database db(db_path);
+        auto dp = tag(db, "dp");
+        check(dp.problems == 3 && dp.solved == 1 && dp.attempted == 2, "counters backfilled");
+        check(tag(db, "math").solved == 1, "backfill uses the last verdict");
+        check(db.get_memory_mistakes_for_tags("dp").size() == 1, "memory mistakes linked");
+        auto p = make_problem(7, "local", "easy", "WA");
+        p.tags = "dp";
+        db.add_problem(p);
+        check(tag(db, "dp").problems == 4, "triggers installed");
+    }
+    {
+        // Other clients (sqlite3 CLI, older builds) have none of the app's SQL functions
+        SQLite::Database raw(db_path, SQLite::OPEN_READWRITE);
+        SQLite::Statement q(raw, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' AND sql LIKE '%shuati%'");
+        check(q.executeStep() && q.getColumn(0).getInt() == 0, "no trigger calls an app-defined function");
+        raw.exec("INSERT INTO problems (id, title, tags, last_verdict, created_at) "
+                 "VALUES ('raw', 'Raw', ' strings ,dp,, strings', 'AC', 1)");
+        raw.exec("UPDATE problems SET tags = 'graph' || char(9) WHERE id = 'p7'");
+        raw.exec("UPDATE problems SET description = 'edited' WHERE id = 'p2'");
+        raw.exec("INSERT INTO memory_mistakes (tags, pattern) VALUES ('strings', 'Off by one in substr')");
+    }
+    {
+        std::cout << "Testing tag writes from other clients...\n";
+        Database db(db_path);
+        auto strings = tag(db, "strings");
+        check(strings.problems == 1 && strings.solved == 1, "outside insert split and linked");
+        check(tag(db, "dp").problems == 4, "outside insert counted once per tag, retag unlinked");
+        check(tag(db, "graph").problems == 3, "outside retag trimmed and linked");
+        check(db.get_memory_mistakes_for_tags("strings").size() == 1, "outside memory mistake linked");
+    }
+    std::filesystem::remove(db_path);
+    std::cout << "test_tags passed.\n";
+}
+
+int main() {
+    try {
+        test_query_problems();
+        test_search_problems();
+        test_statement_cache();
+        test_add_problem_with_cases();
+        test_migrations();
+        test_attempts();
+        test_library_stats();
+        test_write_queue();
+        test_read_pool();
+        test_db_profile();
+        test_maintenance();
+        test_text_encoding();
+        test_stable_tids();
+        test_cascading_deletes();
+        test_tags();
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
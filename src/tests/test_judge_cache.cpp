@@ -0,0 +1,118 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include "shuati/judge_cache.hpp"
+
+using namespace shuati;
+
+namespace {
+
+void fail(const std::string& msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    exit(1);
+}
+
+JudgeResult make_result(Verdict v, int time_ms, int memory_kb, const std::string& output = "") {
+    JudgeResult r;
+    r.verdict = v;
+    r.time_ms = time_ms;
+    r.memory_kb = memory_kb;
+    r.output = output;
+    return r;
+}
+
+void test_roundtrip_and_invalidation() {
+    std::cout << "[Test] Cache round-trip and key invalidation..." << std::endl;
+    auto dir = std::filesystem::temp_directory_path() / "shuati_judge_cache_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto exe = dir / "solution";
+    { std::ofstream f(exe, std::ios::binary); f << "binary-v1"; }
+    auto cache_path = dir / "judge_cache.json";
+
+    TestCase tc{"1 2\n", "3\n", true};
+    TestCase wa_tc{"5 5\n", "10\n", true};
+
+    std::string exe_hash = JudgeCache::hash_executable(exe.string());
+    if (exe_hash.empty()) fail("executable hash should not be empty");
+    if (!JudgeCache::hash_executable((dir / "missing").string()).empty()) fail("missing file should hash to empty");
+
+    auto key = JudgeCache::make_key(exe_hash, tc, 2000, 262144);
+    auto wa_key = JudgeCache::make_key(exe_hash, wa_tc, 2000, 262144);
+    {
+        JudgeCache cache(cache_path);
+        if (cache.lookup(key)) fail("fresh cache should miss");
+        cache.store(key, make_result(Verdict::AC, 12, 1024, "3\n"), 2000, 0.2);
+        cache.store(wa_key, make_result(Verdict::WA, 7, 900, "9\n"), 2000, 0.2);
+        cache.store("se-key", make_result(Verdict::SE, 0, 0), 2000, 0.2);
+        cache.store("tle-key", make_result(Verdict::TLE, 2000, 900), 2000, 0.2);
+        cache.store("mle-key", make_result(Verdict::MLE, 30, 262144), 2000, 0.2);
+        cache.store("slow-ac-key", make_result(Verdict::AC, 1700, 900), 2000, 0.2);
+        cache.save();
+    }
+    {
+        JudgeCache cache(cache_path);
+        auto hit = cache.lookup(key);
+        if (!hit) fail("stored AC entry should be replayed");
+        if (!hit->cached || hit->verdict != Verdict::AC || hit->time_ms != 12 || hit->memory_kb != 1024)
+            fail("replayed AC entry mismatch");
+        if (!hit->output.empty()) fail("AC output should not be cached");
+
+        auto wa_hit = cache.lookup(wa_key);
+        if (!wa_hit || wa_hit->verdict != Verdict::WA || wa_hit->output != "9\n")
+            fail("WA entry should keep its output");
+        if (cache.lookup("se-key")) fail("system errors must not be cached");
+        if (cache.lookup("tle-key") || cache.lookup("mle-key")) fail("TLE and MLE depend on load and must not be cached");
+        if (cache.lookup("slow-ac-key")) fail("results near the time limit must not be cached");
+        if (cache.hits() != 2) fail("hit counter mismatch");
+
+        // Any change to expected output, limits or binary yields a different key
+        TestCase edited = tc;
+        edited.output = "4\n";
+        if (JudgeCache::make_key(exe_hash, edited, 2000, 262144) == key) fail("expected output must be part of key");
+        if (JudgeCache::make_key(exe_hash, tc, 1000, 262144) == key) fail("time limit must be part of key");
+        { std::ofstream f(exe, std::ios::binary); f << "binary-v2"; }
+        if (JudgeCache::hash_executable(exe.string()) == exe_hash) fail("rebuilt binary must change hash");
+        cache.save();
+    }
+    {
+        // Only the AC entry is used this run, so the WA entry is dropped on save
+        JudgeCache cache(cache_path);
+        if (!cache.lookup(key)) fail("entry used in last run should persist");
+        cache.save();
+    }
+    {
+        JudgeCache cache(cache_path);
+        if (!cache.lookup(key)) fail("touched entry should survive");
+        if (cache.lookup(wa_key)) fail("untouched entry should be pruned");
+    }
+
+    std::filesystem::remove_all(dir);
+    std::cout << "PASS" << std::endl;
+}
+
+void test_corrupt_cache_is_empty() {
+    std::cout << "[Test] Corrupt cache file..." << std::endl;
+    auto path = std::filesystem::temp_directory_path() / "shuati_judge_cache_corrupt.json";
+    { std::ofstream f(path); f << "{ not json"; }
+    JudgeCache cache(path);
+    if (cache.lookup("anything")) fail("corrupt cache should behave as empty");
+    std::filesystem::remove(path);
+    std::cout << "PASS" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    try {
+        test_roundtrip_and_invalidation();
+        test_corrupt_cache_is_empty();
+        std::cout << "All Judge Cache Tests Passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -136,11 +136,191 @@ int main() {
     #endif
 }
 
+void test_output_limit() {
+    std::cout << "[Test] Output Limit Check..." << std::endl;
+    // Prints forever: must be stopped by the output limit long before the time limit
+    std::string code = R"(
+#include <cstdio>
+int main() {
+    for (;;) std::fputs("spam spam spam spam\n", stdout);
+}
+    )";
+    std::ofstream src("ole_test.cpp");
+    src << code;
+    src.close();
+
+    Judge judge;
+    judge.set_output_limit(1 * 1024 * 1024);
+    TestCase tc;
+    tc.input = ""; tc.output = ""; tc.is_sample = false;
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = judge.judge("ole_test.cpp", "cpp", {tc}, 5000, 256 * 1024);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::filesystem::remove("ole_test.cpp");
+    if (results.empty() || results[0].verdict != Verdict::OLE) {
+        std::cerr << "FAIL: Expected OLE, got "
+                  << (results.empty() ? std::string("nothing") : results[0].verdict_str()) << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS: OLE caught in " << elapsed << "ms" << std::endl;
+}
+
+void test_stderr_capped() {
+    std::cout << "[Test] Stderr Capped Read..." << std::endl;
+    // 4MB of stderr then a non-zero exit: error_output must stay small
+    std::string code = R"(
+#include <cstdio>
+#include <string>
+int main() {
+    std::string line(1023, 'e');
+    for (int i = 0; i < 4096; ++i) std::fprintf(stderr, "%s\n", line.c_str());
+    return 1;
+}
+    )";
+    std::ofstream src("stderr_test.cpp");
+    src << code;
+    src.close();
+
+    Judge judge;
+    TestCase tc;
+    tc.input = ""; tc.output = ""; tc.is_sample = false;
+    auto results = judge.judge("stderr_test.cpp", "cpp", {tc}, 5000, 256 * 1024);
+    std::filesystem::remove("stderr_test.cpp");
+
+    if (results.empty() || results[0].verdict != Verdict::RE) {
+        std::cerr << "FAIL: Expected RE from stderr flood" << std::endl;
+        exit(1);
+    }
+    if (results[0].error_output.size() > 65 * 1024 ||
+        results[0].error_output.find("[truncated]") == std::string::npos) {
+        std::cerr << "FAIL: stderr not capped, size=" << results[0].error_output.size() << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS: stderr capped at " << results[0].error_output.size() << " bytes" << std::endl;
+}
+
+void test_repeated_timing() {
+    std::cout << "[Test] Repeated Timing Near Limit..." << std::endl;
+    // Burns ~600ms of CPU: inside a 50% band of a 1000ms limit, so it is re-run
+    std::string code = R"(
+#include <ctime>
+#include <cstdio>
+int main() {
+    volatile unsigned long long x = 0;
+    while (std::clock() < CLOCKS_PER_SEC * 6 / 10) x = x + 1;
+    std::printf("ok\n");
+    return 0;
+}
+    )";
+    std::ofstream src("repeat_test.cpp");
+    src << code;
+    src.close();
+
+    Judge judge;
+    std::string exe;
+    try {
+        exe = judge.prepare("repeat_test.cpp", "cpp");
+    } catch (const std::exception& e) {
+        std::cerr << "FAIL: compile error: " << e.what() << std::endl;
+        exit(1);
+    }
+    TestCase tc{"", "ok\n", false};
+
+    RepeatPolicy policy;
+    policy.repeats = 3;
+    policy.band = 0.5;
+    auto res = judge.run_prepared_repeated(exe, tc, 1000, 256 * 1024, policy);
+
+    // Fast case: never re-run
+    RepeatPolicy tight;
+    tight.repeats = 3;
+    tight.band = 0.01;
+    auto single = judge.run_prepared_repeated(exe, tc, 10000, 256 * 1024, tight);
+
+    judge.cleanup_prepared(exe, "cpp");
+    std::filesystem::remove("repeat_test.cpp");
+
+    if (res.timing.runs != 3) {
+        std::cerr << "FAIL: expected 3 timed runs, got " << res.timing.runs
+                  << " (verdict " << res.verdict_str() << ", " << res.time_ms << "ms)" << std::endl;
+        exit(1);
+    }
+    if (!(res.timing.min_ms <= res.timing.median_ms && res.timing.median_ms <= res.timing.max_ms) ||
+        res.time_ms != res.timing.median_ms) {
+        std::cerr << "FAIL: inconsistent timing stats" << std::endl;
+        exit(1);
+    }
+    if (res.verdict != (res.timing.median_ms > 1000 ? Verdict::TLE : Verdict::AC)) {
+        std::cerr << "FAIL: verdict not decided on the median" << std::endl;
+        exit(1);
+    }
+    if (single.timing.runs != 1) {
+        std::cerr << "FAIL: fast case should not be re-run" << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS: median " << res.timing.median_ms << "ms (CV " << res.timing.cv << ")" << std::endl;
+}
+
+void test_repeated_flaky_answer() {
+    std::cout << "[Test] Flaky Answer Among Repeats..." << std::endl;
+    // Near the limit like repeat_test, but the third run (second repeat) prints a wrong answer
+    std::string count_file = (std::filesystem::current_path() / "flaky_count.txt").string();
+    std::filesystem::remove(count_file);
+    std::string code = R"(
+#include <ctime>
+#include <cstdio>
+int main() {
+    int n = 0;
+    if (FILE* f = std::fopen(COUNT_FILE, "r")) { std::fscanf(f, "%d", &n); std::fclose(f); }
+    if (FILE* f = std::fopen(COUNT_FILE, "w")) { std::fprintf(f, "%d", n + 1); std::fclose(f); }
+    volatile unsigned long long x = 0;
+    while (std::clock() < CLOCKS_PER_SEC * 6 / 10) x = x + 1;
+    std::printf(n == 2 ? "bad\n" : "ok\n");
+    return 0;
+}
+    )";
+    std::string escaped;
+    for (char c : count_file) escaped += (c == '\\' ? "\\\\" : std::string(1, c));
+    std::ofstream src("flaky_test.cpp");
+    src << "#define COUNT_FILE \"" << escaped << "\"\n" << code;
+    src.close();
+
+    Judge judge;
+    std::string exe;
+    try {
+        exe = judge.prepare("flaky_test.cpp", "cpp");
+    } catch (const std::exception& e) {
+        std::cerr << "FAIL: compile error: " << e.what() << std::endl;
+        exit(1);
+    }
+    TestCase tc{"", "ok\n", false};
+    RepeatPolicy policy;
+    policy.repeats = 3;
+    policy.band = 0.5;
+    auto res = judge.run_prepared_repeated(exe, tc, 1000, 256 * 1024, policy);
+
+    judge.cleanup_prepared(exe, "cpp");
+    std::filesystem::remove("flaky_test.cpp");
+    std::filesystem::remove(count_file);
+
+    if (res.verdict != Verdict::WA) {
+        std::cerr << "FAIL: a wrong answer in one repeat must fail the case, got " << res.verdict_str() << std::endl;
+        exit(1);
+    }
+    std::cout << "PASS: flaky run reported as " << res.verdict_str() << std::endl;
+}
 
 int main() {
     try {
         test_large_output();
         test_mle();
+        test_output_limit();
+        test_stderr_capped();
+        test_repeated_timing();
+        test_repeated_flaky_answer();
         std::cout << "All Judge Complex Tests Passed!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
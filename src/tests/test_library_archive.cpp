@@ -0,0 +1,173 @@
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "shuati/library_archive.hpp"
+
+using namespace shuati;
+namespace fs = std::filesystem;
+
+static void check(bool cond, const std::string& msg) {
+    if (!cond) {
+        std::cerr << "FAILED: " << msg << "\n";
+        exit(1);
+    }
+}
+
+static void remove_db(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm"}) fs::remove(path + suffix);
+}
+
+// 20 problems with cases, a review, a mistake and attempts each, plus memory rows
+static void seed(Database& db) {
+    for (int i = 0; i < 20; ++i) {
+        Problem p;
+        p.id = "p" + std::to_string(i);
+        p.source = i % 2 ? "luogu" : "codeforces";
+        p.title = "Problem " + std::to_string(i);
+        p.url = "https://example.com/" + p.id;
+        p.description = "<p>统计区间和</p>";
+        p.tags = "dp";
+        p.created_at = 1700000000 + i;
+        db.add_problem_with_cases(p, {{"1 2\n", "3\n", true}, {std::string(100000, '9'), "big\n", false}});
+
+        ReviewItem r;
+        r.problem_id = p.id;
+        r.next_review = 1700100000 + i;
+        r.interval = 3;
+        r.ease_factor = 2.36;
+        db.upsert_review(r);
+        db.log_mistake(p.id, "WA", "off by one");
+        for (int k = 0; k < 3; ++k) {
+            Attempt a;
+            a.problem_id = p.id;
+            a.timestamp = 1700000000 + i * 100 + k;
+            a.verdict = k == 2 ? "AC" : "WA";
+            a.total_count = 2;
+            a.pass_count = k == 2 ? 2 : 1;
+            a.max_time_ms = 10 + k;
+            db.record_attempt(a);
+        }
+    }
+    db.upsert_memory_mistake("dp", "Forget to init DP array", "p1");
+    db.upsert_mastery("Binary Search", 72.5);
+    db.update_user_profile(1500, "{\"lang\":\"cpp\"}");
+}
+
+int main() {
+    const std::string src_path = "test_archive_src.db";
+    const std::string dst_path = "test_archive_dst.db";
+    const fs::path gz = "test_archive.ndjson.gz";
+    const fs::path plain = "test_archive.ndjson";
+    remove_db(src_path);
+    remove_db(dst_path);
+
+    try {
+        std::cout << "Testing export...\n";
+        ArchiveCounts exported;
+        {
+            Database src(src_path);
+            seed(src);
+            long long reported = 0;
+            exported = LibraryArchive::export_to(src, gz, [&](long long rows, double) { reported = rows; });
+            check(exported.problems == 20 && exported.test_cases == 40 && exported.reviews == 20, "problem rows exported");
+            check(exported.mistakes == 20 && exported.attempts == 60 && exported.memory == 3, "history and memory exported");
+            check(reported == exported.rows(), "progress reaches the final row count");
+            check(fs::exists(gz) && !fs::exists(fs::path(gz.string() + ".partial")), "archive renamed into place");
+            LibraryArchive::export_to(src, plain);
+            check(fs::file_size(gz) < fs::file_size(plain) / 4, "gzip archive compressed");
+        }
+
+        std::cout << "Testing import into an empty library...\n";
+        {
+            Database dst(dst_path);
+            auto counts = LibraryArchive::import_from(dst, gz, ConflictPolicy::Skip);
+            check(counts.rows() == exported.rows() && counts.skipped == 0, "every row imported");
+            check(dst.get_problem("p7").title == "Problem 7", "problem fields");
+            auto cases = dst.get_test_cases("p7");
+            check(cases.size() == 2 && cases[1].first.size() == 100000, "test cases");
+            check(dst.get_review("p7").next_review == 1700100007, "review");
+            auto stats = dst.get_attempt_stats("p7");
+            check(stats && stats->attempts == 3 && stats->attempts_to_ac == 3, "attempt rollups rebuilt");
+            check(dst.get_library_stats().total == 20, "dashboard counters follow imported rows");
+            check(dst.get_mastery("Binary Search") && dst.get_mastery("Binary Search")->confidence == 72.5, "mastery");
+            check(dst.get_user_profile().elo_rating == 1500, "default profile replaced by the archived one");
+
+            std::cout << "Testing conflict policies...\n";
+            Problem edited = dst.get_problem("p3");
+            edited.title = "Edited locally";
+            dst.add_problem(edited);
+            counts = LibraryArchive::import_from(dst, plain, ConflictPolicy::Skip);
+            check(counts.rows() == 0 && counts.skipped == exported.rows(), "skip keeps everything local");
+            check(dst.get_problem("p3").title == "Edited locally", "skip leaves the local problem");
+            check(dst.get_test_cases("p3").size() == 2, "skip does not duplicate test cases");
+
+            counts = LibraryArchive::import_from(dst, gz, ConflictPolicy::Replace);
+            check(counts.problems == 20, "replace imports every problem");
+            check(dst.get_problem("p3").title == "Problem 3", "archive wins under replace");
+            check(dst.get_test_cases("p3").size() == 2, "replaced problem's cases are not doubled");
+            check(dst.get_attempt_stats("p3")->attempts == 3, "replaced problem's attempts are not doubled");
+
+            // The same url stored locally under another id
+            dst.delete_problem(dst.get_problem("p5").display_id);
+            Problem local = edited;
+            local.id = "local5";
+            local.url = "https://example.com/p5";
+            dst.add_problem_with_cases(local, {{"0\n", "0\n", true}});
+            counts = LibraryArchive::import_from(dst, gz, ConflictPolicy::Replace);
+            check(counts.problems == 20 && counts.rekeyed == 1, "url conflict under another id reported");
+            check(dst.get_problem("local5").id.empty(), "local id replaced by the archived one");
+            check(dst.get_problem("p5").title == "Problem 5", "archive problem stored under its own id");
+            check(dst.get_test_cases("p5").size() == 2 && dst.get_test_cases("local5").empty(), "cases follow the archive");
+            check(dst.count_problems(ProblemQuery{}) == 20, "no duplicate problem left behind");
+
+            bool threw = false;
+            try {
+                LibraryArchive::import_from(dst, gz, ConflictPolicy::Fail);
+            } catch (const std::exception&) {
+                threw = true;
+            }
+            check(threw, "fail policy aborts on the first conflict");
+            check(dst.count_problems(ProblemQuery{}) == 20, "aborted batch rolled back");
+        }
+
+        std::cout << "Testing truncated and foreign files...\n";
+        {
+            std::ifstream in(plain);
+            std::ofstream out("test_archive_cut.ndjson");
+            std::string line;
+            for (int i = 0; i < 5 && std::getline(in, line); ++i) out << line << "\n";
+        }
+        remove_db(dst_path);
+        {
+            Database dst(dst_path);
+            bool threw = false;
+            try {
+                LibraryArchive::import_from(dst, "test_archive_cut.ndjson", ConflictPolicy::Skip);
+            } catch (const std::exception&) {
+                threw = true;
+            }
+            check(threw, "missing end marker reported");
+            check(dst.count_problems(ProblemQuery{}) == 1, "rows before the cut still imported");
+
+            std::ofstream("test_archive_bad.ndjson") << "{\"hello\":1}\n";
+            threw = false;
+            try {
+                LibraryArchive::import_from(dst, "test_archive_bad.ndjson", ConflictPolicy::Skip);
+            } catch (const std::exception&) {
+                threw = true;
+            }
+            check(threw, "foreign file rejected");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << "\n";
+        return 1;
+    }
+
+    remove_db(src_path);
+    remove_db(dst_path);
+    for (const char* f : {"test_archive.ndjson.gz", "test_archive.ndjson", "test_archive_cut.ndjson", "test_archive_bad.ndjson"})
+        fs::remove(f);
+    std::cout << "test_library_archive passed.\n";
+    return 0;
+}
@@ -101,6 +101,27 @@ Hope this helps!
             std::cerr << "Context missing mastered skill\n";
             exit(1);
         }
+
+        // 5. Tagged patterns come before more frequent untagged ones
+        std::cout << "Testing tag-aware context...\n";
+        for (int i = 0; i < 3; ++i) db.upsert_memory_mistake("", "Integer overflow in sum", "");
+        for (int i = 0; i < 3; ++i) db.upsert_memory_mistake("", "Unsorted input to binary search", "");
+        db.upsert_memory_mistake("graph", "Visited set marked too late", "p1");
+        Problem p;
+        p.id = "p1";
+        p.title = "BFS";
+        p.tags = "graph,bfs";
+        p.last_verdict = "WA";
+        db.add_problem(p);
+        ctx = mm.get_relevant_context("bfs, graph");
+        if (ctx.find("Visited set marked too late") == std::string::npos) {
+            std::cerr << "Context missing tagged mistake\n";
+            exit(1);
+        }
+        if (ctx.find("graph: 0/1 solved") == std::string::npos) {
+            std::cerr << "Context missing tag solve rate\n";
+            exit(1);
+        }
     } // db destructed here and file released
 
     std::cout << "test_memory (parsing & DB) passed!\n";
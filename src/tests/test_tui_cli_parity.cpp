@@ -11,7 +11,7 @@ int main() {
     using namespace shuati::tui;
 
     const std::set<std::string> expected_cli = {
-        "init", "info", "pull", "new", "solve", "list", "delete",
+        "init", "info", "pull", "new", "solve", "list", "search", "delete",
         "record", "test", "hint", "view", "clean", "login",
         "config", "menu", "repl", "tui", "exit"
     };
@@ -13,11 +13,12 @@ std::vector<CommandSpec> tui_command_specs() {
         {"/new", "/new <title>", "创建本地题目", CommandCategory::Problem},
         {"/solve", "/solve [id]", "进入做题工作流", CommandCategory::Problem},
         {"/list", "/list [--filter all|ac|failed|unaudited|review]", "列出题库题目", CommandCategory::Problem},
+        {"/search", "/search <关键词>", "全文搜索题目 (标题、标签、题面)", CommandCategory::Problem},
         {"/view", "/view <id>", "查看测试详情", CommandCategory::Problem},
         {"/test", "/test <id>", "运行测试用例", CommandCategory::Problem},
         {"/hint", "/hint <id>", "获取 AI 提示", CommandCategory::AI},
         {"/record", "/record <id>", "复习推荐检查完成并记录", CommandCategory::Problem},
-        {"/delete", "/delete <id>", "删除题目", CommandCategory::Problem},
+        {"/delete", "/delete <id...>", "删除题目", CommandCategory::Problem},
         {"/clean", "/clean", "清理临时文件", CommandCategory::Project},
         {"/uninstall", "/uninstall", "完全清除所有初始化目录及本地环境", CommandCategory::System},
         {"/login", "/login <platform>", "配置平台登录 Cookie", CommandCategory::Project},
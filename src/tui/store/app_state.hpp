@@ -16,6 +16,8 @@ struct StatusState {
     int total_problems = 0;
     int ac_problems = 0;
     int pending_reviews = 0;
+    int upcoming_reviews = 0;   // Due within the next 7 days
+    std::vector<std::string> weak_tags;  // "dp  40% (2/5)", lowest solve rate first
     std::string last_activity;
     bool loaded = false;
 };
@@ -68,8 +70,15 @@ struct ListState {
         bool passed = false;
         bool review_due = false;
     };
+    // rows holds the first N matching problems; further windows are fetched
+    // with a keyset cursor as the selection reaches the end.
+    static constexpr int PAGE_SIZE = 100;
     std::vector<Row> rows;
     int selected = 0;
+    int total = 0;                 // Rows matching the current filters
+    bool has_more = false;
+    long long next_created_at = 0; // Keyset cursor of the next window
+    long long next_rowid = 0;
     std::string status_filter = "all";
     std::string difficulty_filter = "all";
     std::string source_filter = "all";
@@ -13,14 +13,15 @@
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/component/event.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <fmt/core.h>
 
 #include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
 #include <functional>
 #include <ctime>
 #include <memory>
-#include <unordered_set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -118,10 +119,12 @@ const std::unordered_map<std::string, CmdHint>& hint_table() {
                      "✓ Enter 获取 AI 提示"}},
         {"/view",   {"用法: /view <题号>  查看测试用例和题目信息",
                      "✓ Enter 查看详情"}},
-        {"/delete", {"用法: /delete <题号>  从本地题库删除题目",
+        {"/delete", {"用法: /delete <题号...>  从本地题库删除题目 (可一次多道)",
                      "✓ Enter 删除题目"}},
         {"/record", {"用法: /record <题号>  复习推荐检查完成并记录",
                      "✓ Enter 记录完成度"}},
+        {"/search", {"用法: /search <关键词>  全文搜索标题、标签与题面",
+                     "✓ Enter 搜索题目"}},
         {"/new",    {"用法: /new <标题>  创建一道本地题目",
                      "✓ Enter 创建题目"}},
         {"/login",  {"用法: /login <平台>  例: /login lanqiao",
@@ -205,9 +208,52 @@ void save_config_state(AppState& state) {
     cfg.template_enabled = state.config_state.template_enabled;
     cfg.lanqiao_cookie = state.config_state.lanqiao_cookie;
     cfg.save(Config::config_path(root));
+    cmd::Services::reset_session();
     state.config_state.status_msg = "配置已保存。";
 }
 
+// Fetch the next window of list rows (first window when rows is empty)
+void append_list_page(AppState& state, cmd::Services& svc) {
+    auto& ls = state.list_state;
+    ProblemQuery query;
+    query.status = ls.status_filter;
+    query.difficulty = ls.difficulty_filter;
+    query.source = ls.source_filter;
+    query.limit = ListState::PAGE_SIZE;
+    if (!ls.rows.empty() && ls.has_more) query.after = ProblemCursor{ls.next_created_at, ls.next_rowid};
+    auto page = svc.pm->query_problems(query);
+
+    for (const auto& p : page.rows) {
+        ListState::Row row;
+        row.tid        = p.display_id;
+        row.id         = p.id;
+        row.title      = p.title;
+        row.difficulty = p.difficulty;
+        row.source     = cmd::canonical_source(p.source);
+        row.status     = p.last_verdict.empty() ? "-" : p.last_verdict;
+        row.passed     = (p.last_verdict == "AC");
+        row.review_due = p.review_due;
+        {
+            char buf[16] = {};
+            std::time_t t = static_cast<std::time_t>(p.created_at);
+            struct std::tm tm_val{};
+#ifdef _WIN32
+            localtime_s(&tm_val, &t);
+#else
+            localtime_r(&t, &tm_val);
+#endif
+            std::strftime(buf, sizeof(buf), "%Y-%m-%d", &tm_val);
+            row.date = buf;
+        }
+        ls.rows.push_back(std::move(row));
+    }
+    ls.has_more = page.next.has_value();
+    if (page.next) {
+        ls.next_created_at = page.next->created_at;
+        ls.next_rowid = page.next->rowid;
+    }
+}
+
 void load_list_state(AppState& state, const std::string& status_filter = "all", const std::string& difficulty_filter = "all", const std::string& source_filter = "all") {
     auto root = Config::find_root();
     state.list_state.status_filter = status_filter;
@@ -216,47 +262,29 @@ void load_list_state(AppState& state, const std::string& status_filter = "all",
     if (root.empty()) {
         state.list_state.error = "未找到 .shuati 项目，请先运行 /init";
         state.list_state.rows.clear();
+        state.list_state.has_more = false;
+        state.list_state.total = 0;
         state.list_state.loaded = true;
         return;
     }
     try {
-        auto svc = cmd::Services::load(root);
-        auto problems = svc.pm->filter_problems(svc.pm->list_problems(), status_filter, difficulty_filter, source_filter);
-        
-        auto current_time = std::time(nullptr);
-        auto reviews = svc.db->get_due_reviews(current_time);
-        std::unordered_set<std::string> due_ids;
-        for (const auto& r : reviews) due_ids.insert(r.problem_id);
+        auto svc_ptr = cmd::Services::session(root);
+        auto& svc = *svc_ptr;
 
         std::string prev_id;
         if (state.list_state.selected < static_cast<int>(state.list_state.rows.size())) {
             prev_id = state.list_state.rows[state.list_state.selected].id;
         }
         state.list_state.rows.clear();
-        for (const auto& p : problems) {
-            ListState::Row row;
-            row.tid        = p.display_id;
-            row.id         = p.id;
-            row.title      = p.title;
-            row.difficulty = p.difficulty;
-            row.source     = cmd::canonical_source(p.source);
-            row.status     = p.last_verdict.empty() ? "-" : p.last_verdict;
-            row.passed     = (p.last_verdict == "AC");
-            row.review_due = (due_ids.find(p.id) != due_ids.end());
-            {
-                char buf[16] = {};
-                std::time_t t = static_cast<std::time_t>(p.created_at);
-                struct std::tm tm_val{};
-#ifdef _WIN32
-                localtime_s(&tm_val, &t);
-#else
-                localtime_r(&t, &tm_val);
-#endif
-                std::strftime(buf, sizeof(buf), "%Y-%m-%d", &tm_val);
-                row.date = buf;
-            }
-            state.list_state.rows.push_back(std::move(row));
-        }
+        state.list_state.has_more = false;
+        append_list_page(state, svc);
+
+        ProblemQuery count_query;
+        count_query.status = status_filter;
+        count_query.difficulty = difficulty_filter;
+        count_query.source = source_filter;
+        state.list_state.total = svc.pm->count_problems(count_query);
+
         state.list_state.selected = 0;
         if (!prev_id.empty()) {
             for (int i = 0; i < static_cast<int>(state.list_state.rows.size()); ++i) {
@@ -269,11 +297,27 @@ void load_list_state(AppState& state, const std::string& status_filter = "all",
         state.list_state.error.clear();
     } catch (const std::exception& e) {
         state.list_state.rows.clear();
+        state.list_state.has_more = false;
+        state.list_state.total = 0;
         state.list_state.error = std::string("数据库错误: ") + e.what();
     }
     state.list_state.loaded = true;
 }
 
+void load_more_list_rows(AppState& state) {
+    if (!state.list_state.has_more) return;
+    auto root = Config::find_root();
+    if (root.empty()) return;
+    try {
+        auto svc_ptr = cmd::Services::session(root);
+        auto& svc = *svc_ptr;
+        append_list_page(state, svc);
+    } catch (const std::exception& e) {
+        state.list_state.has_more = false;
+        state.list_state.error = std::string("数据库错误: ") + e.what();
+    }
+}
+
 LineType classify_output_line(const std::string& text) {
     if (text.empty()) return LineType::Output;
     if (text.starts_with("[Error]") || text.starts_with("[!]") || text.starts_with("Error:")) return LineType::Error;
@@ -386,16 +430,23 @@ int TuiApp::run() {
                     return;
                 }
 
-                auto svc = cmd::Services::load(root);
-                auto problems = svc.pm->list_problems();
-                int ac = 0;
-                for (const auto& p : problems) if (p.last_verdict == "AC") ac++;
-                auto reviews = svc.db->get_due_reviews(std::time(nullptr));
+                auto svc_ptr = cmd::Services::session(root);
+                auto& svc = *svc_ptr;
+                auto stats = svc.db->get_library_stats(std::time(nullptr));
+                int upcoming = 0;
+                for (const auto& [day, count] : stats.upcoming_reviews) upcoming += count;
+                std::vector<std::string> weak;
+                for (const auto& t : svc.db->get_weakest_tags(3)) {
+                    weak.push_back(fmt::format("{}  {:.0f}% ({}/{})", t.tag, t.solve_rate() * 100, t.solved, t.attempted));
+                }
                 if (!alive->load()) return;
-                screen.Post([&state, total = static_cast<int>(problems.size()), ac, pending = static_cast<int>(reviews.size())]() {
+                screen.Post([&state, total = stats.total, ac = stats.verdict("AC"), pending = stats.due_reviews, upcoming,
+                             weak = std::move(weak)]() mutable {
                     state.status_state.total_problems = total;
                     state.status_state.ac_problems = ac;
                     state.status_state.pending_reviews = pending;
+                    state.status_state.upcoming_reviews = upcoming;
+                    state.status_state.weak_tags = std::move(weak);
                     state.status_state.last_activity = "just now";
                     state.status_state.loaded = true;
                 });
@@ -597,8 +648,9 @@ int TuiApp::run() {
             state.solve_state = SolveState{};
             auto root = Config::find_root();
             if (!root.empty()) {
-                auto svc = cmd::Services::load(root);
-                auto problems = svc.pm->list_problems();
+                auto svc_ptr = cmd::Services::session(root);
+                auto& svc = *svc_ptr;
+                auto problems = svc.pm->list_problem_summaries();
                 for (const auto& p : problems) {
                     state.solve_state.filtered_rows.push_back({
                         p.display_id, p.id, p.title, p.difficulty, cmd::canonical_source(p.source)
@@ -782,8 +834,9 @@ int TuiApp::run() {
                     });
                 });
                 auto root = Config::find_root();
-                auto svc = cmd::Services::load(root);
-                auto problems = svc.pm->list_problems();
+                auto svc_ptr = cmd::Services::session(root);
+                auto& svc = *svc_ptr;
+                auto problems = svc.pm->list_problem_summaries();
                 if (!problems.empty()) {
                     const auto& p = problems.back();
                     if (!alive->load()) return;
@@ -815,21 +868,30 @@ int TuiApp::run() {
     auto refresh_solve_list = [&] {
         auto root = Config::find_root();
         if (root.empty()) return;
-        auto svc = cmd::Services::load(root);
-        auto problems = svc.pm->list_problems();
+        auto svc_ptr = cmd::Services::session(root);
+        auto& svc = *svc_ptr;
+        const auto& query = state.solve_state.search_query;
+        // Numeric input searches by TID; text goes to the full-text index (ranked)
+        bool by_tid = !query.empty() && std::all_of(query.begin(), query.end(), [](unsigned char c) { return std::isdigit(c); });
+        std::vector<ProblemSummary> problems;
+        if (query.empty() || by_tid) {
+            problems = svc.pm->list_problem_summaries();
+        } else {
+            for (auto& hit : svc.db->search_problems(query, 200)) problems.push_back(std::move(hit.problem));
+        }
         state.solve_state.filtered_rows.clear();
         for (const auto& p : problems) {
             std::string src = cmd::canonical_source(p.source);
             bool src_match = std::find(state.solve_state.selected_sources.begin(), state.solve_state.selected_sources.end(), src) != state.solve_state.selected_sources.end();
             bool diff_match = std::find(state.solve_state.selected_difficulties.begin(), state.solve_state.selected_difficulties.end(), p.difficulty) != state.solve_state.selected_difficulties.end();
-            bool search_match = state.solve_state.search_query.empty() || p.title.find(state.solve_state.search_query) != std::string::npos || std::to_string(p.display_id).find(state.solve_state.search_query) != std::string::npos;
-            if (src_match && diff_match && search_match) state.solve_state.filtered_rows.push_back({ p.display_id, p.id, p.title, p.difficulty, src });
+            bool tid_match = !by_tid || std::to_string(p.display_id).find(query) != std::string::npos;
+            if (src_match && diff_match && tid_match) state.solve_state.filtered_rows.push_back({ p.display_id, p.id, p.title, p.difficulty, src });
         }
         state.solve_state.selected_idx = 0;
     };
     InputOption solve_search_opt;
     solve_search_opt.on_change = refresh_solve_list;
-    auto solve_search_comp = Input(&state.solve_state.search_query, "搜索题号或标题...", solve_search_opt);
+    auto solve_search_comp = Input(&state.solve_state.search_query, "搜索题号、标题、标签或题面...", solve_search_opt);
     auto solve_view = Renderer(solve_search_comp, [&] { return render_solve_view(state, theme, solve_search_comp); });
 
     // --- Static Views ---
@@ -971,7 +1033,11 @@ int TuiApp::run() {
                     return true;
                 };
                 if (event == Event::ArrowUp || event == Event::Character('k')) { ls.selected = std::max(0, ls.selected - 1); return true; }
-                if (event == Event::ArrowDown || event == Event::Character('j')) { ls.selected = std::min((int)ls.rows.size() - 1, ls.selected + 1); return true; }
+                if (event == Event::ArrowDown || event == Event::Character('j')) {
+                    if (ls.selected + 1 >= static_cast<int>(ls.rows.size())) load_more_list_rows(state);
+                    ls.selected = std::min((int)ls.rows.size() - 1, ls.selected + 1);
+                    return true;
+                }
                 if (event == Event::Character('f')) {
                     const std::vector<std::string> filters = {"all", "ac", "failed", "unaudited", "review"};
                     auto it = std::find(filters.begin(), filters.end(), ls.status_filter);
@@ -1086,7 +1152,8 @@ int TuiApp::run() {
                         int tid = ss.filtered_rows[ss.selected_idx].tid;
                         launch_worker([alive, &screen, &state, tid]() {
                             try {
-                                auto svc = cmd::Services::load(Config::find_root());
+                                auto svc_ptr = cmd::Services::session(Config::find_root());
+                                auto& svc = *svc_ptr;
                                 auto p = svc.pm->get_problem(std::to_string(tid));
                                 if (!alive->load()) return;
                                 screen.Post([&state, content = p.description]() { state.solve_state.preview_content = content; });
@@ -6,7 +6,7 @@ namespace tui {
 std::vector<std::string> tui_command_candidates() {
     return {
         "/help", "/ls", "/dir", "/cd", "/pwd", "/clear",
-        "/init", "/info", "/pull", "/new", "/solve", "/list", "/delete",
+        "/init", "/info", "/pull", "/new", "/solve", "/list", "/search", "/delete",
         "/record", "/test", "/hint", "/view", "/clean", "/login",
         "/config", "/menu", "/repl", "/tui", "/exit"
     };
@@ -14,7 +14,7 @@ std::vector<std::string> tui_command_candidates() {
 
 std::vector<std::string> tui_cli_command_candidates() {
     return {
-        "init", "info", "pull", "new", "solve", "list", "delete",
+        "init", "info", "pull", "new", "solve", "list", "search", "delete",
         "record", "test", "hint", "view", "clean", "login",
         "config", "menu", "repl", "tui", "exit"
     };
@@ -434,7 +434,7 @@ Element render_list_view(const AppState& state, const TuiTheme& theme) {
         text("  f/F/s") | bold | color(theme.dim_color),
         text(" \xe5\x88\x87\xe6\x8d\xa2\xe7\xad\x9b\xe9\x80\x89") | color(theme.dim_color),
         filler(),
-        text(std::to_string(ls.selected + 1) + "/" + std::to_string(ls.rows.size()) + " ") | color(theme.dim_color),
+        text(std::to_string(ls.selected + 1) + "/" + std::to_string(std::max<int>(ls.total, ls.rows.size())) + " ") | color(theme.dim_color),
     }));
 
     return vbox(std::move(rows));
@@ -604,6 +604,12 @@ Element render_status_view(const AppState& state, const TuiTheme& theme) {
     rows.push_back(hbox({ text("    \xe6\x80\xbb\xe9\xa2\x98\xe6\x95\xb0: "), text(std::to_string(ss.total_problems)) | bold | color(theme.accent_color) }));
     rows.push_back(hbox({ text("    \xe5\xb7\xb2\xe9\x80\x9a\xe8\xbf\x87: "), text(std::to_string(ss.ac_problems)) | bold | color(theme.success_color) }));
     rows.push_back(hbox({ text("    \xe5\xbe\x85\xe5\xa4\x8d\xe4\xb9\xa0: "), text(std::to_string(ss.pending_reviews)) | bold | color(theme.warn_color) }));
+    rows.push_back(hbox({ text("    \xe6\x9c\xaa\xe6\x9d\xa5 7 \xe5\xa4\xa9: "), text(std::to_string(ss.upcoming_reviews)) | color(theme.dim_color) }));
+    if (!ss.weak_tags.empty()) {
+        rows.push_back(text(""));
+        rows.push_back(text("    \xe8\x96\x84\xe5\xbc\xb1\xe6\xa0\x87\xe7\xad\xbe:") | color(theme.heading_color));
+        for (const auto& t : ss.weak_tags) rows.push_back(text("      " + t) | color(theme.warn_color));
+    }
     rows.push_back(text(""));
     rows.push_back(hbox({ text("    \xe6\x9c\x80\xe8\xbf\x91\xe6\xb4\xbb\xe5\x8a\xa8: "), text(ss.last_activity) | color(theme.dim_color) }));
 
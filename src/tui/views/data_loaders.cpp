@@ -4,7 +4,6 @@
 #include "shuati/tui_views.hpp"
 #include "../../cmd/commands.hpp"
 #include <ctime>
-#include <unordered_set>
 
 namespace shuati {
 namespace tui {
@@ -75,14 +74,13 @@ void load_list_state(AppState& state,
         return;
     }
     try {
-        auto svc = cmd::Services::load(root);
-        auto problems = svc.pm->filter_problems(
-            svc.pm->list_problems(), status_filter,
-            difficulty_filter, source_filter);
-        auto current_time = std::time(nullptr);
-        auto reviews = svc.db->get_due_reviews(current_time);
-        std::unordered_set<std::string> due_ids;
-        for (const auto& r : reviews) due_ids.insert(r.problem_id);
+        auto svc_ptr = cmd::Services::session(root);
+        auto& svc = *svc_ptr;
+        ProblemQuery query;
+        query.status = status_filter;
+        query.difficulty = difficulty_filter;
+        query.source = source_filter;
+        auto problems = svc.pm->query_problems(query).rows;
 
         std::string prev_id;
         if (state.list_state.selected <
@@ -99,7 +97,7 @@ void load_list_state(AppState& state,
             row.source     = cmd::canonical_source(p.source);
             row.status     = p.last_verdict.empty() ? "-" : p.last_verdict;
             row.passed     = (p.last_verdict == "AC");
-            row.review_due = (due_ids.count(p.id) > 0);
+            row.review_due = p.review_due;
             {
                 char buf[16] = {};
                 std::time_t t = static_cast<std::time_t>(p.created_at);
@@ -140,7 +138,8 @@ void load_dashboard_state(AppState& state) {
         return;
     }
     try {
-        auto svc = cmd::Services::load(root);
+        auto svc_ptr = cmd::Services::session(root);
+        auto& svc = *svc_ptr;
         auto problems = svc.pm->list_problems();
         state.dashboard_state.total_problems = static_cast<int>(problems.size());
         state.dashboard_state.ac_count = 0;
@@ -163,7 +163,8 @@ Component CreateSolveView(ViewContext& ctx) {
         if (!state.solve_state.loaded || state.solve_state.all_rows.empty()) {
             auto root = Config::find_root();
             if (root.empty()) return;
-            auto svc = cmd::Services::load(root, true);
+            auto svc_ptr = cmd::Services::session(root, true);
+            auto& svc = *svc_ptr;
             auto problems = svc.pm->list_problems();
             state.solve_state.all_rows.clear();
             for (const auto& p : problems)
@@ -269,7 +270,8 @@ Component CreateSolveView(ViewContext& ctx) {
                 ctx.runner.submit("preview",
                     [tid](TaskRunner::StreamCb emit, std::atomic_bool& cancel) {
                         try {
-                            auto svc = cmd::Services::load(Config::find_root());
+                            auto svc_ptr = cmd::Services::session(Config::find_root());
+                            auto& svc = *svc_ptr;
                             auto p = svc.pm->get_problem(std::to_string(tid));
                             if (!cancel.load()) {
                                 emit(p.description);
@@ -49,7 +49,8 @@ Component CreatePullView(ViewContext& ctx) {
                 if (cancelled) return;
                 try {
                     auto root = Config::find_root();
-                    auto svc = cmd::Services::load(root);
+                    auto svc_ptr = cmd::Services::session(root);
+                    auto& svc = *svc_ptr;
                     auto problems = svc.pm->list_problems();
                     if (!problems.empty()) {
                         const auto& p = problems.back();
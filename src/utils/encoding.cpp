@@ -1,6 +1,13 @@
 #include "shuati/utils/encoding.hpp"
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SHUATI_UTF8_SSSE3 1
+#include <immintrin.h>
+#endif
+
 #ifdef _WIN32
 #include <winsock2.h>
 #include <windows.h>
@@ -8,33 +15,168 @@
 
 namespace shuati::utils {
 
-#ifdef _WIN32
+namespace {
+
+// Length of the well-formed sequence starting at p (Unicode 15, table 3-7), or 0
+size_t utf8_sequence_length(const unsigned char* p, size_t n) {
+    unsigned char c = p[0];
+    if (c < 0x80) return 1;
+    if (c < 0xC2) return 0;
+    if (c < 0xE0) return n >= 2 && (p[1] & 0xC0) == 0x80 ? 2 : 0;
+    if (c < 0xF0) {
+        if (n < 3) return 0;
+        unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;  // E0 80..9F is overlong
+        unsigned char hi = c == 0xED ? 0x9F : 0xBF;  // ED A0..BF are surrogates
+        return p[1] >= lo && p[1] <= hi && (p[2] & 0xC0) == 0x80 ? 3 : 0;
+    }
+    if (c < 0xF5) {
+        if (n < 4) return 0;
+        unsigned char lo = c == 0xF0 ? 0x90 : 0x80;  // F0 80..8F is overlong
+        unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;  // F4 90.. is above U+10FFFF
+        return p[1] >= lo && p[1] <= hi && (p[2] & 0xC0) == 0x80 && (p[3] & 0xC0) == 0x80 ? 4 : 0;
+    }
+    return 0;
+}
+
+#ifdef SHUATI_UTF8_SSSE3
+
+// Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"
+// (2021), "lookup" algorithm. Each byte is classified by three 16-entry table
+// lookups on (previous byte high nibble, previous byte low nibble, this byte
+// high nibble); the AND of the results is non-zero exactly where the two-byte
+// pattern is illegal. A separate check requires continuation bytes after
+// three- and four-byte leads.
+struct Utf8Blocks {
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+};
+
+__attribute__((target("ssse3"))) inline void utf8_check_block(Utf8Blocks& st, __m128i input) {
+    constexpr char TOO_SHORT = 1 << 0;
+    constexpr char TOO_LONG = 1 << 1;
+    constexpr char OVERLONG_3 = 1 << 2;
+    constexpr char TOO_LARGE = 1 << 3;
+    constexpr char SURROGATE = 1 << 4;
+    constexpr char OVERLONG_2 = 1 << 5;
+    constexpr char TOO_LARGE_1000 = 1 << 6;
+    constexpr char OVERLONG_4 = 1 << 6;
+    constexpr char TWO_CONTS = static_cast<char>(1 << 7);
+    constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    if (_mm_movemask_epi8(input) == 0) {
+        // All ASCII: only a sequence left open by the previous block can fail
+        st.error = _mm_or_si128(st.error, st.prev_incomplete);
+        st.prev_incomplete = _mm_setzero_si128();
+        st.prev_input = input;
+        return;
+    }
 
-bool is_valid_utf8(const std::string& s) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, st.prev_input, 15);
+    const __m128i byte_1_high = _mm_shuffle_epi8(
+        _mm_setr_epi8(TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                      TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+                      TOO_SHORT | OVERLONG_2,
+                      TOO_SHORT,
+                      TOO_SHORT | OVERLONG_3 | SURROGATE,
+                      TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    const __m128i byte_1_low = _mm_shuffle_epi8(
+        _mm_setr_epi8(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+                      CARRY | OVERLONG_2,
+                      CARRY,
+                      CARRY,
+                      CARRY | TOO_LARGE,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000,
+                      CARRY | TOO_LARGE | TOO_LARGE_1000),
+        _mm_and_si128(prev1, nibble));
+    const __m128i byte_2_high = _mm_shuffle_epi8(
+        _mm_setr_epi8(TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+                      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+                      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                      TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT),
+        _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // Bytes two and three after a 3-/4-byte lead must be continuations
+    const __m128i prev2 = _mm_alignr_epi8(input, st.prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, st.prev_input, 13);
+    const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+    st.error = _mm_or_si128(st.error, _mm_xor_si128(must23, special));
+
+    // Non-zero where a lead byte in the last three positions still needs bytes
+    st.prev_incomplete = _mm_subs_epu8(
+        input, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                             static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1)));
+    st.prev_input = input;
+}
+
+__attribute__((target("ssse3"))) bool is_valid_utf8_ssse3(const unsigned char* p, size_t n) {
+    Utf8Blocks st;
     size_t i = 0;
-    while (i < s.size()) {
-        unsigned char c = static_cast<unsigned char>(s[i]);
-        if (c <= 0x7F) {
-            i++;
-            continue;
-        }
+    for (; i + 16 <= n; i += 16) {
+        utf8_check_block(st, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    }
+    if (i < n) {
+        unsigned char tail[16] = {};
+        std::memcpy(tail, p + i, n - i);
+        utf8_check_block(st, _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)));
+    }
+    st.error = _mm_or_si128(st.error, st.prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(st.error, _mm_setzero_si128())) == 0xFFFF;
+}
 
-        size_t need = 0;
-        if ((c & 0xE0) == 0xC0) need = 2;
-        else if ((c & 0xF0) == 0xE0) need = 3;
-        else if ((c & 0xF8) == 0xF0) need = 4;
-        else return false;
+#endif // SHUATI_UTF8_SSSE3
 
-        if (i + need > s.size()) return false;
-        for (size_t j = 1; j < need; j++) {
-            unsigned char cc = static_cast<unsigned char>(s[i + j]);
-            if ((cc & 0xC0) != 0x80) return false;
+} // namespace
+
+bool is_valid_utf8_scalar(std::string_view s) {
+    auto p = reinterpret_cast<const unsigned char*>(s.data());
+    size_t n = s.size();
+    size_t i = 0;
+    while (i < n) {
+        // ASCII runs eight bytes at a time
+        if (i + 8 <= n) {
+            uint64_t word;
+            std::memcpy(&word, p + i, 8);
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
         }
-        i += need;
+        size_t len = utf8_sequence_length(p + i, n - i);
+        if (len == 0) return false;
+        i += len;
     }
     return true;
 }
 
+bool is_valid_utf8(std::string_view s) {
+#ifdef SHUATI_UTF8_SSSE3
+    // Below one block the table setup costs more than it saves
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    if (has_ssse3 && s.size() >= 16)
+        return is_valid_utf8_ssse3(reinterpret_cast<const unsigned char*>(s.data()), s.size());
+#endif
+    return is_valid_utf8_scalar(s);
+}
+
+#ifdef _WIN32
+
 std::string ascii_fallback(const std::string& s) {
     std::string out;
     out.reserve(s.size());
@@ -114,10 +256,33 @@ int utf8_system(const std::string& u8cmd) {
 
 #else
 
-bool is_valid_utf8(const std::string& /*s*/) { return true; } // Assume Linux/macOS uses UTF-8 everywhere
 std::string acp_to_utf8(const std::string& s) { return s; }
-std::string ensure_utf8(const std::string& s) { return s; }
-std::string ensure_utf8_lossy(const std::string& s) { return s; }
+std::string ensure_utf8(const std::string& s) { return s; } // Assume Linux/macOS uses UTF-8 everywhere
+
+// Copy of s with every byte that does not start a well-formed sequence replaced by '?'
+static std::string replace_invalid_utf8(std::string_view s) {
+    auto p = reinterpret_cast<const unsigned char*>(s.data());
+    std::string out;
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        size_t len = utf8_sequence_length(p + i, s.size() - i);
+        if (len == 0) {
+            out.push_back('?');
+            ++i;
+        } else {
+            out.append(s.data() + i, len);
+            i += len;
+        }
+    }
+    return out;
+}
+
+std::string ensure_utf8_lossy(const std::string& s) {
+    if (is_valid_utf8(s)) return s;
+    return replace_invalid_utf8(s);
+}
+
 std::string wide_to_utf8(const std::wstring& /*w*/) { return ""; } // Not needed on POSIX usually
 std::wstring utf8_to_wide(const std::string& /*u8str*/) { return L""; }
 
@@ -15,6 +15,7 @@ std::filesystem::path find_root_or_die() {
     return root;
 }
 
+// source_key_sql() in infra/database.cpp mirrors these rules for the indexed source_key column
 std::string canonical_source(const std::string& source) {
     std::string s = source;
     std::transform(s.begin(), s.end(), s.begin(), ::tolower);